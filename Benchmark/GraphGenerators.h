@@ -0,0 +1,229 @@
+#ifndef GRAPHGENERATORS_H
+#define GRAPHGENERATORS_H
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Vector2.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           Random
+//  Description:    A small xorshift generator. The standard
+//                  distributions differ between library vendors,
+//                  so the generators use this to produce the same
+//                  graph from the same seed on every platform.
+// ----------------------------------------------------------------
+class Random {
+private:
+    uint64_t m_state;
+
+public:
+    Random( uint64_t seed ) : m_state( seed * 0x9E3779B97F4A7C15ULL + 1 ) {
+    }
+
+    uint64_t next() {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 7;
+        m_state ^= m_state << 17;
+        return m_state;
+    }
+
+    // uniform in [0, 1)
+    float uniform() {
+        return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f);
+    }
+
+    // uniform in [0, n)
+    int below( int n ) {
+        return static_cast<int>(next() % static_cast<uint64_t>(n));
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           GeneratedGraph
+//  Description:    The node positions and directed arcs produced by
+//                  a generator, ready to be loaded into a graph.
+//                  Every arc weight is at least the straight line
+//                  distance between its nodes, so the Euclidean
+//                  heuristic stays admissible.
+// ----------------------------------------------------------------
+struct GeneratedGraph {
+    struct Arc {
+        int from;
+        int to;
+        float weight;
+    };
+
+    vector<Vector2> positions;
+    vector<Arc> arcs;
+
+    // adds an arc in both directions
+    void connect( int a, int b, float weight ) {
+        Arc arc;
+        arc.from = a;
+        arc.to = b;
+        arc.weight = weight;
+        arcs.push_back( arc );
+        arc.from = b;
+        arc.to = a;
+        arcs.push_back( arc );
+    }
+
+    float distance( int a, int b ) const {
+        float dx = positions[a].x - positions[b].x;
+        float dy = positions[a].y - positions[b].y;
+        return sqrt( dx * dx + dy * dy );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           generateGrid
+//  Description:    An 8-connected grid of roughly the requested
+//                  number of cells with a share of the cells
+//                  blocked. Blocked cells have no arcs.
+//  Arguments:      The first parameter is the number of nodes
+//                  The second parameter is the share of blocked cells
+//                  The third parameter is the random seed.
+//  Return Value:   The generated graph.
+// ----------------------------------------------------------------
+inline GeneratedGraph generateGrid( int nodes, float obstacles, uint64_t seed ) {
+	Random random(seed);
+	GeneratedGraph graph;
+	int side = static_cast<int>(ceil(sqrt(static_cast<double>(nodes))));
+	vector<char> blocked(side * side);
+	graph.positions.resize(side * side);
+	for (int i = 0; i < side * side; i++) {
+		graph.positions[i] = Vector2(static_cast<float>(i % side) * 10.0f, static_cast<float>(i / side) * 10.0f);
+		blocked[i] = random.uniform() < obstacles;
+	}
+
+	// connect each open cell to its open neighbours to the right and below,
+	// the reverse arcs cover the other four directions
+	const int dx[4] = { 1, -1, 0, 1 };
+	const int dy[4] = { 0, 1, 1, 1 };
+	for (int y = 0; y < side; y++) {
+		for (int x = 0; x < side; x++) {
+			int from = y * side + x;
+			for (int d = 0; d < 4 && !blocked[from]; d++) {
+				int nx = x + dx[d];
+				int ny = y + dy[d];
+				if (nx >= 0 && nx < side && ny < side && !blocked[ny * side + nx]) {
+					int to = ny * side + nx;
+					graph.connect(from, to, graph.distance(from, to));
+				}
+			}
+		}
+	}
+	return graph;
+}
+
+// ----------------------------------------------------------------
+//  Name:           generateGeometric
+//  Description:    A random geometric graph, nodes are scattered
+//                  uniformly and every pair closer than a radius
+//                  chosen for the requested mean degree is joined.
+//  Arguments:      The first parameter is the number of nodes
+//                  The second parameter is the mean degree
+//                  The third parameter is the random seed.
+//  Return Value:   The generated graph.
+// ----------------------------------------------------------------
+inline GeneratedGraph generateGeometric( int nodes, float degree, uint64_t seed ) {
+	Random random(seed);
+	GeneratedGraph graph;
+	// about 100 square units per node
+	float side = sqrt(static_cast<float>(nodes) * 100.0f);
+	float radius = sqrt(degree * 100.0f / 3.14159265f);
+	graph.positions.resize(nodes);
+	for (int i = 0; i < nodes; i++) {
+		graph.positions[i] = Vector2(random.uniform() * side, random.uniform() * side);
+	}
+
+	// bucket the nodes into cells one radius wide so that only the
+	// neighbouring cells have to be tested
+	int cells = max(1, static_cast<int>(side / radius));
+	float cellSize = side / cells;
+	vector<int> cellStart(cells * cells + 1, 0);
+	vector<int> cellNodes(nodes);
+	vector<int> cellOf(nodes);
+	for (int i = 0; i < nodes; i++) {
+		int cx = min(cells - 1, static_cast<int>(graph.positions[i].x / cellSize));
+		int cy = min(cells - 1, static_cast<int>(graph.positions[i].y / cellSize));
+		cellOf[i] = cy * cells + cx;
+		cellStart[cellOf[i] + 1]++;
+	}
+	for (int c = 0; c < cells * cells; c++) {
+		cellStart[c + 1] += cellStart[c];
+	}
+	vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+	for (int i = 0; i < nodes; i++) {
+		cellNodes[fill[cellOf[i]]++] = i;
+	}
+
+	for (int i = 0; i < nodes; i++) {
+		int cx = cellOf[i] % cells;
+		int cy = cellOf[i] / cells;
+		for (int ny = max(0, cy - 1); ny <= min(cells - 1, cy + 1); ny++) {
+			for (int nx = max(0, cx - 1); nx <= min(cells - 1, cx + 1); nx++) {
+				int c = ny * cells + nx;
+				for (int k = cellStart[c]; k < cellStart[c + 1]; k++) {
+					int j = cellNodes[k];
+					// each pair is joined once, from its lower index
+					if (j > i && graph.distance(i, j) <= radius) {
+						graph.connect(i, j, graph.distance(i, j));
+					}
+				}
+			}
+		}
+	}
+	return graph;
+}
+
+// ----------------------------------------------------------------
+//  Name:           generateRoad
+//  Description:    A road-like planar graph, a jittered grid of
+//                  junctions joined to their four neighbours with
+//                  some streets missing. Every eighth row and column
+//                  is a fast arterial road, other streets are slower
+//                  by a random factor, as with travel times.
+//  Arguments:      The first parameter is the number of nodes
+//                  The second parameter is the random seed.
+//  Return Value:   The generated graph.
+// ----------------------------------------------------------------
+inline GeneratedGraph generateRoad( int nodes, uint64_t seed ) {
+	Random random(seed);
+	GeneratedGraph graph;
+	int side = static_cast<int>(ceil(sqrt(static_cast<double>(nodes))));
+	graph.positions.resize(side * side);
+	for (int i = 0; i < side * side; i++) {
+		// jitter stays under half a block so streets never cross
+		float jx = (random.uniform() - 0.5f) * 40.0f;
+		float jy = (random.uniform() - 0.5f) * 40.0f;
+		graph.positions[i] = Vector2(static_cast<float>(i % side) * 100.0f + jx, static_cast<float>(i / side) * 100.0f + jy);
+	}
+
+	for (int y = 0; y < side; y++) {
+		for (int x = 0; x < side; x++) {
+			int from = y * side + x;
+			if (x + 1 < side) {
+				bool arterial = (y % 8 == 0);
+				if (arterial || random.uniform() > 0.1f) {
+					float factor = arterial ? 1.0f : 1.2f + random.uniform() * 0.8f;
+					graph.connect(from, from + 1, graph.distance(from, from + 1) * factor);
+				}
+			}
+			if (y + 1 < side) {
+				bool arterial = (x % 8 == 0);
+				if (arterial || random.uniform() > 0.1f) {
+					float factor = arterial ? 1.0f : 1.2f + random.uniform() * 0.8f;
+					graph.connect(from, from + side, graph.distance(from, from + side) * factor);
+				}
+			}
+		}
+	}
+	return graph;
+}
+
+#endif
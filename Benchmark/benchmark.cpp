@@ -0,0 +1,750 @@
+////////////////////////////////////////////////////////////
+// Benchmark for the graph searches.
+//
+// Generates seeded grid, random geometric and road-like
+// graphs, runs a fixed set of random queries through each
+// search on both the Graph and its CompactGraph snapshot,
+// (ucs and aStar on the snapshot once per priority queue,
+// the bidirectional searches on the snapshot only),
+// and reports throughput, latency percentiles, the number
+// of nodes each query touched and the peak memory use.
+// solveBatch runs all the queries at once on the thread
+// pool, so only its throughput and mean are reported.
+// distanceTable fills a table between the starts and the
+// destinations of the first sqrt(queries) queries, and
+// reports the table entries as queries. allPairs builds
+// the full table on graphs of up to 5000 nodes, build_ms
+// is then the time to build the table and the latency is
+// that of a distance and path lookup. contractionHierarchy
+// builds the hierarchy on the snapshot with the pool,
+// build_ms is then the time to build the hierarchy. alt
+// runs aStar on the snapshot with the landmark heuristic,
+// build_ms is then the time to choose the landmarks.
+// cachedAStar runs aStar on the graph through a 64 MB
+// QueryCache that has already seen every query, so it
+// times cache hits, build_ms is then the time to fill it.
+// The grid layout runs aStar, jps and jpsPlus on a
+// GridGraph with the same blocked cells as the grid
+// generator's graph, build_ms for jpsPlus is then the
+// time to build its jump table.
+// --storage picks where the Graph places its nodes and
+// arcs, which shows in build_ms and peak_kb, and
+// --arcIndex 1 builds the Graph with its arc index on.
+// greedy is greedy best first search, which settles the node
+// nearest the destination first, so its paths need not be
+// the shortest.
+// --stats 1 has ucs, aStar, greedy, alt and the breadth first searches
+// fill in SearchStats, and writes the totals of each run
+// to stderr as JSON.
+//
+// Usage:
+//   pathfinder_benchmark [--generators grid,geometric,road]
+//                        [--sizes 1000,10000,100000]
+//                        [--algorithms ucs,aStar,greedy,bidirectionalUcs,bidirectionalAStar,
+//                                      breadthFirst,breadthFirstSearch,solveBatch,
+//                                      distanceTable,allPairs,contractionHierarchy,alt,
+//                                      cachedAStar,jps,jpsPlus]
+//                        [--layouts graph,compact,grid]
+//                        [--queues dary,pairing,lazy]
+//                        [--queries 100] [--seed 1]
+//                        [--obstacles 0.2] [--degree 6] [--threads 0]
+//                        [--landmarks 16] [--storage heap|arena|pool]
+//                        [--arcIndex 0|1] [--stats 0|1]
+//                        [--format csv|json] [--output file]
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "AllPairs.h"
+#include "ContractionHierarchy.h"
+#include "Graph.h"
+#include "GraphGenerators.h"
+#include "GridGraph.h"
+#include "Landmarks.h"
+#include "QueryCache.h"
+
+using namespace std;
+
+typedef Graph<int, float> BenchGraph;
+typedef GraphNode<int, float> Node;
+typedef CompactGraph<int, float> BenchCompactGraph;
+typedef chrono::steady_clock Clock;
+
+struct Options {
+	vector<string> generators;
+	vector<int> sizes;
+	vector<string> algorithms;
+	vector<string> layouts;
+	vector<string> queues;
+	int queries;
+	uint64_t seed;
+	float obstacles;
+	float degree;
+	int threads;
+	int landmarks;
+	BenchGraph::Storage storage;
+	bool arcIndex;
+	bool stats;
+	string format;
+	string output;
+};
+
+struct Result {
+	string generator;
+	int nodes;
+	int arcs;
+	string layout;
+	string algorithm;
+	string queue;
+	int queries;
+	double buildMs;
+	double queriesPerSec;
+	double meanUs;
+	double p50Us;
+	double p90Us;
+	double p99Us;
+	double maxUs;
+	double visitedPerQuery;
+	double reachedPerQuery;
+	long peakKb;
+};
+
+// what a search works out before its queries are timed, any may be 0
+struct Preprocessed {
+	ContractionHierarchy const * pHierarchy;
+	Landmarks const * pLandmarks;
+	QueryCache<int, float> * pCache;
+	GridGraph const * pGrid;
+};
+
+// the searches without a visitor policy report nodes through
+// plain function pointers
+long long g_visited = 0;
+
+void countNode(Node *) {
+	g_visited++;
+}
+
+void countIndex(int) {
+	g_visited++;
+}
+
+// ----------------------------------------------------------------
+//  Name:           CountExpanded
+//  Description:    A stats policy that counts each node expanded
+//                  as visited and passes everything on to another.
+//                  bestFirstSearch expands a node just before it
+//                  visits it, so the searches built on it can be
+//                  timed with NoVisitor and still give the count.
+// ----------------------------------------------------------------
+template<class Stats>
+struct CountExpanded {
+	Stats & stats;
+
+	CountExpanded(Stats & inner) : stats(inner) {
+	}
+
+	void start() {
+		stats.start();
+	}
+
+	void expand() {
+		g_visited++;
+		stats.expand();
+	}
+
+	void scan() {
+		stats.scan();
+	}
+
+	void relax() {
+		stats.relax();
+	}
+
+	template<class Queue>
+	void queue(Queue const & open, int node) {
+		stats.queue(open, node);
+	}
+
+	void push(int size) {
+		stats.push(size);
+	}
+
+	void stop() {
+		stats.stop();
+	}
+};
+
+vector<string> split(string const & text) {
+	vector<string> parts;
+	stringstream stream(text);
+	string part;
+	while (getline(stream, part, ',')) {
+		if (!part.empty())
+			parts.push_back(part);
+	}
+	return parts;
+}
+
+long peakMemoryKb() {
+#ifndef _WIN32
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+#else
+	return -1;
+#endif
+}
+
+double percentile(vector<double> const & sorted, double p) {
+	if (sorted.empty())
+		return 0;
+	size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+	return sorted[index];
+}
+
+GeneratedGraph generate(string const & name, int nodes, Options const & options) {
+	if (name == "grid")
+		return generateGrid(nodes, options.obstacles, options.seed);
+	if (name == "geometric")
+		return generateGeometric(nodes, options.degree, options.seed);
+	return generateRoad(nodes, options.seed);
+}
+
+// ----------------------------------------------------------------
+//  Name:           runQuery
+//  Description:    Runs one query of the named search.
+//  Arguments:      The graph, its snapshot, the layout to search,
+//                  the search, the priority queue, what the search
+//                  has worked out beforehand, the forward and
+//                  backward contexts, the query nodes and the stats
+//                  policy, which only the searches that take one
+//                  fill in. ucs, aStar, greedy and alt are given
+//                  NoVisitor, as a caller that only wants the path
+//                  would, and count their nodes through the stats.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Stats>
+void runQuery(BenchGraph const & graph, BenchCompactGraph const & compact, string const & layout, string const & algorithm,
+	string const & queue, Preprocessed const & prepared, SearchContext & context, SearchContext & backward, int start, int dest,
+	Stats & stats) {
+	NoVisitor visitor;
+	CountExpanded<Stats> counted(stats);
+	if (layout == "graph") {
+		vector<Node *> path;
+		Node * pStart = graph.nodeArray()[start];
+		Node * pDest = graph.nodeArray()[dest];
+		if (algorithm == "ucs")
+			graph.ucs(context, pStart, pDest, visitor, path, counted);
+		else if (algorithm == "aStar")
+			graph.aStar(context, EuclideanHeuristic<BenchGraph>(graph), pStart, pDest, visitor, path, counted);
+		else if (algorithm == "greedy")
+			graph.greedy(context, EuclideanHeuristic<BenchGraph>(graph), pStart, pDest, visitor, path, counted);
+		else if (algorithm == "cachedAStar")
+			prepared.pCache->aStar(context, pStart, pDest, path);
+		else if (algorithm == "breadthFirst")
+			graph.breadthFirst(context, pStart, countNode, stats);
+		else
+			graph.breadthFirstSearch(context, pStart, pDest, countNode, stats);
+	}
+	else if (layout == "grid") {
+		vector<int> path;
+		if (algorithm == "aStar")
+			prepared.pGrid->aStar(context, start, dest, countIndex, path);
+		else if (algorithm == "jps")
+			prepared.pGrid->jps(context, start, dest, countIndex, path);
+		else
+			prepared.pGrid->jpsPlus(context, start, dest, countIndex, path);
+	}
+	else {
+		vector<int> path;
+		EuclideanArrayHeuristic heuristic(compact.xs(), compact.ys());
+		if (algorithm == "ucs" && queue == "pairing") {
+			PairingHeap nodeQueue(compact.nodeCount());
+			compact.ucs(context, nodeQueue, start, dest, visitor, path, counted);
+		}
+		else if (algorithm == "ucs" && queue == "lazy") {
+			LazyHeap nodeQueue(compact.nodeCount());
+			compact.ucs(context, nodeQueue, start, dest, visitor, path, counted);
+		}
+		else if (algorithm == "ucs")
+			compact.ucs(context, context.queue(), start, dest, visitor, path, counted);
+		else if (algorithm == "aStar" && queue == "pairing") {
+			PairingHeap nodeQueue(compact.nodeCount());
+			compact.aStar(context, nodeQueue, heuristic, start, dest, visitor, path, counted);
+		}
+		else if (algorithm == "aStar" && queue == "lazy") {
+			LazyHeap nodeQueue(compact.nodeCount());
+			compact.aStar(context, nodeQueue, heuristic, start, dest, visitor, path, counted);
+		}
+		else if (algorithm == "aStar")
+			compact.aStar(context, context.queue(), heuristic, start, dest, visitor, path, counted);
+		else if (algorithm == "greedy")
+			compact.greedy(context, context.queue(), heuristic, start, dest, visitor, path, counted);
+		else if (algorithm == "bidirectionalUcs")
+			compact.bidirectionalUcs(context, backward, start, dest, countIndex, path);
+		else if (algorithm == "bidirectionalAStar")
+			compact.bidirectionalAStar(context, backward, start, dest, countIndex, path);
+		else if (algorithm == "contractionHierarchy")
+			prepared.pHierarchy->query(context, backward, start, dest, countIndex, path);
+		else if (algorithm == "alt") {
+			IndexedDaryHeap<4> nodeQueue(compact.nodeCount());
+			compact.aStar(context, nodeQueue, *prepared.pLandmarks, start, dest, visitor, path, counted);
+		}
+		else if (algorithm == "breadthFirst")
+			compact.breadthFirst(context, start, countIndex, stats);
+		else
+			compact.breadthFirstSearch(context, start, dest, countIndex, stats);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           measure
+//  Description:    Times every query through one search.
+//  Arguments:      The graph, its snapshot, the layout to search,
+//                  the search, the priority queue, what the search
+//                  has worked out beforehand, the forward and
+//                  backward contexts, the queries and the counters
+//                  to add each query's stats to, or 0.
+//  Return Value:   The timings, counts and peak memory.
+// ----------------------------------------------------------------
+Result measure(BenchGraph const & graph, BenchCompactGraph const & compact, string const & layout, string const & algorithm,
+	string const & queue, Preprocessed const & prepared, SearchContext & context, SearchContext & backward,
+	vector<pair<int, int> > const & queries, SearchCounters * pCounters) {
+	int nodes = compact.nodeCount();
+	int count = static_cast<int>(queries.size());
+	vector<double> latencies;
+	latencies.reserve(count);
+	long long reached = 0;
+	g_visited = 0;
+	for (int q = 0; q < count; q++) {
+		Clock::time_point start = Clock::now();
+		if (pCounters != 0) {
+			SearchStats stats;
+			runQuery(graph, compact, layout, algorithm, queue, prepared, context, backward, queries[q].first, queries[q].second, stats);
+			pCounters->add(stats);
+		}
+		else {
+			NoStats stats;
+			runQuery(graph, compact, layout, algorithm, queue, prepared, context, backward, queries[q].first, queries[q].second, stats);
+		}
+		latencies.push_back(chrono::duration<double, micro>(Clock::now() - start).count());
+		// counting the marks is not part of the timing
+		bool bidirectional = algorithm.compare(0, 13, "bidirectional") == 0 || algorithm == "contractionHierarchy";
+		for (int i = 0; i < nodes; i++)
+			reached += (context.marked(i) ? 1 : 0) + (bidirectional && backward.marked(i) ? 1 : 0);
+	}
+
+	double total = 0;
+	for (size_t q = 0; q < latencies.size(); q++)
+		total += latencies[q];
+	sort(latencies.begin(), latencies.end());
+
+	Result r;
+	r.nodes = nodes;
+	r.arcs = compact.arcCount();
+	r.layout = layout;
+	r.algorithm = algorithm;
+	r.queue = queue;
+	r.queries = count;
+	r.buildMs = 0;
+	r.queriesPerSec = total > 0 ? count / (total / 1e6) : 0;
+	r.meanUs = total / count;
+	r.p50Us = percentile(latencies, 0.5);
+	r.p90Us = percentile(latencies, 0.9);
+	r.p99Us = percentile(latencies, 0.99);
+	r.maxUs = latencies.back();
+	r.visitedPerQuery = static_cast<double>(g_visited) / count;
+	r.reachedPerQuery = static_cast<double>(reached) / count;
+	r.peakKb = peakMemoryKb();
+	return r;
+}
+
+// ----------------------------------------------------------------
+//  Name:           measureBatch
+//  Description:    Times all the queries as one solveBatch call.
+//  Arguments:      The graph, the pool and the queries.
+//  Return Value:   The throughput, mean and peak memory, the
+//                  percentiles and counts are left at zero.
+// ----------------------------------------------------------------
+Result measureBatch(BenchGraph const & graph, ThreadPool & pool, vector<pair<int, int> > const & queries) {
+	int count = static_cast<int>(queries.size());
+	vector<float> distances(count);
+	Clock::time_point start = Clock::now();
+	graph.solveBatch(queries, distances, pool);
+	double total = chrono::duration<double, micro>(Clock::now() - start).count();
+
+	Result r;
+	r.nodes = graph.maxNodes();
+	r.arcs = 0;
+	r.layout = "graph";
+	r.algorithm = "solveBatch";
+	r.queue = to_string(pool.workerCount()) + " threads";
+	r.queries = count;
+	r.buildMs = 0;
+	r.queriesPerSec = total > 0 ? count / (total / 1e6) : 0;
+	r.meanUs = total / count;
+	r.p50Us = 0;
+	r.p90Us = 0;
+	r.p99Us = 0;
+	r.maxUs = 0;
+	r.visitedPerQuery = 0;
+	r.reachedPerQuery = 0;
+	r.peakKb = peakMemoryKb();
+	return r;
+}
+
+// ----------------------------------------------------------------
+//  Name:           measureTable
+//  Description:    Times one distanceTable call on the snapshot.
+//  Arguments:      The snapshot, the pool and the queries.
+//  Return Value:   The throughput per table entry, mean and peak
+//                  memory, the percentiles and counts are left at
+//                  zero.
+// ----------------------------------------------------------------
+Result measureTable(BenchCompactGraph const & compact, ThreadPool & pool, vector<pair<int, int> > const & queries) {
+	int side = max(1, static_cast<int>(sqrt(static_cast<double>(queries.size()))));
+	vector<int> sources;
+	vector<int> targets;
+	for (int i = 0; i < side; i++) {
+		sources.push_back(queries[i].first);
+		targets.push_back(queries[i].second);
+	}
+	vector<float> table(side * side);
+	Clock::time_point start = Clock::now();
+	compact.distanceTable(sources, targets, table, pool);
+	double total = chrono::duration<double, micro>(Clock::now() - start).count();
+
+	Result r;
+	r.nodes = compact.nodeCount();
+	r.arcs = compact.arcCount();
+	r.layout = "compact";
+	r.algorithm = "distanceTable";
+	r.queue = to_string(pool.workerCount()) + " threads";
+	r.queries = side * side;
+	r.buildMs = 0;
+	r.queriesPerSec = total > 0 ? r.queries / (total / 1e6) : 0;
+	r.meanUs = total / r.queries;
+	r.p50Us = 0;
+	r.p90Us = 0;
+	r.p99Us = 0;
+	r.maxUs = 0;
+	r.visitedPerQuery = 0;
+	r.reachedPerQuery = 0;
+	r.peakKb = peakMemoryKb();
+	return r;
+}
+
+// ----------------------------------------------------------------
+//  Name:           measureAllPairs
+//  Description:    Times building the all pairs table, then looking
+//                  up the distance and path of every query.
+//  Arguments:      The snapshot, the pool and the queries.
+//  Return Value:   The build time, throughput, mean and peak
+//                  memory, the percentiles and counts are left at
+//                  zero.
+// ----------------------------------------------------------------
+Result measureAllPairs(BenchCompactGraph const & compact, ThreadPool & pool, vector<pair<int, int> > const & queries) {
+	int count = static_cast<int>(queries.size());
+	Clock::time_point buildStart = Clock::now();
+	AllPairs table(compact, &pool);
+	double buildMs = chrono::duration<double, milli>(Clock::now() - buildStart).count();
+
+	vector<int> path;
+	long long hops = 0;
+	Clock::time_point start = Clock::now();
+	for (int q = 0; q < count; q++) {
+		table.getPath(queries[q].first, queries[q].second, path);
+		hops += path.size();
+	}
+	double total = chrono::duration<double, micro>(Clock::now() - start).count();
+
+	Result r;
+	r.nodes = compact.nodeCount();
+	r.arcs = compact.arcCount();
+	r.layout = "compact";
+	r.algorithm = "allPairs";
+	r.queue = to_string(pool.workerCount()) + " threads";
+	r.queries = count;
+	r.buildMs = buildMs;
+	r.queriesPerSec = total > 0 ? count / (total / 1e6) : 0;
+	r.meanUs = total / count;
+	r.p50Us = 0;
+	r.p90Us = 0;
+	r.p99Us = 0;
+	r.maxUs = 0;
+	r.visitedPerQuery = static_cast<double>(hops) / count;
+	r.reachedPerQuery = 0;
+	r.peakKb = peakMemoryKb();
+	return r;
+}
+
+void writeCsv(ostream & out, vector<Result> const & results) {
+	out << "generator,nodes,arcs,layout,algorithm,queue,queries,build_ms,queries_per_sec,mean_us,p50_us,p90_us,p99_us,max_us,"
+		<< "visited_per_query,reached_per_query,peak_kb\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		Result const & r = results[i];
+		out << r.generator << ',' << r.nodes << ',' << r.arcs << ',' << r.layout << ',' << r.algorithm << ',' << r.queue << ','
+			<< r.queries << ',' << r.buildMs << ',' << r.queriesPerSec << ',' << r.meanUs << ','
+			<< r.p50Us << ',' << r.p90Us << ',' << r.p99Us << ',' << r.maxUs << ','
+			<< r.visitedPerQuery << ',' << r.reachedPerQuery << ',' << r.peakKb << '\n';
+	}
+}
+
+void writeJson(ostream & out, vector<Result> const & results) {
+	out << "[\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		Result const & r = results[i];
+		out << "  {\"generator\": \"" << r.generator << "\", \"nodes\": " << r.nodes << ", \"arcs\": " << r.arcs
+			<< ", \"layout\": \"" << r.layout << "\", \"algorithm\": \"" << r.algorithm << "\", \"queue\": \"" << r.queue << "\", \"queries\": " << r.queries
+			<< ", \"build_ms\": " << r.buildMs << ", \"queries_per_sec\": " << r.queriesPerSec
+			<< ", \"mean_us\": " << r.meanUs << ", \"p50_us\": " << r.p50Us << ", \"p90_us\": " << r.p90Us
+			<< ", \"p99_us\": " << r.p99Us << ", \"max_us\": " << r.maxUs
+			<< ", \"visited_per_query\": " << r.visitedPerQuery << ", \"reached_per_query\": " << r.reachedPerQuery
+			<< ", \"peak_kb\": " << r.peakKb << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	out << "]\n";
+}
+
+bool parseOptions(int argc, char *argv[], Options & options) {
+	options.generators = split("grid,geometric,road");
+	options.sizes.push_back(1000);
+	options.sizes.push_back(10000);
+	options.sizes.push_back(100000);
+	options.algorithms = split("ucs,aStar,greedy,bidirectionalUcs,bidirectionalAStar,breadthFirst,breadthFirstSearch,solveBatch,distanceTable,allPairs,contractionHierarchy,alt,cachedAStar,jps,jpsPlus");
+	options.layouts = split("graph,compact,grid");
+	options.queues = split("dary");
+	options.queries = 100;
+	options.seed = 1;
+	options.obstacles = 0.2f;
+	options.degree = 6.0f;
+	options.threads = 0;
+	options.landmarks = 16;
+	options.storage = BenchGraph::HEAP;
+	options.arcIndex = false;
+	options.stats = false;
+	options.format = "csv";
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (i + 1 >= argc) {
+			cerr << "missing value for " << arg << "\n";
+			return false;
+		}
+		string value = argv[++i];
+		if (arg == "--generators")
+			options.generators = split(value);
+		else if (arg == "--sizes") {
+			vector<string> sizes = split(value);
+			options.sizes.clear();
+			for (size_t s = 0; s < sizes.size(); s++)
+				options.sizes.push_back(atoi(sizes[s].c_str()));
+		}
+		else if (arg == "--algorithms")
+			options.algorithms = split(value);
+		else if (arg == "--layouts")
+			options.layouts = split(value);
+		else if (arg == "--queues")
+			options.queues = split(value);
+		else if (arg == "--queries")
+			options.queries = atoi(value.c_str());
+		else if (arg == "--seed")
+			options.seed = strtoull(value.c_str(), 0, 10);
+		else if (arg == "--obstacles")
+			options.obstacles = static_cast<float>(atof(value.c_str()));
+		else if (arg == "--degree")
+			options.degree = static_cast<float>(atof(value.c_str()));
+		else if (arg == "--threads")
+			options.threads = atoi(value.c_str());
+		else if (arg == "--landmarks")
+			options.landmarks = atoi(value.c_str());
+		else if (arg == "--storage") {
+			if (value == "heap")
+				options.storage = BenchGraph::HEAP;
+			else if (value == "arena")
+				options.storage = BenchGraph::ARENA;
+			else if (value == "pool")
+				options.storage = BenchGraph::POOL;
+			else {
+				cerr << "unknown storage " << value << "\n";
+				return false;
+			}
+		}
+		else if (arg == "--arcIndex")
+			options.arcIndex = atoi(value.c_str()) != 0;
+		else if (arg == "--stats")
+			options.stats = atoi(value.c_str()) != 0;
+		else if (arg == "--format")
+			options.format = value;
+		else if (arg == "--output")
+			options.output = value;
+		else {
+			cerr << "unknown option " << arg << "\n";
+			return false;
+		}
+	}
+	if (options.queries <= 0) {
+		cerr << "--queries must be positive\n";
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	Options options;
+	if (!parseOptions(argc, argv, options))
+		return 1;
+
+	ThreadPool pool(options.threads);
+	vector<Result> results;
+	for (size_t g = 0; g < options.generators.size(); g++) {
+		for (size_t s = 0; s < options.sizes.size(); s++) {
+			Clock::time_point buildStart = Clock::now();
+			GeneratedGraph generated = generate(options.generators[g], options.sizes[s], options);
+			int nodes = static_cast<int>(generated.positions.size());
+			BenchGraph graph(nodes, options.storage);
+			graph.indexArcs(options.arcIndex);
+			for (int i = 0; i < nodes; i++)
+				graph.addNode(i, generated.positions[i].x, generated.positions[i].y, i);
+			for (size_t a = 0; a < generated.arcs.size(); a++)
+				graph.addArc(generated.arcs[a].from, generated.arcs[a].to, generated.arcs[a].weight);
+			BenchCompactGraph compact = graph.freeze();
+			double buildMs = chrono::duration<double, milli>(Clock::now() - buildStart).count();
+			generated = GeneratedGraph();
+
+			// the grid generator's cells again, blocked where a cell has no arcs
+			GridGraph grid;
+			if (options.generators[g] == "grid") {
+				int side = static_cast<int>(sqrt(static_cast<double>(nodes)) + 0.5);
+				grid = GridGraph(side, side);
+				for (int i = 0; i < nodes; i++) {
+					if (compact.arcBegin(i) == compact.arcEnd(i))
+						grid.setBlocked(i % side, i / side, true);
+				}
+			}
+
+			// queries only use nodes with arcs so they are not trivially empty
+			vector<int> candidates;
+			for (int i = 0; i < nodes; i++) {
+				if (compact.arcBegin(i) != compact.arcEnd(i))
+					candidates.push_back(i);
+			}
+			if (candidates.empty())
+				continue;
+			Random random(options.seed + s);
+			vector<pair<int, int> > queries(options.queries);
+			for (int q = 0; q < options.queries; q++) {
+				queries[q].first = candidates[random.below(static_cast<int>(candidates.size()))];
+				queries[q].second = candidates[random.below(static_cast<int>(candidates.size()))];
+			}
+
+			SearchContext context(nodes);
+			SearchContext backward(nodes);
+			for (size_t l = 0; l < options.layouts.size(); l++) {
+				for (size_t a = 0; a < options.algorithms.size(); a++) {
+					if (options.algorithms[a] == "allPairs") {
+						if (options.layouts[l] != "compact" || nodes > 5000)
+							continue;
+						Result r = measureAllPairs(compact, pool, queries);
+						r.generator = options.generators[g];
+						results.push_back(r);
+						cerr << r.generator << " " << r.nodes << " " << r.layout << " " << r.algorithm << " " << r.queue << ": "
+							<< r.queriesPerSec << " queries/s\n";
+						continue;
+					}
+					if (options.algorithms[a] == "solveBatch" || options.algorithms[a] == "distanceTable") {
+						// the batch runs on the graph, the table on the snapshot
+						if (options.layouts[l] != (options.algorithms[a] == "solveBatch" ? "graph" : "compact"))
+							continue;
+						Result r = options.algorithms[a] == "solveBatch" ? measureBatch(graph, pool, queries) : measureTable(compact, pool, queries);
+						r.generator = options.generators[g];
+						r.arcs = compact.arcCount();
+						r.buildMs = buildMs;
+						results.push_back(r);
+						cerr << r.generator << " " << r.nodes << " " << r.layout << " " << r.algorithm << " " << r.queue << ": "
+							<< r.queriesPerSec << " queries/s\n";
+						continue;
+					}
+					// the grid layout only exists for the grid generator, and jump point search only on it
+					bool gridSearch = options.algorithms[a] == "aStar" || options.algorithms[a] == "jps" || options.algorithms[a] == "jpsPlus";
+					if (options.layouts[l] == "grid" && (options.generators[g] != "grid" || !gridSearch))
+						continue;
+					if (options.layouts[l] != "grid" && (options.algorithms[a] == "jps" || options.algorithms[a] == "jpsPlus"))
+						continue;
+					// the bidirectional searches, the hierarchy and the landmarks need the snapshot's reverse arcs
+					if (options.layouts[l] == "graph" && (options.algorithms[a].compare(0, 13, "bidirectional") == 0
+						|| options.algorithms[a] == "contractionHierarchy" || options.algorithms[a] == "alt"))
+						continue;
+					// and the cache sits in front of the graph
+					if (options.layouts[l] == "compact" && options.algorithms[a] == "cachedAStar")
+						continue;
+					double preprocessMs = buildMs;
+					ContractionHierarchy hierarchy;
+					if (options.algorithms[a] == "contractionHierarchy") {
+						Clock::time_point hierarchyStart = Clock::now();
+						hierarchy = ContractionHierarchy(compact, &pool);
+						preprocessMs = chrono::duration<double, milli>(Clock::now() - hierarchyStart).count();
+					}
+					Landmarks landmarks;
+					if (options.algorithms[a] == "alt") {
+						Clock::time_point landmarksStart = Clock::now();
+						landmarks = Landmarks(compact, options.landmarks, &pool);
+						preprocessMs = chrono::duration<double, milli>(Clock::now() - landmarksStart).count();
+					}
+					QueryCache<int, float> cache(graph, 64 << 20);
+					if (options.algorithms[a] == "cachedAStar") {
+						Clock::time_point cacheStart = Clock::now();
+						vector<Node *> path;
+						for (size_t q = 0; q < queries.size(); q++)
+							cache.aStar(context, graph.nodeArray()[queries[q].first], graph.nodeArray()[queries[q].second], path);
+						preprocessMs = chrono::duration<double, milli>(Clock::now() - cacheStart).count();
+						// hits leave the context alone, so none of this search counts as reached
+						context.reset(compact.nodeCount());
+					}
+					if (options.algorithms[a] == "jpsPlus") {
+						Clock::time_point tableStart = Clock::now();
+						grid.preprocess();
+						preprocessMs = chrono::duration<double, milli>(Clock::now() - tableStart).count();
+					}
+					Preprocessed prepared = { &hierarchy, &landmarks, &cache, &grid };
+					// only the snapshot's ucs and aStar can swap their queue
+					bool queued = options.layouts[l] == "compact" && (options.algorithms[a] == "ucs" || options.algorithms[a] == "aStar");
+					for (size_t k = 0; k < (queued ? options.queues.size() : 1); k++) {
+						SearchCounters counters;
+						Result r = measure(graph, compact, options.layouts[l], options.algorithms[a],
+							queued ? options.queues[k] : "default", prepared, context, backward, queries,
+							options.stats ? &counters : 0);
+						r.generator = options.generators[g];
+						r.buildMs = preprocessMs;
+						results.push_back(r);
+						cerr << r.generator << " " << r.nodes << " " << r.layout << " " << r.algorithm << " " << r.queue << ": "
+							<< r.queriesPerSec << " queries/s\n";
+						if (options.stats)
+							cerr << "  stats: " << counters.json() << "\n";
+					}
+				}
+			}
+		}
+	}
+
+	ofstream file;
+	if (!options.output.empty())
+		file.open(options.output.c_str());
+	ostream & out = options.output.empty() ? cout : file;
+	if (options.format == "json")
+		writeJson(out, results);
+	else
+		writeCsv(out, results);
+	return 0;
+}
@@ -0,0 +1,269 @@
+#ifndef ALLPAIRS_H
+#define ALLPAIRS_H
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "Graph.h"
+#include "ThreadPool.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ALLPAIRS_SSE2
+#endif
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           AllPairs
+//  Description:    The shortest distance and the next node on the
+//                  way between every pair of nodes, so a query is
+//                  a table lookup. Built with Floyd-Warshall worked
+//                  through in square blocks that fit in the cache,
+//                  with the inner loop in AVX2 or SSE2 when the
+//                  compiler targets them. Memory and build time
+//                  grow as n^2 and n^3, so this suits graphs of up
+//                  to a few thousand nodes.
+// ----------------------------------------------------------------
+class AllPairs {
+private:
+    static const int BLOCK = 64;
+
+// ----------------------------------------------------------------
+//  Description:    The number of nodes, and the row length of the
+//                  tables, rounded up to a whole number of blocks.
+// ----------------------------------------------------------------
+    int m_count;
+    int m_stride;
+
+// ----------------------------------------------------------------
+//  Description:    Row i holds the distance from node i to each
+//                  node, infinity if it can't be reached.
+// ----------------------------------------------------------------
+    vector<float> m_distance;
+
+// ----------------------------------------------------------------
+//  Description:    Row i holds the node after i on the shortest
+//                  path to each node, or -1 if there is none.
+// ----------------------------------------------------------------
+    vector<int> m_next;
+
+public:
+    template<class NodeType, class ArcType>
+    AllPairs( CompactGraph<NodeType, ArcType> const & graph, ThreadPool * pPool = 0 );
+    template<class NodeType, class ArcType>
+    AllPairs( Graph<NodeType, ArcType> const & graph, ThreadPool * pPool = 0 );
+
+    int nodeCount() const {
+        return m_count;
+    }
+
+    float distance( int from, int to ) const {
+        return m_distance[static_cast<size_t>(from) * m_stride + to];
+    }
+
+    int nextHop( int from, int to ) const {
+        return m_next[static_cast<size_t>(from) * m_stride + to];
+    }
+
+    void getPath( int from, int to, vector<int>& path ) const;
+
+private:
+    template<class NodeType, class ArcType>
+    void build( CompactGraph<NodeType, ArcType> const & graph, ThreadPool * pPool );
+    void relaxBlock( int row, int column, int through );
+};
+
+// ----------------------------------------------------------------
+//  Name:           AllPairs
+//  Description:    Constructor, this builds the tables for a
+//                  compact graph.
+//  Arguments:      The first parameter is the graph
+//                  The second parameter is a pool to spread the
+//                  blocks over, or 0 to use this thread only.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+AllPairs::AllPairs( CompactGraph<NodeType, ArcType> const & graph, ThreadPool * pPool ) {
+	build(graph, pPool);
+}
+
+// ----------------------------------------------------------------
+//  Name:           AllPairs
+//  Description:    Constructor, this builds the tables for a graph
+//                  as it is now, later changes are not reflected.
+//  Arguments:      As above.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+AllPairs::AllPairs( Graph<NodeType, ArcType> const & graph, ThreadPool * pPool ) {
+	build(graph.freeze(), pPool);
+}
+
+// ----------------------------------------------------------------
+//  Name:           getPath
+//  Description:    Follows the next hops from one node to another.
+//                  As with the searches, the path is returned from
+//                  the destination back to the start, and is just
+//                  the destination if there is no path.
+//  Arguments:      The first parameter is the starting node index
+//                  The second parameter is the destination index
+//                  The third parameter receives the path.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void AllPairs::getPath( int from, int to, vector<int>& path ) const {
+	path.clear();
+	if (nextHop(from, to) != -1) {
+		for (int node = from; node != to; node = nextHop(node, to)) {
+			path.push_back(node);
+		}
+	}
+	path.push_back(to);
+	reverse(path.begin(), path.end());
+}
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Fills the tables from the arcs, then runs
+//                  Floyd-Warshall a block of intermediate nodes at
+//                  a time: first the diagonal block, then the rest
+//                  of its block row and column, which only depend
+//                  on the diagonal, then every other block, which
+//                  only depend on the row and column. The blocks of
+//                  the last two steps are independent of each other
+//                  and are shared over the pool.
+//  Arguments:      The graph and the pool, or 0.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void AllPairs::build( CompactGraph<NodeType, ArcType> const & graph, ThreadPool * pPool ) {
+	m_count = graph.nodeCount();
+	m_stride = (m_count + BLOCK - 1) / BLOCK * BLOCK;
+	size_t cells = static_cast<size_t>(m_stride) * m_stride;
+	m_distance.assign(cells, numeric_limits<float>::infinity());
+	m_next.assign(cells, -1);
+
+	for (int node = 0; node < m_count; node++) {
+		size_t row = static_cast<size_t>(node) * m_stride;
+		m_distance[row + node] = 0;
+		m_next[row + node] = node;
+		for (int arc = graph.arcBegin(node); arc != graph.arcEnd(node); arc++) {
+			// keep the shortest of any parallel arcs
+			int to = graph.target(arc);
+			float weight = static_cast<float>(graph.weight(arc));
+			if (weight < m_distance[row + to]) {
+				m_distance[row + to] = weight;
+				m_next[row + to] = to;
+			}
+		}
+	}
+
+	int blocks = m_stride / BLOCK;
+	for (int k = 0; k < blocks; k++) {
+		relaxBlock(k, k, k);
+
+		// the rest of block row and column k
+		int others = blocks - 1;
+		function<void(int, int, int)> edges = [this, k, others](int, int begin, int end) {
+			for (int i = begin; i < end; i++) {
+				int b = i % others;
+				b += (b >= k) ? 1 : 0;
+				if (i < others)
+					relaxBlock(k, b, k);
+				else
+					relaxBlock(b, k, k);
+			}
+		};
+		// every block outside row and column k
+		function<void(int, int, int)> rest = [this, k, others](int, int begin, int end) {
+			for (int i = begin; i < end; i++) {
+				int row = i / others;
+				int column = i % others;
+				relaxBlock(row + (row >= k ? 1 : 0), column + (column >= k ? 1 : 0), k);
+			}
+		};
+
+		if (others == 0)
+			continue;
+		if (pPool != 0) {
+			pPool->parallelFor(2 * others, 1, edges);
+			pPool->parallelFor(others * others, 1, rest);
+		}
+		else {
+			edges(0, 0, 2 * others);
+			rest(0, 0, others * others);
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           relaxBlock
+//  Description:    Lowers each distance in a block through each of
+//                  the intermediate nodes of another block, in
+//                  Floyd-Warshall order so the block may share rows
+//                  or columns with the intermediate block.
+//  Arguments:      The block row and column to update and the
+//                  block of intermediate nodes.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void AllPairs::relaxBlock( int row, int column, int through ) {
+	int rowBegin = row * BLOCK;
+	int columnBegin = column * BLOCK;
+	int throughBegin = through * BLOCK;
+	for (int k = throughBegin; k < throughBegin + BLOCK; k++) {
+		float const * pThrough = &m_distance[static_cast<size_t>(k) * m_stride + columnBegin];
+		for (int i = rowBegin; i < rowBegin + BLOCK; i++) {
+			size_t rowOffset = static_cast<size_t>(i) * m_stride;
+			float toThrough = m_distance[rowOffset + k];
+			if (toThrough == numeric_limits<float>::infinity())
+				continue;
+			int firstHop = m_next[rowOffset + k];
+			float * pDistance = &m_distance[rowOffset + columnBegin];
+			int * pNext = &m_next[rowOffset + columnBegin];
+			int j = 0;
+#if defined(__AVX2__)
+			__m256 vToThrough = _mm256_set1_ps(toThrough);
+			__m256i vFirstHop = _mm256_set1_epi32(firstHop);
+			for (; j < BLOCK; j += 8) {
+				__m256 candidate = _mm256_add_ps(vToThrough, _mm256_loadu_ps(pThrough + j));
+				__m256 current = _mm256_loadu_ps(pDistance + j);
+				__m256 shorter = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+				// most lanes are already shortest, only write when one changes
+				if (_mm256_movemask_ps(shorter) == 0)
+					continue;
+				_mm256_storeu_ps(pDistance + j, _mm256_blendv_ps(current, candidate, shorter));
+				__m256i next = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(pNext + j));
+				next = _mm256_blendv_epi8(next, vFirstHop, _mm256_castps_si256(shorter));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(pNext + j), next);
+			}
+#elif defined(ALLPAIRS_SSE2)
+			__m128 vToThrough = _mm_set1_ps(toThrough);
+			__m128i vFirstHop = _mm_set1_epi32(firstHop);
+			for (; j < BLOCK; j += 4) {
+				__m128 candidate = _mm_add_ps(vToThrough, _mm_loadu_ps(pThrough + j));
+				__m128 current = _mm_loadu_ps(pDistance + j);
+				__m128 shorter = _mm_cmplt_ps(candidate, current);
+				// most lanes are already shortest, only write when one changes
+				if (_mm_movemask_ps(shorter) == 0)
+					continue;
+				_mm_storeu_ps(pDistance + j, _mm_or_ps(_mm_and_ps(shorter, candidate), _mm_andnot_ps(shorter, current)));
+				__m128i mask = _mm_castps_si128(shorter);
+				__m128i next = _mm_loadu_si128(reinterpret_cast<__m128i const *>(pNext + j));
+				next = _mm_or_si128(_mm_and_si128(mask, vFirstHop), _mm_andnot_si128(mask, next));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(pNext + j), next);
+			}
+#endif
+			for (; j < BLOCK; j++) {
+				float candidate = toThrough + pThrough[j];
+				if (candidate < pDistance[j]) {
+					pDistance[j] = candidate;
+					pNext[j] = firstHop;
+				}
+			}
+		}
+	}
+}
+
+#endif
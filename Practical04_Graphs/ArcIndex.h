@@ -0,0 +1,218 @@
+#ifndef ARCINDEX_H
+#define ARCINDEX_H
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           ArcIndex
+//  Description:    A hash table from an arc's (from, to) node
+//                  indices to a value, usually where the arc is
+//                  kept, so an arc can be found without walking
+//                  its node's arc list. The table is open
+//                  addressed with linear probing, and a removal
+//                  shifts the following entries back rather than
+//                  leaving a marker, so lookups never slow down
+//                  however many arcs come and go.
+// ----------------------------------------------------------------
+template<class Value>
+class ArcIndex {
+private:
+
+// ----------------------------------------------------------------
+//  Description:    One slot of the table, empty when from is -1.
+// ----------------------------------------------------------------
+    struct Slot {
+        int from;
+        int to;
+        Value value;
+    };
+
+    vector<Slot> m_slots;
+
+// ----------------------------------------------------------------
+//  Description:    The number of arcs in the table.
+// ----------------------------------------------------------------
+    size_t m_count;
+
+public:
+    // Constructor functions
+    ArcIndex() : m_count( 0 ) {
+    }
+
+    // Accessor functions
+    size_t size() const {
+        return m_count;
+    }
+
+    Value * find( int from, int to );
+    Value const * find( int from, int to ) const;
+
+    // Manipulator functions
+    bool insert( int from, int to, Value const & value );
+    bool erase( int from, int to );
+    void clear();
+    void reserve( size_t count );
+
+private:
+    size_t home( int from, int to ) const;
+    size_t locate( int from, int to ) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           find
+//  Description:    Looks up an arc.
+//  Arguments:      The first parameter is the originating node index
+//                  The second parameter is the ending node index.
+//  Return Value:   The arc's value, or 0 if it is not in the table.
+// ----------------------------------------------------------------
+template<class Value>
+Value * ArcIndex<Value>::find( int from, int to ) {
+	size_t slot = locate(from, to);
+	return slot != m_slots.size() ? &m_slots[slot].value : 0;
+}
+
+template<class Value>
+Value const * ArcIndex<Value>::find( int from, int to ) const {
+	size_t slot = locate(from, to);
+	return slot != m_slots.size() ? &m_slots[slot].value : 0;
+}
+
+// ----------------------------------------------------------------
+//  Name:           insert
+//  Description:    Adds an arc, growing the table once it is
+//                  three quarters full.
+//  Arguments:      The first parameter is the originating node index
+//                  The second parameter is the ending node index
+//                  The third parameter is the arc's value.
+//  Return Value:   True if it was added, false if the arc was
+//                  already there, which leaves its value as it was.
+// ----------------------------------------------------------------
+template<class Value>
+bool ArcIndex<Value>::insert( int from, int to, Value const & value ) {
+	if ((m_count + 1) * 4 > m_slots.size() * 3)
+		reserve(m_count + 1);
+	size_t mask = m_slots.size() - 1;
+	size_t slot = home(from, to);
+	while (m_slots[slot].from != -1) {
+		if (m_slots[slot].from == from && m_slots[slot].to == to)
+			return false;
+		slot = (slot + 1) & mask;
+	}
+	m_slots[slot].from = from;
+	m_slots[slot].to = to;
+	m_slots[slot].value = value;
+	m_count++;
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           erase
+//  Description:    Removes an arc. The entries after it in its run
+//                  are moved back into the gap when that brings
+//                  them no further from their home slot, so every
+//                  entry stays reachable from its home.
+//  Arguments:      The first parameter is the originating node index
+//                  The second parameter is the ending node index.
+//  Return Value:   True if the arc was in the table.
+// ----------------------------------------------------------------
+template<class Value>
+bool ArcIndex<Value>::erase( int from, int to ) {
+	size_t gap = locate(from, to);
+	if (gap == m_slots.size())
+		return false;
+	size_t mask = m_slots.size() - 1;
+	size_t slot = (gap + 1) & mask;
+	while (m_slots[slot].from != -1) {
+		// an entry can fill the gap if its home is not between
+		// the gap and where it sits now
+		size_t wanted = home(m_slots[slot].from, m_slots[slot].to);
+		if (((slot - wanted) & mask) >= ((slot - gap) & mask)) {
+			m_slots[gap] = m_slots[slot];
+			gap = slot;
+		}
+		slot = (slot + 1) & mask;
+	}
+	m_slots[gap].from = -1;
+	m_slots[gap].value = Value();
+	m_count--;
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           clear
+//  Description:    Empties the table and gives its memory back.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Value>
+void ArcIndex<Value>::clear() {
+	vector<Slot>().swap(m_slots);
+	m_count = 0;
+}
+
+// ----------------------------------------------------------------
+//  Name:           reserve
+//  Description:    Makes room for a number of arcs without
+//                  growing, rehashing the arcs already there.
+//  Arguments:      The number of arcs.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Value>
+void ArcIndex<Value>::reserve( size_t count ) {
+	size_t size = 16;
+	while (size * 3 < count * 4)
+		size *= 2;
+	if (size <= m_slots.size())
+		return;
+	Slot empty = { -1, -1, Value() };
+	vector<Slot> old(size, empty);
+	old.swap(m_slots);
+	m_count = 0;
+	for (size_t i = 0; i < old.size(); i++) {
+		if (old[i].from != -1)
+			insert(old[i].from, old[i].to, old[i].value);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           home
+//  Description:    The slot an arc would be in with no collisions.
+//  Arguments:      The originating and ending node indices.
+//  Return Value:   The slot.
+// ----------------------------------------------------------------
+template<class Value>
+size_t ArcIndex<Value>::home( int from, int to ) const {
+	unsigned long long h = (static_cast<unsigned long long>(static_cast<unsigned>(from)) << 32) | static_cast<unsigned>(to);
+	// spread the bits so neighbouring arcs land far apart
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return static_cast<size_t>(h) & (m_slots.size() - 1);
+}
+
+// ----------------------------------------------------------------
+//  Name:           locate
+//  Description:    Finds the slot an arc is in.
+//  Arguments:      The originating and ending node indices.
+//  Return Value:   The slot, or the table size if it is not there.
+// ----------------------------------------------------------------
+template<class Value>
+size_t ArcIndex<Value>::locate( int from, int to ) const {
+	if (m_count == 0)
+		return m_slots.size();
+	size_t mask = m_slots.size() - 1;
+	size_t slot = home(from, to);
+	while (m_slots[slot].from != -1) {
+		if (m_slots[slot].from == from && m_slots[slot].to == to)
+			return slot;
+		slot = (slot + 1) & mask;
+	}
+	return m_slots.size();
+}
+
+#endif
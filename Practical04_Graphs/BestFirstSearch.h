@@ -0,0 +1,240 @@
+#ifndef BESTFIRSTSEARCH_H
+#define BESTFIRSTSEARCH_H
+
+#include <limits>
+#include "Heuristics.h"
+#include "SearchContext.h"
+#include "SearchStats.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  The best first searches, ucs, aStar and greedy, are one search,
+//  bestFirstSearch, put together at compile time from policies:
+//
+//      Priority        how a node's queue key is made from its
+//                      distance g and its heuristic h, see below
+//      Heuristic       h( node, dest ), as in Heuristics.h, only
+//                      called if the priority uses h
+//      Queue           any of the queues in IndexedHeap.h
+//      Visitor         visitor( node ) is called on each node as it
+//                      is settled
+//      Termination     termination( node ) is asked after each node
+//                      is visited, and the search stops if it is true
+//      Stats           as in SearchStats.h
+//
+//  Every policy call is a direct call the compiler can inline, so
+//  a visitor or stats policy that does nothing costs nothing. The
+//  graph must give its number of node indices as maxNodes() and its
+//  arcs through visitArcs( node, visit ), which calls
+//
+//      visit( pTargets, pWeights, count )
+//
+//  for each run of arcs it holds contiguously, so a heuristic with
+//  a batch member can work out h for a whole run at once.
+// ----------------------------------------------------------------
+
+// ----------------------------------------------------------------
+//  Name:           UniformCostPriority
+//  Description:    Orders nodes by their distance from the start.
+// ----------------------------------------------------------------
+struct UniformCostPriority {
+    static const bool USES_HEURISTIC = false;
+    static const bool USES_DISTANCE = true;
+
+    static float key( float distance, float ) {
+        return distance;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           AStarPriority
+//  Description:    Orders nodes by f(n) = g(n) + h(n).
+// ----------------------------------------------------------------
+struct AStarPriority {
+    static const bool USES_HEURISTIC = true;
+    static const bool USES_DISTANCE = true;
+
+    static float key( float distance, float heuristic ) {
+        return heuristic + distance;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           GreedyPriority
+//  Description:    Orders nodes by h(n) alone. A node's key never
+//                  changes, so it is queued once, and the path found
+//                  need not be the shortest.
+// ----------------------------------------------------------------
+struct GreedyPriority {
+    static const bool USES_HEURISTIC = true;
+    static const bool USES_DISTANCE = false;
+
+    static float key( float, float heuristic ) {
+        return heuristic;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           NoHeuristic
+//  Description:    h(n) = 0, for priorities that don't use h.
+// ----------------------------------------------------------------
+struct NoHeuristic {
+    float operator()( int, int ) const {
+        return 0.0f;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           NoVisitor
+//  Description:    A visitor that does nothing.
+// ----------------------------------------------------------------
+struct NoVisitor {
+    void operator()( int ) const {
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           IndexVisitor
+//  Description:    Calls a function with the index of each node,
+//                  for the searches that take a function pointer.
+// ----------------------------------------------------------------
+struct IndexVisitor {
+    void (*pProcess)(int);
+
+    IndexVisitor( void (*pFunction)(int) ) : pProcess( pFunction ) {
+    }
+
+    void operator()( int node ) const {
+        pProcess( node );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           NodeVisitor
+//  Description:    Calls a function with each node of a Graph.
+// ----------------------------------------------------------------
+template<class Node>
+struct NodeVisitor {
+    Node* const * pNodes;
+    void (*pProcess)(Node*);
+
+    NodeVisitor( Node* const * pNodeArray, void (*pFunction)(Node*) ) : pNodes( pNodeArray ), pProcess( pFunction ) {
+    }
+
+    void operator()( int node ) const {
+        pProcess( pNodes[node] );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           StopAtGoal
+//  Description:    Stops once the goal is settled. A goal of -1 is
+//                  never reached, so the search runs until every
+//                  reachable node is settled.
+// ----------------------------------------------------------------
+struct StopAtGoal {
+    int goal;
+
+    StopAtGoal( int goalNode ) : goal( goalNode ) {
+    }
+
+    bool operator()( int node ) const {
+        return node == goal;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Description:    How many arc targets h is worked out for at a
+//                  time with a batched heuristic.
+// ----------------------------------------------------------------
+const int BEST_FIRST_BATCH = 16;
+
+// ----------------------------------------------------------------
+//  Name:           bestFirstSearch
+//  Description:    Best first search from the start node, settling
+//                  nodes in the order of the priority's key until
+//                  the termination policy stops it or the queue
+//                  runs dry. h(n) is worked out the first time a
+//                  node is reached. The search leaves the distance,
+//                  heuristic, previous node and mark of each node
+//                  in the context for the caller to build a path
+//                  from. The stats do not time building the path.
+//  Arguments:      The first parameter is the graph
+//                  The second parameter is the search context
+//                  The third parameter is the priority queue
+//                  The fourth parameter is the heuristic policy
+//                  The fifth parameter is the visitor
+//                  The sixth parameter is the termination policy
+//                  The seventh parameter is the stats policy
+//                  The eighth parameter is the starting node index
+//                  The ninth parameter is the node index h(n) is
+//                  measured to.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class Priority, class GraphType, class Queue, class Heuristic, class Visitor, class Termination, class Stats>
+void bestFirstSearch( GraphType const & graph, SearchContext& context, Queue& nodeQueue, Heuristic const & heuristic,
+                      Visitor& visitor, Termination& termination, Stats& stats, int start, int dest ) {
+	stats.start();
+	context.reset(graph.maxNodes());
+	nodeQueue.reset(graph.maxNodes());
+
+	float startHeuristic = 0.0f;
+	if constexpr (Priority::USES_HEURISTIC) {
+		startHeuristic = heuristic(start, dest);
+		context.setHeuristic(start, startHeuristic);
+	}
+	context.setDistance(start, 0);
+	stats.queue(nodeQueue, start);
+	nodeQueue.push(start, Priority::key(0.0f, startHeuristic));
+
+	while (!nodeQueue.empty()) {
+		// the node at the top of the queue is settled
+		int currNode = nodeQueue.pop();
+		context.setMarked(currNode, true);
+		stats.expand();
+		visitor(currNode);
+		if (termination(currNode))
+			break;
+
+		float currDistance = context.distance(currNode);
+		graph.visitArcs(currNode, [&]( int const * pTargets, auto const * pWeights, int count ) {
+			for (int first = 0; first < count; first += BEST_FIRST_BATCH) {
+				int run = count - first < BEST_FIRST_BATCH ? count - first : BEST_FIRST_BATCH;
+				float h[BEST_FIRST_BATCH];
+				if constexpr (Priority::USES_HEURISTIC && HasBatch<Heuristic>::value) {
+					heuristic.batch(pTargets + first, run, dest, h);
+				}
+				for (int i = 0; i < run; i++) {
+					int next = pTargets[first + i];
+					float dist = currDistance + pWeights[first + i];
+					stats.scan();
+					if (!context.marked(next) && dist < context.distance(next)) {
+						stats.relax();
+						// h(n) only needs working out the first time a node is reached
+						bool reached = context.distance(next) != numeric_limits<float>::infinity();
+						if constexpr (Priority::USES_HEURISTIC) {
+							if (!reached) {
+								if constexpr (HasBatch<Heuristic>::value) {
+									context.setHeuristic(next, h[i]);
+								} else {
+									context.setHeuristic(next, heuristic(next, dest));
+								}
+							}
+						}
+						context.setDistance(next, dist);
+						context.setPrevious(next, currNode);
+						// a key that ignores the distance is already right
+						if (Priority::USES_DISTANCE || !reached) {
+							stats.queue(nodeQueue, next);
+							nodeQueue.pushOrDecrease(next, Priority::key(dist, context.heuristic(next)));
+						}
+					}
+				}
+			}
+		});
+	}
+	stats.stop();
+}
+
+#endif
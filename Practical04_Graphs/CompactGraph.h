@@ -0,0 +1,984 @@
+#ifndef COMPACTGRAPH_H
+#define COMPACTGRAPH_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <memory>
+#include <vector>
+#include "BestFirstSearch.h"
+#include "Heuristics.h"
+#include "IndexedHeap.h"
+#include "SearchContext.h"
+#include "SearchStats.h"
+#include "ThreadPool.h"
+#include "Vector2.h"
+
+using namespace std;
+
+template <class NodeType, class ArcType> class GraphArc;
+template <class NodeType, class ArcType> class GraphNode;
+
+// ----------------------------------------------------------------
+//  Name:           CompactGraph
+//  Description:    An immutable snapshot of a Graph stored in
+//                  compressed sparse row form. The arcs leaving
+//                  node i are the entries [offsets[i], offsets[i+1])
+//                  of the target and weight arrays, so expanding a
+//                  node is a linear scan of contiguous memory.
+//                  Nodes are referred to by their graph index.
+//                  The arrays are read through pointers, so they
+//                  may be built from a graph or used in place from
+//                  a mapped graph file, and copies share them.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class CompactGraph {
+private:
+
+    // typedef the classes to make our lives easier.
+    typedef GraphArc<NodeType, ArcType> Arc;
+    typedef GraphNode<NodeType, ArcType> Node;
+
+// ----------------------------------------------------------------
+//  Description:    The arrays of a graph built in memory.
+// ----------------------------------------------------------------
+    struct Storage {
+        vector<int> offsets;
+        vector<int> targets;
+        vector<ArcType> weights;
+        vector<int> reverseOffsets;
+        vector<int> reverseSources;
+        vector<ArcType> reverseWeights;
+        vector<float> xs;
+        vector<float> ys;
+    };
+
+// ----------------------------------------------------------------
+//  Description:    Whatever owns the arrays, a Storage or a mapped
+//                  file, kept alive by every copy of the graph.
+// ----------------------------------------------------------------
+    shared_ptr<void const> m_pOwner;
+
+    int m_count;
+    int m_arcs;
+
+// ----------------------------------------------------------------
+//  Description:    Start of each node's arcs, one entry per node
+//                  plus a final entry holding the arc count.
+// ----------------------------------------------------------------
+    int const * m_pOffsets;
+
+// ----------------------------------------------------------------
+//  Description:    The index of the node each arc points to.
+// ----------------------------------------------------------------
+    int const * m_pTargets;
+
+// ----------------------------------------------------------------
+//  Description:    The weight of each arc.
+// ----------------------------------------------------------------
+    ArcType const * m_pWeights;
+
+// ----------------------------------------------------------------
+//  Description:    The same arcs grouped by the node they point
+//                  to, for searching backwards from a node.
+//                  m_pReverseSources holds the node each arc
+//                  leaves from.
+// ----------------------------------------------------------------
+    int const * m_pReverseOffsets;
+    int const * m_pReverseSources;
+    ArcType const * m_pReverseWeights;
+
+// ----------------------------------------------------------------
+//  Description:    The physical position of each node, the x and
+//                  y in arrays of their own so the heuristic can
+//                  read several nodes' at once.
+// ----------------------------------------------------------------
+    float const * m_pXs;
+    float const * m_pYs;
+
+// ----------------------------------------------------------------
+//  Description:    The graph node each index was built from, or
+//                  0 for empty slots. Empty if the arrays were not
+//                  built from a graph.
+// ----------------------------------------------------------------
+    vector<Node*> m_pNodes;
+
+public:
+// ----------------------------------------------------------------
+//  Description:    Arrays laid out as above that the graph reads in
+//                  place, for graphs that are not built in memory.
+// ----------------------------------------------------------------
+    struct Arrays {
+        int nodes;
+        int arcs;
+        int const * pOffsets;
+        int const * pTargets;
+        ArcType const * pWeights;
+        int const * pReverseOffsets;
+        int const * pReverseSources;
+        ArcType const * pReverseWeights;
+        float const * pXs;
+        float const * pYs;
+    };
+
+    // Constructor functions
+    CompactGraph();
+    CompactGraph( Node** pNodes, int count );
+    CompactGraph( vector<Vector2>& positions, vector<int>& offsets, vector<int>& targets, vector<ArcType>& weights );
+    CompactGraph( Arrays const & arrays, shared_ptr<void const> const & pOwner );
+
+    // Accessors
+    int nodeCount() const {
+        return m_count;
+    }
+
+    int maxNodes() const {
+        return m_count;
+    }
+
+    int arcCount() const {
+        return m_arcs;
+    }
+
+    int arcBegin( int node ) const {
+        return m_pOffsets[node];
+    }
+
+    int arcEnd( int node ) const {
+        return m_pOffsets[node + 1];
+    }
+
+    int target( int arc ) const {
+        return m_pTargets[arc];
+    }
+
+    ArcType weight( int arc ) const {
+        return m_pWeights[arc];
+    }
+
+    template<class Visit>
+    void visitArcs( int node, Visit visit ) const {
+        visit( m_pTargets + m_pOffsets[node], m_pWeights + m_pOffsets[node], m_pOffsets[node + 1] - m_pOffsets[node] );
+    }
+
+    int reverseArcBegin( int node ) const {
+        return m_pReverseOffsets[node];
+    }
+
+    int reverseArcEnd( int node ) const {
+        return m_pReverseOffsets[node + 1];
+    }
+
+    int reverseSource( int arc ) const {
+        return m_pReverseSources[arc];
+    }
+
+    ArcType reverseWeight( int arc ) const {
+        return m_pReverseWeights[arc];
+    }
+
+    Vector2 getPosition( int node ) const {
+        return Vector2( m_pXs[node], m_pYs[node] );
+    }
+
+    float const * xs() const {
+        return m_pXs;
+    }
+
+    float const * ys() const {
+        return m_pYs;
+    }
+
+    Node* node( int index ) const {
+        return m_pNodes.empty() ? 0 : m_pNodes[index];
+    }
+
+    // Public member functions.
+    void depthFirst( SearchContext& context, int start, void (*pProcess)(int) ) const {
+        NoStats stats;
+        depthFirst( context, start, pProcess, stats );
+    }
+    template<class Stats>
+    void depthFirst( SearchContext& context, int start, void (*pProcess)(int), Stats& stats ) const;
+    void breadthFirst( SearchContext& context, int start, void (*pProcess)(int) ) const {
+        NoStats stats;
+        breadthFirst( context, start, pProcess, stats );
+    }
+    template<class Stats>
+    void breadthFirst( SearchContext& context, int start, void (*pProcess)(int), Stats& stats ) const;
+    void breadthFirstSearch( SearchContext& context, int start, int goal, void (*pProcess)(int) ) const {
+        NoStats stats;
+        breadthFirstSearch( context, start, goal, pProcess, stats );
+    }
+    template<class Stats>
+    void breadthFirstSearch( SearchContext& context, int start, int goal, void (*pProcess)(int), Stats& stats ) const;
+    template<class Queue, class Visitor, class Stats>
+    void ucs( SearchContext& context, Queue& nodeQueue, int start, int dest, Visitor& visitor, std::vector<int>& path, Stats& stats ) const;
+    template<class Queue, class Stats>
+    void ucs( SearchContext& context, Queue& nodeQueue, int start, int dest, void (*pVisitFunc)(int), std::vector<int>& path, Stats& stats ) const {
+        IndexVisitor visitor( pVisitFunc );
+        ucs( context, nodeQueue, start, dest, visitor, path, stats );
+    }
+    template<class Queue>
+    void ucs( SearchContext& context, Queue& nodeQueue, int start, int dest, void (*pVisitFunc)(int), std::vector<int>& path ) const {
+        NoStats stats;
+        ucs( context, nodeQueue, start, dest, pVisitFunc, path, stats );
+    }
+    template<class Queue>
+    void ucs( SearchContext& context, int start, int dest, void (*pVisitFunc)(int), std::vector<int>& path ) const {
+        Queue nodeQueue( nodeCount() );
+        ucs( context, nodeQueue, start, dest, pVisitFunc, path );
+    }
+    void ucs( SearchContext& context, int start, int dest, void (*pVisitFunc)(int), std::vector<int>& path ) const {
+        ucs( context, context.queue(), start, dest, pVisitFunc, path );
+    }
+    template<class Stats>
+    void ucs( SearchContext& context, int start, int dest, void (*pVisitFunc)(int), std::vector<int>& path, Stats& stats ) const {
+        ucs( context, context.queue(), start, dest, pVisitFunc, path, stats );
+    }
+    template<class Queue, class Heuristic, class Visitor, class Stats>
+    void aStar( SearchContext& context, Queue& nodeQueue, Heuristic const & heuristic, int start, int dest, Visitor& visitor, std::vector<int>& path, Stats& stats ) const;
+    template<class Queue, class Heuristic, class Stats>
+    void aStar( SearchContext& context, Queue& nodeQueue, Heuristic const & heuristic, int start, int dest, void (*pProcess)(int), std::vector<int>& path, Stats& stats ) const {
+        IndexVisitor visitor( pProcess );
+        aStar( context, nodeQueue, heuristic, start, dest, visitor, path, stats );
+    }
+    template<class Queue, class Heuristic>
+    void aStar( SearchContext& context, Queue& nodeQueue, Heuristic const & heuristic, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const {
+        NoStats stats;
+        aStar( context, nodeQueue, heuristic, start, dest, pProcess, path, stats );
+    }
+    template<class Queue>
+    void aStar( SearchContext& context, Queue& nodeQueue, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const {
+        aStar( context, nodeQueue, EuclideanArrayHeuristic( m_pXs, m_pYs ), start, dest, pProcess, path );
+    }
+    template<class Queue>
+    void aStar( SearchContext& context, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const {
+        Queue nodeQueue( nodeCount() );
+        aStar( context, nodeQueue, start, dest, pProcess, path );
+    }
+    void aStar( SearchContext& context, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const {
+        aStar( context, context.queue(), start, dest, pProcess, path );
+    }
+    template<class Stats>
+    void aStar( SearchContext& context, int start, int dest, void (*pProcess)(int), std::vector<int>& path, Stats& stats ) const {
+        aStar( context, context.queue(), EuclideanArrayHeuristic( m_pXs, m_pYs ), start, dest, pProcess, path, stats );
+    }
+    template<class Queue, class Heuristic, class Visitor, class Stats>
+    void greedy( SearchContext& context, Queue& nodeQueue, Heuristic const & heuristic, int start, int dest, Visitor& visitor, std::vector<int>& path, Stats& stats ) const;
+    template<class Queue, class Heuristic, class Stats>
+    void greedy( SearchContext& context, Queue& nodeQueue, Heuristic const & heuristic, int start, int dest, void (*pProcess)(int), std::vector<int>& path, Stats& stats ) const {
+        IndexVisitor visitor( pProcess );
+        greedy( context, nodeQueue, heuristic, start, dest, visitor, path, stats );
+    }
+    template<class Heuristic>
+    void greedy( SearchContext& context, Heuristic const & heuristic, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const {
+        NoStats stats;
+        greedy( context, context.queue(), heuristic, start, dest, pProcess, path, stats );
+    }
+    void greedy( SearchContext& context, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const {
+        greedy( context, EuclideanArrayHeuristic( m_pXs, m_pYs ), start, dest, pProcess, path );
+    }
+    template<class Stats>
+    void greedy( SearchContext& context, int start, int dest, void (*pProcess)(int), std::vector<int>& path, Stats& stats ) const {
+        greedy( context, context.queue(), EuclideanArrayHeuristic( m_pXs, m_pYs ), start, dest, pProcess, path, stats );
+    }
+    float bidirectionalUcs( SearchContext& forward, SearchContext& backward, int start, int dest, void (*pVisitFunc)(int), std::vector<int>& path ) const;
+    float bidirectionalAStar( SearchContext& forward, SearchContext& backward, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const;
+    void oneToMany( SearchContext& context, int source, std::vector<int> const & targets, std::vector<float>& distances ) const;
+    void distanceTable( std::vector<int> const & sources, std::vector<int> const & targets, std::vector<float>& table, ThreadPool& pool ) const;
+
+private:
+    void attach( shared_ptr<Storage> const & pStorage );
+    static void buildReverse( Storage & storage );
+    void settleAll( SearchContext& context, IndexedDaryHeap<4>& nodeQueue, std::vector<char>& wanted, int source,
+                    std::vector<int> const & ends, bool backward, float* pOut, int stride ) const;
+    float bidirectional( SearchContext& forward, SearchContext& backward, int start, int dest, bool useHeuristic, void (*pProcess)(int), std::vector<int>& path ) const;
+    static void buildPath( SearchContext const & context, int dest, std::vector<int>& path );
+};
+
+// ----------------------------------------------------------------
+//  Name:           CompactGraph
+//  Description:    Constructor, this constructs an empty graph
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+CompactGraph<NodeType, ArcType>::CompactGraph() {
+	shared_ptr<Storage> pStorage(new Storage());
+	pStorage->offsets.assign(1, 0);
+	pStorage->reverseOffsets.assign(1, 0);
+	attach(pStorage);
+}
+
+// ----------------------------------------------------------------
+//  Name:           CompactGraph
+//  Description:    Constructor, this flattens the arc lists of
+//                  every node into the offset, target and weight
+//                  arrays.
+//  Arguments:      The first parameter is the graph's node array.
+//                  The second parameter is the size of the array.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+CompactGraph<NodeType, ArcType>::CompactGraph( Node** pNodes, int count ) {
+	shared_ptr<Storage> pStorage(new Storage());
+	Storage & storage = *pStorage;
+	storage.offsets.resize(count + 1);
+	storage.xs.resize(count);
+	storage.ys.resize(count);
+	m_pNodes.assign(pNodes, pNodes + count);
+
+	// count the arcs first so the arrays are only allocated once
+	int arcs = 0;
+	for (int i = 0; i < count; i++) {
+		storage.offsets[i] = arcs;
+		if (pNodes[i] != 0) {
+			arcs += static_cast<int>(pNodes[i]->arcList().size());
+			storage.xs[i] = pNodes[i]->getPosition().x;
+			storage.ys[i] = pNodes[i]->getPosition().y;
+		}
+	}
+	storage.offsets[count] = arcs;
+	storage.targets.reserve(arcs);
+	storage.weights.reserve(arcs);
+
+	for (int i = 0; i < count; i++) {
+		if (pNodes[i] != 0) {
+			typename Node::ArcList::const_iterator iter = pNodes[i]->arcList().begin();
+			typename Node::ArcList::const_iterator endIter = pNodes[i]->arcList().end();
+			for (; iter != endIter; ++iter) {
+				storage.targets.push_back((*iter).node()->index());
+				storage.weights.push_back((*iter).weight());
+			}
+		}
+	}
+
+	buildReverse(storage);
+	attach(pStorage);
+}
+
+// ----------------------------------------------------------------
+//  Name:           CompactGraph
+//  Description:    Constructor, this takes forward arrays already
+//                  in compressed sparse row form and builds the
+//                  reverse ones. The arc vectors are swapped in
+//                  and left empty, and the positions are split
+//                  into their x and y arrays and cleared.
+//  Arguments:      The first parameter is the node positions
+//                  The second parameter is the offsets, one more
+//                  than the number of nodes
+//                  The third and fourth parameters are the arc
+//                  targets and weights.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+CompactGraph<NodeType, ArcType>::CompactGraph( vector<Vector2>& positions, vector<int>& offsets, vector<int>& targets, vector<ArcType>& weights ) {
+	shared_ptr<Storage> pStorage(new Storage());
+	pStorage->xs.resize(positions.size());
+	pStorage->ys.resize(positions.size());
+	for (size_t i = 0; i < positions.size(); i++) {
+		pStorage->xs[i] = positions[i].x;
+		pStorage->ys[i] = positions[i].y;
+	}
+	vector<Vector2>().swap(positions);
+	pStorage->offsets.swap(offsets);
+	pStorage->targets.swap(targets);
+	pStorage->weights.swap(weights);
+	buildReverse(*pStorage);
+	attach(pStorage);
+}
+
+// ----------------------------------------------------------------
+//  Name:           CompactGraph
+//  Description:    Constructor, this reads arrays owned elsewhere
+//                  in place. They must not change while any copy
+//                  of the graph is in use.
+//  Arguments:      The first parameter is the arrays
+//                  The second parameter owns them and is kept alive
+//                  as long as the graph or a copy of it.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+CompactGraph<NodeType, ArcType>::CompactGraph( Arrays const & arrays, shared_ptr<void const> const & pOwner )
+	: m_pOwner( pOwner ), m_count( arrays.nodes ), m_arcs( arrays.arcs ),
+	  m_pOffsets( arrays.pOffsets ), m_pTargets( arrays.pTargets ), m_pWeights( arrays.pWeights ),
+	  m_pReverseOffsets( arrays.pReverseOffsets ), m_pReverseSources( arrays.pReverseSources ),
+	  m_pReverseWeights( arrays.pReverseWeights ), m_pXs( arrays.pXs ), m_pYs( arrays.pYs ) {
+}
+
+// ----------------------------------------------------------------
+//  Name:           attach
+//  Description:    Points the graph at the arrays of a storage and
+//                  takes shared ownership of it.
+//  Arguments:      The storage.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void CompactGraph<NodeType, ArcType>::attach( shared_ptr<Storage> const & pStorage ) {
+	Storage const & storage = *pStorage;
+	m_pOwner = pStorage;
+	m_count = static_cast<int>(storage.offsets.size()) - 1;
+	m_arcs = static_cast<int>(storage.targets.size());
+	m_pOffsets = storage.offsets.data();
+	m_pTargets = storage.targets.data();
+	m_pWeights = storage.weights.data();
+	m_pReverseOffsets = storage.reverseOffsets.data();
+	m_pReverseSources = storage.reverseSources.data();
+	m_pReverseWeights = storage.reverseWeights.data();
+	m_pXs = storage.xs.data();
+	m_pYs = storage.ys.data();
+}
+
+// ----------------------------------------------------------------
+//  Name:           buildReverse
+//  Description:    Builds the reverse arc arrays from the forward
+//                  ones with a counting sort on the target node.
+//  Arguments:      The storage to fill in.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void CompactGraph<NodeType, ArcType>::buildReverse( Storage & storage ) {
+	int count = static_cast<int>(storage.offsets.size()) - 1;
+	int arcs = static_cast<int>(storage.targets.size());
+	storage.reverseOffsets.assign(count + 1, 0);
+	for (int arc = 0; arc < arcs; arc++) {
+		storage.reverseOffsets[storage.targets[arc] + 1]++;
+	}
+	for (int i = 0; i < count; i++) {
+		storage.reverseOffsets[i + 1] += storage.reverseOffsets[i];
+	}
+
+	storage.reverseSources.resize(arcs);
+	storage.reverseWeights.resize(arcs);
+	vector<int> fill(storage.reverseOffsets.begin(), storage.reverseOffsets.end() - 1);
+	for (int node = 0; node < count; node++) {
+		for (int arc = storage.offsets[node]; arc != storage.offsets[node + 1]; arc++) {
+			int slot = fill[storage.targets[arc]]++;
+			storage.reverseSources[slot] = node;
+			storage.reverseWeights[slot] = storage.weights[arc];
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           depthFirst
+//  Description:    Performs a depth-first traversal from the
+//                  specified node.
+//  Arguments:      The first argument is the search context
+//                  The second argument is the starting node index
+//                  The third argument is the processing function
+//                  The fourth argument is the stats policy, see
+//                  SearchStats.h.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Stats>
+void CompactGraph<NodeType, ArcType>::depthFirst( SearchContext& context, int start, void (*pProcess)(int), Stats& stats ) const {
+	stats.start();
+	context.reset(nodeCount());
+	// an explicit stack of (node, next arc) replaces the recursion
+	vector<pair<int, int> > stack;
+
+	stats.expand();
+	pProcess(start);
+	context.setMarked(start, true);
+	stack.push_back(make_pair(start, arcBegin(start)));
+	stats.push(1);
+
+	while (!stack.empty()) {
+		int node = stack.back().first;
+		int & arc = stack.back().second;
+		if (arc == arcEnd(node)) {
+			stack.pop_back();
+		}
+		else {
+			int next = m_pTargets[arc++];
+			// process the linked node if it isn't already marked.
+			stats.scan();
+			if (!context.marked(next)) {
+				stats.relax();
+				stats.expand();
+				pProcess(next);
+				context.setMarked(next, true);
+				stack.push_back(make_pair(next, arcBegin(next)));
+				stats.push(static_cast<int>(stack.size()));
+			}
+		}
+	}
+	stats.stop();
+}
+
+// ----------------------------------------------------------------
+//  Name:           breadthFirst
+//  Description:    Performs a breadth-first traversal from the
+//                  specified node.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the starting node index
+//                  The third parameter is the processing function
+//                  The fourth parameter is the stats policy, see
+//                  SearchStats.h.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Stats>
+void CompactGraph<NodeType, ArcType>::breadthFirst( SearchContext& context, int start, void (*pProcess)(int), Stats& stats ) const {
+	stats.start();
+	context.reset(nodeCount());
+	// the visited nodes double as the queue
+	vector<int> nodeQueue;
+	nodeQueue.reserve(nodeCount());
+
+	nodeQueue.push_back(start);
+	stats.push(1);
+	context.setMarked(start, true);
+	for (size_t head = 0; head < nodeQueue.size(); head++) {
+		int node = nodeQueue[head];
+		stats.expand();
+		pProcess(node);
+
+		for (int arc = arcBegin(node); arc != arcEnd(node); arc++) {
+			int next = m_pTargets[arc];
+			stats.scan();
+			if (!context.marked(next)) {
+				stats.relax();
+				context.setMarked(next, true);
+				nodeQueue.push_back(next);
+				stats.push(static_cast<int>(nodeQueue.size() - head - 1));
+			}
+		}
+	}
+	stats.stop();
+}
+
+// ----------------------------------------------------------------
+//  Name:           breadthFirstSearch
+//  Description:    Performs a breadth-first search for the goal and
+//                  processes the path back to the start.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the starting node index
+//                  The third parameter is the goal node index
+//                  The fourth parameter is the processing function
+//                  The fifth parameter is the stats policy, see
+//                  SearchStats.h.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Stats>
+void CompactGraph<NodeType, ArcType>::breadthFirstSearch( SearchContext& context, int start, int goal, void (*pProcess)(int), Stats& stats ) const {
+	stats.start();
+	context.reset(nodeCount());
+	vector<int> nodeQueue;
+	nodeQueue.reserve(nodeCount());
+
+	nodeQueue.push_back(start);
+	stats.push(1);
+	context.setMarked(start, true);
+	bool goalReached = (start == goal);
+	for (size_t head = 0; head < nodeQueue.size() && !goalReached; head++) {
+		int node = nodeQueue[head];
+		stats.expand();
+		for (int arc = arcBegin(node); arc != arcEnd(node) && !goalReached; arc++) {
+			int next = m_pTargets[arc];
+			stats.scan();
+			if (!context.marked(next)) {
+				stats.relax();
+				context.setMarked(next, true);
+				context.setPrevious(next, node);
+				nodeQueue.push_back(next);
+				stats.push(static_cast<int>(nodeQueue.size() - head - 1));
+				goalReached = (next == goal);
+			}
+		}
+	}
+
+	if (goalReached) {
+		for (int node = goal; node != -1; node = context.previous(node)) {
+			pProcess(node);
+		}
+	}
+	stats.stop();
+}
+
+// ----------------------------------------------------------------
+//  Name:           ucs
+//  Description:    Uniform cost search from the start node that
+//                  stops once the destination is settled, or runs
+//                  to completion if the destination is -1. The
+//                  path to the destination is returned from the
+//                  destination back to the start. The priority
+//                  queue type is a template parameter, a 4-ary
+//                  IndexedDaryHeap unless another is given. A
+//                  queue can be passed in to be reused between
+//                  searches, otherwise one is made for the call.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the priority queue
+//                  The third parameter is the starting node index
+//                  The fourth parameter is the destination index
+//                  The fifth parameter is the visit function, or a
+//                  visitor policy called with each node index, see
+//                  BestFirstSearch.h. NoVisitor costs nothing
+//                  where a function costs a call per node
+//                  The sixth parameter receives the path
+//                  The seventh parameter is the stats policy, see
+//                  SearchStats.h, none unless one is given.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Queue, class Visitor, class Stats>
+void CompactGraph<NodeType, ArcType>::ucs( SearchContext& context, Queue& nodeQueue, int start, int dest, Visitor& visitor, std::vector<int>& path, Stats& stats ) const {
+	// a destination of -1 is never settled, so the search covers
+	// the whole reachable graph
+	StopAtGoal termination(dest);
+	bestFirstSearch<UniformCostPriority>(*this, context, nodeQueue, NoHeuristic(), visitor, termination, stats, start, dest);
+
+	if (dest != -1)
+		buildPath(context, dest, path);
+	else
+		path.clear();
+}
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    A* search from the start node to the destination.
+//                  h(n) comes from a heuristic policy, see
+//                  Heuristics.h, the straight line distance unless
+//                  another is given, and is worked out the first
+//                  time a node is reached. A policy with a batch
+//                  member works out h for each run of a node's
+//                  arc targets at once instead, which costs a few
+//                  lanes on nodes already reached but lets the
+//                  straight line distance use SIMD. The path is returned
+//                  from the destination back to the start. The
+//                  priority queue is given as for ucs.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the priority queue
+//                  The third parameter is the heuristic policy
+//                  The fourth parameter is the starting node index
+//                  The fifth parameter is the destination index
+//                  The sixth parameter is the processing function,
+//                  or a visitor policy as for ucs
+//                  The seventh parameter receives the path
+//                  The eighth parameter is the stats policy, see
+//                  SearchStats.h, none unless one is given.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Queue, class Heuristic, class Visitor, class Stats>
+void CompactGraph<NodeType, ArcType>::aStar( SearchContext& context, Queue& nodeQueue, Heuristic const & heuristic, int start, int dest, Visitor& visitor, std::vector<int>& path, Stats& stats ) const {
+	StopAtGoal termination(dest);
+	bestFirstSearch<AStarPriority>(*this, context, nodeQueue, heuristic, visitor, termination, stats, start, dest);
+
+	buildPath(context, dest, path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           greedy
+//  Description:    Greedy best first search from the start node to
+//                  the destination, which always settles the node
+//                  with the smallest h(n). It settles far fewer
+//                  nodes than aStar but the path it finds need not
+//                  be the shortest. h(n) and the priority queue are
+//                  given as for aStar. The path is returned from
+//                  the destination back to the start.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the priority queue
+//                  The third parameter is the heuristic policy
+//                  The fourth parameter is the starting node index
+//                  The fifth parameter is the destination index
+//                  The sixth parameter is the processing function,
+//                  or a visitor policy as for ucs
+//                  The seventh parameter receives the path
+//                  The eighth parameter is the stats policy, see
+//                  SearchStats.h, none unless one is given.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Queue, class Heuristic, class Visitor, class Stats>
+void CompactGraph<NodeType, ArcType>::greedy( SearchContext& context, Queue& nodeQueue, Heuristic const & heuristic, int start, int dest, Visitor& visitor, std::vector<int>& path, Stats& stats ) const {
+	StopAtGoal termination(dest);
+	bestFirstSearch<GreedyPriority>(*this, context, nodeQueue, heuristic, visitor, termination, stats, start, dest);
+
+	buildPath(context, dest, path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           bidirectionalUcs
+//  Description:    Bidirectional uniform cost search, a forward
+//                  search from the start and a backward search from
+//                  the destination over the reverse arcs, which
+//                  stops when the two frontiers cannot improve on
+//                  the best path found where they meet. The path
+//                  is returned from the destination back to the
+//                  start.
+//  Arguments:      The first parameter is the forward search context
+//                  The second parameter is the backward search context
+//                  The third parameter is the starting node index
+//                  The fourth parameter is the destination index
+//                  The fifth parameter is the visit function
+//                  The sixth parameter receives the path.
+//  Return Value:   The length of the path, or infinity if there
+//                  is none.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+float CompactGraph<NodeType, ArcType>::bidirectionalUcs( SearchContext& forward, SearchContext& backward, int start, int dest, void (*pVisitFunc)(int), std::vector<int>& path ) const {
+	return bidirectional(forward, backward, start, dest, false, pVisitFunc, path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           bidirectionalAStar
+//  Description:    Bidirectional A*. Both searches use the average
+//                  of the straight line distances to the two ends,
+//                  (h_dest(n) - h_start(n)) / 2 forwards and its
+//                  negation backwards, which keeps the two searches
+//                  consistent with each other so the same stopping
+//                  rule as bidirectionalUcs applies. This needs
+//                  every arc to be at least as long as the straight
+//                  line between its nodes.
+//  Arguments:      As for bidirectionalUcs.
+//  Return Value:   The length of the path, or infinity if there
+//                  is none.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+float CompactGraph<NodeType, ArcType>::bidirectionalAStar( SearchContext& forward, SearchContext& backward, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const {
+	return bidirectional(forward, backward, start, dest, true, pProcess, path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           bidirectional
+//  Description:    The shared body of the bidirectional searches.
+//                  Each context's h(n) holds that side's potential,
+//                  so cost(n) is the queue key on both sides. The
+//                  side with the smaller top key is expanded, and
+//                  the search stops once the two top keys add up
+//                  to no less than the best meeting path.
+//  Arguments:      The contexts, the start and destination, whether
+//                  to use the straight line potentials, the visit
+//                  function and the path.
+//  Return Value:   The length of the path, or infinity if there
+//                  is none.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+float CompactGraph<NodeType, ArcType>::bidirectional( SearchContext& forward, SearchContext& backward, int start, int dest, bool useHeuristic, void (*pProcess)(int), std::vector<int>& path ) const {
+	forward.reset(nodeCount());
+	backward.reset(nodeCount());
+	IndexedDaryHeap<4> & forwardQueue = forward.queue();
+	IndexedDaryHeap<4> & backwardQueue = backward.queue();
+	Vector2 startPos = getPosition(start);
+	Vector2 endPos = getPosition(dest);
+
+	float best = numeric_limits<float>::infinity();
+	int meet = -1;
+	if (start == dest) {
+		best = 0;
+		meet = start;
+	}
+
+	forward.setDistance(start, 0);
+	backward.setDistance(dest, 0);
+	if (useHeuristic) {
+		float potential = (sqrt((startPos.x - endPos.x) * (startPos.x - endPos.x) + (startPos.y - endPos.y) * (startPos.y - endPos.y))) / 2;
+		forward.setHeuristic(start, potential);
+		backward.setHeuristic(dest, potential);
+	}
+	forwardQueue.push(start, forward.cost(start));
+	backwardQueue.push(dest, backward.cost(dest));
+
+	while (!forwardQueue.empty() && !backwardQueue.empty()
+		&& forwardQueue.topKey() + backwardQueue.topKey() < best) {
+		// expand whichever side has the smaller key
+		bool isForward = forwardQueue.topKey() <= backwardQueue.topKey();
+		SearchContext & context = isForward ? forward : backward;
+		SearchContext & other = isForward ? backward : forward;
+		IndexedDaryHeap<4> & nodeQueue = isForward ? forwardQueue : backwardQueue;
+		int const * pOffsets = isForward ? m_pOffsets : m_pReverseOffsets;
+		int const * pEnds = isForward ? m_pTargets : m_pReverseSources;
+		ArcType const * pWeights = isForward ? m_pWeights : m_pReverseWeights;
+
+		int currNode = nodeQueue.pop();
+		context.setMarked(currNode, true);
+		pProcess(currNode);
+
+		for (int arc = pOffsets[currNode]; arc != pOffsets[currNode + 1]; arc++) {
+			int next = pEnds[arc];
+			float searchDist = context.distance(currNode) + pWeights[arc];
+			if (!context.marked(next) && searchDist < context.distance(next)) {
+				// the potential only needs working out the first time a node is reached
+				if (useHeuristic && context.distance(next) == numeric_limits<float>::infinity()) {
+					Vector2 nextPos = getPosition(next);
+					float toDest = sqrt((nextPos.x - endPos.x) * (nextPos.x - endPos.x) + (nextPos.y - endPos.y) * (nextPos.y - endPos.y));
+					float toStart = sqrt((nextPos.x - startPos.x) * (nextPos.x - startPos.x) + (nextPos.y - startPos.y) * (nextPos.y - startPos.y));
+					context.setHeuristic(next, isForward ? (toDest - toStart) / 2 : (toStart - toDest) / 2);
+				}
+				context.setDistance(next, searchDist);
+				context.setPrevious(next, currNode);
+				nodeQueue.pushOrDecrease(next, context.cost(next));
+			}
+			// a node reached from both sides completes a path
+			float through = context.distance(next) + other.distance(next);
+			if (through < best) {
+				best = through;
+				meet = next;
+			}
+		}
+	}
+
+	// the path runs from the destination to the meeting node along the
+	// backward search, then back to the start along the forward search
+	path.clear();
+	if (meet == -1) {
+		path.push_back(dest);
+		return best;
+	}
+	for (int node = meet; node != -1; node = backward.previous(node)) {
+		path.push_back(node);
+	}
+	reverse(path.begin(), path.end());
+	for (int node = forward.previous(meet); node != -1; node = forward.previous(node)) {
+		path.push_back(node);
+	}
+	return best;
+}
+
+// ----------------------------------------------------------------
+//  Name:           oneToMany
+//  Description:    The distance from one source to each of a set of
+//                  targets, from a single uniform cost search that
+//                  stops once every target is settled. The context
+//                  holds the search afterwards, so the path to any
+//                  target can be followed back through previous().
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the source index
+//                  The third parameter is the target indices
+//                  The fourth parameter receives the distance to
+//                  each target, infinity if it can't be reached.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void CompactGraph<NodeType, ArcType>::oneToMany( SearchContext& context, int source, std::vector<int> const & targets, std::vector<float>& distances ) const {
+	vector<char> wanted(nodeCount(), false);
+	distances.resize(targets.size());
+	if (!targets.empty())
+		settleAll(context, context.queue(), wanted, source, targets, false, &distances[0], 1);
+}
+
+// ----------------------------------------------------------------
+//  Name:           distanceTable
+//  Description:    The distance from every source to every target.
+//                  One search is run for each source towards all of
+//                  the targets, or if there are fewer targets, one
+//                  search backwards over the reverse arcs from each
+//                  target towards all of the sources, so the number
+//                  of searches is the smaller of the two. Searches
+//                  are spread over the pool, each worker reusing
+//                  its own context and queue.
+//  Arguments:      The first parameter is the source indices
+//                  The second parameter is the target indices
+//                  The third parameter receives the table, row i
+//                  holding the distances from sources[i]
+//                  The fourth parameter is the pool to run on.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void CompactGraph<NodeType, ArcType>::distanceTable( std::vector<int> const & sources, std::vector<int> const & targets, std::vector<float>& table, ThreadPool& pool ) const {
+	int rows = static_cast<int>(sources.size());
+	int columns = static_cast<int>(targets.size());
+	if (static_cast<int>(table.size()) != rows * columns)
+		table.resize(rows * columns);
+	if (rows == 0 || columns == 0)
+		return;
+
+	struct Workspace {
+		SearchContext context;
+		vector<char> wanted;
+	};
+	vector<Workspace> workspaces(pool.workerCount());
+
+	bool backward = columns < rows;
+	pool.parallelFor(backward ? columns : rows, 1, [&](int worker, int begin, int end) {
+		Workspace & workspace = workspaces[worker];
+		if (workspace.wanted.empty())
+			workspace.wanted.assign(nodeCount(), false);
+		for (int i = begin; i < end; i++) {
+			if (backward)
+				settleAll(workspace.context, workspace.context.queue(), workspace.wanted, targets[i], sources, true, &table[i], columns);
+			else
+				settleAll(workspace.context, workspace.context.queue(), workspace.wanted, sources[i], targets, false, &table[i * columns], 1);
+		}
+	});
+}
+
+// ----------------------------------------------------------------
+//  Name:           settleAll
+//  Description:    Uniform cost search from one node, forwards or
+//                  backwards, until every node in ends is settled.
+//                  The distance to ends[k] is written to
+//                  pOut[k * stride]. wanted must be all false on
+//                  entry and is left that way.
+//  Arguments:      The context, queue and wanted flags to use, the
+//                  node to search from, the nodes to reach, the
+//                  direction and where to write the distances.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void CompactGraph<NodeType, ArcType>::settleAll( SearchContext& context, IndexedDaryHeap<4>& nodeQueue, std::vector<char>& wanted, int source,
+                                                 std::vector<int> const & ends, bool backward, float* pOut, int stride ) const {
+	context.reset(nodeCount());
+	nodeQueue.reset(nodeCount());
+	int const * pOffsets = backward ? m_pReverseOffsets : m_pOffsets;
+	int const * pNodes = backward ? m_pReverseSources : m_pTargets;
+	ArcType const * pWeights = backward ? m_pReverseWeights : m_pWeights;
+
+	// count each end once, the same node may be asked for twice
+	int remaining = 0;
+	for (size_t k = 0; k < ends.size(); k++) {
+		if (!wanted[ends[k]]) {
+			wanted[ends[k]] = true;
+			remaining++;
+		}
+	}
+
+	context.setDistance(source, 0);
+	nodeQueue.push(source, 0);
+	while (!nodeQueue.empty() && remaining > 0) {
+		int currNode = nodeQueue.pop();
+		context.setMarked(currNode, true);
+		if (wanted[currNode] && --remaining == 0)
+			break;
+
+		for (int arc = pOffsets[currNode]; arc != pOffsets[currNode + 1]; arc++) {
+			int next = pNodes[arc];
+			float dist = context.distance(currNode) + pWeights[arc];
+			if (!context.marked(next) && dist < context.distance(next)) {
+				context.setDistance(next, dist);
+				context.setPrevious(next, currNode);
+				nodeQueue.pushOrDecrease(next, dist);
+			}
+		}
+	}
+
+	for (size_t k = 0; k < ends.size(); k++) {
+		pOut[k * stride] = context.distance(ends[k]);
+		wanted[ends[k]] = false;
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           buildPath
+//  Description:    Follows the previous indices back from the
+//                  destination.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the destination index
+//                  The third parameter receives the path.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void CompactGraph<NodeType, ArcType>::buildPath( SearchContext const & context, int dest, std::vector<int>& path ) {
+	path.clear();
+	for (int node = dest; node != -1; node = context.previous(node)) {
+		path.push_back(node);
+	}
+}
+
+#endif
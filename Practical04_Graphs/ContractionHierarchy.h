@@ -0,0 +1,753 @@
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Graph.h"
+#include "IndexedHeap.h"
+#include "SearchContext.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           ContractionHierarchy
+//  Description:    A contraction hierarchy over a fixed graph. The
+//                  nodes are removed one by one, least important
+//                  first, adding a shortcut arc between two of a
+//                  removed node's neighbours wherever the only
+//                  shortest path between them ran through it. A
+//                  query then searches only upwards, to nodes
+//                  removed later, from both ends, which settles a
+//                  tiny part of a road network. Shortcuts remember
+//                  the node they skip so a path can be unpacked
+//                  back into the original arcs.
+// ----------------------------------------------------------------
+class ContractionHierarchy {
+private:
+// ----------------------------------------------------------------
+//  Description:    An arc of the hierarchy, middle is the node a
+//                  shortcut skips, or -1 for an original arc.
+// ----------------------------------------------------------------
+    struct Edge {
+        int node;
+        float weight;
+        int middle;
+    };
+
+    struct Shortcut {
+        int from;
+        int to;
+        float weight;
+        int middle;
+    };
+
+// ----------------------------------------------------------------
+//  Description:    The graph while it is being contracted, holding
+//                  only the arcs between nodes still in it.
+// ----------------------------------------------------------------
+    struct Remaining {
+        vector<vector<Edge> > out;
+        vector<vector<Edge> > in;
+        vector<char> state;
+        vector<int> deleted;
+        vector<int> priority;
+    };
+
+// ----------------------------------------------------------------
+//  Description:    The scratch space of one worker's witness
+//                  searches.
+// ----------------------------------------------------------------
+    struct Witness {
+        vector<float> distance;
+        vector<char> isTarget;
+        vector<int> touched;
+        IndexedDaryHeap<4> nodeQueue;
+        vector<Shortcut> shortcuts;
+    };
+
+    enum { ACTIVE, CONTRACTING, CONTRACTED };
+
+// ----------------------------------------------------------------
+//  Description:    A witness search gives up after settling this
+//                  many nodes, adding a shortcut that may not be
+//                  needed rather than searching further.
+// ----------------------------------------------------------------
+    static const int SETTLE_LIMIT = 500;
+
+// ----------------------------------------------------------------
+//  Description:    The order each node was contracted in.
+// ----------------------------------------------------------------
+    vector<int> m_rank;
+
+// ----------------------------------------------------------------
+//  Description:    The upward arcs leaving each node, to nodes of
+//                  higher rank, in compressed sparse row form.
+// ----------------------------------------------------------------
+    vector<int> m_upOffsets;
+    vector<int> m_upTargets;
+    vector<float> m_upWeights;
+    vector<int> m_upMiddles;
+
+// ----------------------------------------------------------------
+//  Description:    The arcs entering each node from nodes of
+//                  higher rank, for the backward search.
+//                  m_downSources holds the node each arc leaves.
+// ----------------------------------------------------------------
+    vector<int> m_downOffsets;
+    vector<int> m_downSources;
+    vector<float> m_downWeights;
+    vector<int> m_downMiddles;
+
+public:
+    // Constructor functions
+    ContractionHierarchy();
+    template<class NodeType, class ArcType>
+    ContractionHierarchy( CompactGraph<NodeType, ArcType> const & graph, ThreadPool * pPool = 0 );
+    template<class NodeType, class ArcType>
+    ContractionHierarchy( Graph<NodeType, ArcType> const & graph, ThreadPool * pPool = 0 );
+
+    // Accessors
+    int nodeCount() const {
+        return static_cast<int>(m_rank.size());
+    }
+
+    int rank( int node ) const {
+        return m_rank[node];
+    }
+
+    int shortcutCount() const;
+
+    // Public member functions.
+    float query( SearchContext& forward, SearchContext& backward, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const;
+    template<class NodeType, class ArcType>
+    float query( Graph<NodeType, ArcType> const & graph, SearchContext& forward, SearchContext& backward,
+                 GraphNode<NodeType, ArcType>* pStart, GraphNode<NodeType, ArcType>* pDest,
+                 void (*pProcess)(int), std::vector<GraphNode<NodeType, ArcType>*>& path ) const;
+    bool save( string const & fileName ) const;
+    bool load( string const & fileName );
+
+private:
+    template<class NodeType, class ArcType>
+    void build( CompactGraph<NodeType, ArcType> const & graph, ThreadPool * pPool );
+    static void addEdge( vector<Edge>& edges, int node, float weight, int middle );
+    static void removeEdge( vector<Edge>& edges, int node );
+    static void findShortcuts( Remaining const & graph, Witness& witness, int node );
+    static void forEach( ThreadPool * pPool, int count, function<void(int, int, int)> const & task );
+    int middle( int from, int to ) const;
+    void unpack( int from, int to, std::vector<int>& path ) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           ContractionHierarchy
+//  Description:    Constructor, this makes an empty hierarchy to
+//                  load into.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline ContractionHierarchy::ContractionHierarchy() : m_upOffsets( 1, 0 ), m_downOffsets( 1, 0 ) {
+}
+
+// ----------------------------------------------------------------
+//  Name:           ContractionHierarchy
+//  Description:    Constructor, this contracts a compact graph.
+//  Arguments:      The first parameter is the graph
+//                  The second parameter is a pool to share the
+//                  witness searches over, or 0 to use this thread.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+ContractionHierarchy::ContractionHierarchy( CompactGraph<NodeType, ArcType> const & graph, ThreadPool * pPool ) {
+	build(graph, pPool);
+}
+
+// ----------------------------------------------------------------
+//  Name:           ContractionHierarchy
+//  Description:    Constructor, this contracts a graph as it is
+//                  now, later changes are not reflected.
+//  Arguments:      As above.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+ContractionHierarchy::ContractionHierarchy( Graph<NodeType, ArcType> const & graph, ThreadPool * pPool ) {
+	build(graph.freeze(), pPool);
+}
+
+// ----------------------------------------------------------------
+//  Name:           shortcutCount
+//  Description:    Counts the arcs of the hierarchy that are
+//                  shortcuts rather than arcs of the graph.
+//  Arguments:      None.
+//  Return Value:   The number of shortcuts.
+// ----------------------------------------------------------------
+inline int ContractionHierarchy::shortcutCount() const {
+	int count = 0;
+	for (size_t arc = 0; arc < m_upMiddles.size(); arc++)
+		count += (m_upMiddles[arc] != -1) ? 1 : 0;
+	for (size_t arc = 0; arc < m_downMiddles.size(); arc++)
+		count += (m_downMiddles[arc] != -1) ? 1 : 0;
+	return count;
+}
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Contracts the graph in rounds. Each node's
+//                  priority is its edge difference, the shortcuts
+//                  its removal would add less the arcs it removes,
+//                  plus the number of its neighbours already gone,
+//                  which spreads the contraction evenly. Each round
+//                  takes every node whose priority is below all of
+//                  its neighbours', so no two are adjacent and
+//                  their witness searches, which skip every node of
+//                  the round, can run in parallel.
+//  Arguments:      The graph and the pool, or 0.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void ContractionHierarchy::build( CompactGraph<NodeType, ArcType> const & graph, ThreadPool * pPool ) {
+	int count = graph.nodeCount();
+	Remaining remaining;
+	remaining.out.resize(count);
+	remaining.in.resize(count);
+	remaining.state.assign(count, ACTIVE);
+	remaining.deleted.assign(count, 0);
+	remaining.priority.assign(count, 0);
+	for (int node = 0; node < count; node++) {
+		for (int arc = graph.arcBegin(node); arc != graph.arcEnd(node); arc++) {
+			int to = graph.target(arc);
+			if (to != node) {
+				addEdge(remaining.out[node], to, static_cast<float>(graph.weight(arc)), -1);
+				addEdge(remaining.in[to], node, static_cast<float>(graph.weight(arc)), -1);
+			}
+		}
+	}
+
+	int workers = (pPool != 0) ? pPool->workerCount() : 1;
+	vector<Witness> witnesses(workers);
+	for (int i = 0; i < workers; i++) {
+		witnesses[i].distance.assign(count, numeric_limits<float>::infinity());
+		witnesses[i].isTarget.assign(count, false);
+		witnesses[i].nodeQueue.reset(count);
+	}
+
+	// works out the priority of each node in a list
+	vector<int> update;
+	function<void(int, int, int)> prioritise = [&](int worker, int begin, int end) {
+		Witness & witness = witnesses[worker];
+		for (int i = begin; i < end; i++) {
+			int node = update[i];
+			findShortcuts(remaining, witness, node);
+			int removed = static_cast<int>(remaining.out[node].size() + remaining.in[node].size());
+			remaining.priority[node] = 2 * static_cast<int>(witness.shortcuts.size()) - removed + remaining.deleted[node];
+		}
+	};
+
+	vector<int> active(count);
+	for (int node = 0; node < count; node++)
+		active[node] = node;
+	update = active;
+	forEach(pPool, static_cast<int>(update.size()), prioritise);
+
+	vector<int> round;
+	vector<vector<Shortcut> > found;
+	vector<char> dirty(count, false);
+	vector<vector<Edge> > up(count);
+	vector<vector<Edge> > down(count);
+	m_rank.assign(count, -1);
+	int nextRank = 0;
+	while (!active.empty()) {
+		// take the nodes that are more contractible than all their neighbours
+		round.clear();
+		for (size_t i = 0; i < active.size(); i++) {
+			int node = active[i];
+			int priority = remaining.priority[node];
+			bool lowest = true;
+			for (int side = 0; side < 2 && lowest; side++) {
+				vector<Edge> const & edges = side == 0 ? remaining.out[node] : remaining.in[node];
+				for (size_t e = 0; e < edges.size() && lowest; e++) {
+					int other = remaining.priority[edges[e].node];
+					lowest = priority < other || (priority == other && node < edges[e].node);
+				}
+			}
+			if (lowest)
+				round.push_back(node);
+		}
+		for (size_t i = 0; i < round.size(); i++)
+			remaining.state[round[i]] = CONTRACTING;
+
+		found.resize(round.size());
+		forEach(pPool, static_cast<int>(round.size()), [&](int worker, int begin, int end) {
+			for (int i = begin; i < end; i++) {
+				findShortcuts(remaining, witnesses[worker], round[i]);
+				found[i] = witnesses[worker].shortcuts;
+			}
+		});
+
+		// remove the round's nodes, their remaining arcs all lead upwards
+		update.clear();
+		for (size_t i = 0; i < round.size(); i++) {
+			int node = round[i];
+			m_rank[node] = nextRank++;
+			remaining.state[node] = CONTRACTED;
+			up[node].swap(remaining.out[node]);
+			down[node].swap(remaining.in[node]);
+			for (int side = 0; side < 2; side++) {
+				vector<Edge> const & edges = side == 0 ? up[node] : down[node];
+				for (size_t e = 0; e < edges.size(); e++) {
+					int other = edges[e].node;
+					removeEdge(side == 0 ? remaining.in[other] : remaining.out[other], node);
+					remaining.deleted[other]++;
+					if (!dirty[other]) {
+						dirty[other] = true;
+						update.push_back(other);
+					}
+				}
+			}
+		}
+		for (size_t i = 0; i < found.size(); i++) {
+			for (size_t s = 0; s < found[i].size(); s++) {
+				Shortcut const & shortcut = found[i][s];
+				addEdge(remaining.out[shortcut.from], shortcut.to, shortcut.weight, shortcut.middle);
+				addEdge(remaining.in[shortcut.to], shortcut.from, shortcut.weight, shortcut.middle);
+			}
+		}
+
+		// only the neighbours of the round have a new priority
+		for (size_t i = 0; i < update.size(); i++)
+			dirty[update[i]] = false;
+		forEach(pPool, static_cast<int>(update.size()), prioritise);
+
+		size_t kept = 0;
+		for (size_t i = 0; i < active.size(); i++) {
+			if (remaining.state[active[i]] == ACTIVE)
+				active[kept++] = active[i];
+		}
+		active.resize(kept);
+	}
+
+	// flatten the upward and downward arcs
+	m_upOffsets.assign(count + 1, 0);
+	m_downOffsets.assign(count + 1, 0);
+	m_upTargets.clear();
+	m_upWeights.clear();
+	m_upMiddles.clear();
+	m_downSources.clear();
+	m_downWeights.clear();
+	m_downMiddles.clear();
+	for (int node = 0; node < count; node++) {
+		for (size_t e = 0; e < up[node].size(); e++) {
+			m_upTargets.push_back(up[node][e].node);
+			m_upWeights.push_back(up[node][e].weight);
+			m_upMiddles.push_back(up[node][e].middle);
+		}
+		for (size_t e = 0; e < down[node].size(); e++) {
+			m_downSources.push_back(down[node][e].node);
+			m_downWeights.push_back(down[node][e].weight);
+			m_downMiddles.push_back(down[node][e].middle);
+		}
+		m_upOffsets[node + 1] = static_cast<int>(m_upTargets.size());
+		m_downOffsets[node + 1] = static_cast<int>(m_downSources.size());
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           addEdge
+//  Description:    Adds an arc to a list, or shortens the arc that
+//                  is there to the same node.
+//  Arguments:      The list, the node, the weight and the middle.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void ContractionHierarchy::addEdge( vector<Edge>& edges, int node, float weight, int middle ) {
+	for (size_t e = 0; e < edges.size(); e++) {
+		if (edges[e].node == node) {
+			if (weight < edges[e].weight) {
+				edges[e].weight = weight;
+				edges[e].middle = middle;
+			}
+			return;
+		}
+	}
+	Edge edge;
+	edge.node = node;
+	edge.weight = weight;
+	edge.middle = middle;
+	edges.push_back(edge);
+}
+
+// ----------------------------------------------------------------
+//  Name:           removeEdge
+//  Description:    Removes the arc to a node from a list.
+//  Arguments:      The list and the node.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void ContractionHierarchy::removeEdge( vector<Edge>& edges, int node ) {
+	for (size_t e = 0; e < edges.size(); e++) {
+		if (edges[e].node == node) {
+			edges[e] = edges.back();
+			edges.pop_back();
+			return;
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           findShortcuts
+//  Description:    Works out the shortcuts removing a node needs.
+//                  From each of its in-neighbours a small search
+//                  that avoids the node, and every node not ACTIVE,
+//                  looks for a path to each out-neighbour no longer
+//                  than the one through the node. Where none is
+//                  found a shortcut is needed.
+//  Arguments:      The remaining graph, the worker's witness space
+//                  which receives the shortcuts, and the node.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void ContractionHierarchy::findShortcuts( Remaining const & graph, Witness& witness, int node ) {
+	witness.shortcuts.clear();
+	vector<Edge> const & in = graph.in[node];
+	vector<Edge> const & out = graph.out[node];
+	for (size_t i = 0; i < in.size(); i++) {
+		int from = in[i].node;
+		if (graph.state[from] != ACTIVE)
+			continue;
+		float longest = -1;
+		int targets = 0;
+		for (size_t o = 0; o < out.size(); o++) {
+			if (out[o].node != from && graph.state[out[o].node] == ACTIVE) {
+				longest = max(longest, out[o].weight);
+				witness.isTarget[out[o].node] = true;
+				targets++;
+			}
+		}
+		if (targets == 0)
+			continue;
+		float limit = in[i].weight + longest;
+
+		// bounded search from the in-neighbour
+		witness.nodeQueue.reset(static_cast<int>(witness.distance.size()));
+		witness.distance[from] = 0;
+		witness.touched.push_back(from);
+		witness.nodeQueue.push(from, 0);
+		int settled = 0;
+		// stop once every out-neighbour is settled
+		while (!witness.nodeQueue.empty() && witness.nodeQueue.topKey() <= limit && settled < SETTLE_LIMIT && targets > 0) {
+			int curr = witness.nodeQueue.pop();
+			settled++;
+			if (witness.isTarget[curr])
+				targets--;
+			vector<Edge> const & edges = graph.out[curr];
+			for (size_t e = 0; e < edges.size(); e++) {
+				int next = edges[e].node;
+				if (next == node || graph.state[next] != ACTIVE)
+					continue;
+				float dist = witness.distance[curr] + edges[e].weight;
+				if (dist < witness.distance[next]) {
+					if (witness.distance[next] == numeric_limits<float>::infinity())
+						witness.touched.push_back(next);
+					witness.distance[next] = dist;
+					witness.nodeQueue.pushOrDecrease(next, dist);
+				}
+			}
+		}
+
+		for (size_t o = 0; o < out.size(); o++) {
+			int to = out[o].node;
+			float through = in[i].weight + out[o].weight;
+			witness.isTarget[to] = false;
+			if (to != from && graph.state[to] == ACTIVE && witness.distance[to] > through) {
+				Shortcut shortcut;
+				shortcut.from = from;
+				shortcut.to = to;
+				shortcut.weight = through;
+				shortcut.middle = node;
+				witness.shortcuts.push_back(shortcut);
+			}
+		}
+
+		for (size_t t = 0; t < witness.touched.size(); t++)
+			witness.distance[witness.touched[t]] = numeric_limits<float>::infinity();
+		witness.touched.clear();
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           forEach
+//  Description:    Runs a task over [0, count) on the pool, or on
+//                  this thread as worker 0 if there is no pool.
+//  Arguments:      The pool or 0, the count and the task.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void ContractionHierarchy::forEach( ThreadPool * pPool, int count, function<void(int, int, int)> const & task ) {
+	if (pPool != 0)
+		pPool->parallelFor(count, 64, task);
+	else if (count > 0)
+		task(0, 0, count);
+}
+
+// ----------------------------------------------------------------
+//  Name:           query
+//  Description:    The shortest path between two nodes. Forward
+//                  from the start and backward from the destination
+//                  the search only follows arcs to higher ranked
+//                  nodes, and a side stops once its smallest key
+//                  can't beat the best meeting found. A node that
+//                  is reached more cheaply through a higher node
+//                  is not expanded (stall-on-demand). The path is
+//                  unpacked into original arcs and returned from
+//                  the destination back to the start.
+//  Arguments:      The first parameter is the forward search context
+//                  The second parameter is the backward search context
+//                  The third parameter is the starting node index
+//                  The fourth parameter is the destination index
+//                  The fifth parameter is called for each settled node
+//                  The sixth parameter receives the path.
+//  Return Value:   The length of the path, or infinity if there
+//                  is none.
+// ----------------------------------------------------------------
+inline float ContractionHierarchy::query( SearchContext& forward, SearchContext& backward, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const {
+	forward.reset(nodeCount());
+	backward.reset(nodeCount());
+	IndexedDaryHeap<4> & forwardQueue = forward.queue();
+	IndexedDaryHeap<4> & backwardQueue = backward.queue();
+
+	float best = numeric_limits<float>::infinity();
+	int meet = -1;
+	forward.setDistance(start, 0);
+	backward.setDistance(dest, 0);
+	forwardQueue.push(start, 0);
+	backwardQueue.push(dest, 0);
+
+	bool forwardDone = false;
+	bool backwardDone = false;
+	for (;;) {
+		forwardDone = forwardDone || forwardQueue.empty() || forwardQueue.topKey() >= best;
+		backwardDone = backwardDone || backwardQueue.empty() || backwardQueue.topKey() >= best;
+		if (forwardDone && backwardDone)
+			break;
+
+		bool isForward = !forwardDone && (backwardDone || forwardQueue.topKey() <= backwardQueue.topKey());
+		SearchContext & context = isForward ? forward : backward;
+		SearchContext & other = isForward ? backward : forward;
+		IndexedDaryHeap<4> & nodeQueue = isForward ? forwardQueue : backwardQueue;
+
+		int currNode = nodeQueue.pop();
+		context.setMarked(currNode, true);
+		pProcess(currNode);
+		float currDist = context.distance(currNode);
+		if (currDist + other.distance(currNode) < best) {
+			best = currDist + other.distance(currNode);
+			meet = currNode;
+		}
+
+		// the arcs down to this node show whether a higher node reaches it for less
+		vector<int> const & downOffsets = isForward ? m_downOffsets : m_upOffsets;
+		vector<int> const & downNodes = isForward ? m_downSources : m_upTargets;
+		vector<float> const & downWeights = isForward ? m_downWeights : m_upWeights;
+		bool stalled = false;
+		for (int arc = downOffsets[currNode]; arc != downOffsets[currNode + 1] && !stalled; arc++) {
+			stalled = context.distance(downNodes[arc]) + downWeights[arc] < currDist;
+		}
+		if (stalled)
+			continue;
+
+		vector<int> const & offsets = isForward ? m_upOffsets : m_downOffsets;
+		vector<int> const & nodes = isForward ? m_upTargets : m_downSources;
+		vector<float> const & weights = isForward ? m_upWeights : m_downWeights;
+		for (int arc = offsets[currNode]; arc != offsets[currNode + 1]; arc++) {
+			int next = nodes[arc];
+			float dist = currDist + weights[arc];
+			if (dist < context.distance(next)) {
+				context.setDistance(next, dist);
+				context.setPrevious(next, currNode);
+				nodeQueue.pushOrDecrease(next, dist);
+			}
+		}
+	}
+
+	// unpack start to meet along the forward search, then meet to the
+	// destination along the backward search
+	path.clear();
+	if (meet == -1) {
+		path.push_back(dest);
+		return best;
+	}
+	vector<int> chain;
+	for (int node = meet; node != -1; node = forward.previous(node))
+		chain.push_back(node);
+	reverse(chain.begin(), chain.end());
+	for (int node = backward.previous(meet); node != -1; node = backward.previous(node))
+		chain.push_back(node);
+
+	path.push_back(chain[0]);
+	for (size_t i = 0; i + 1 < chain.size(); i++)
+		unpack(chain[i], chain[i + 1], path);
+	reverse(path.begin(), path.end());
+	return best;
+}
+
+// ----------------------------------------------------------------
+//  Name:           query
+//  Description:    As above, for nodes of the graph the hierarchy
+//                  was built from, with the path as graph nodes.
+//  Arguments:      The first parameter is the graph
+//                  The rest are as above.
+//  Return Value:   The length of the path, or infinity if there
+//                  is none.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+float ContractionHierarchy::query( Graph<NodeType, ArcType> const & graph, SearchContext& forward, SearchContext& backward,
+                                   GraphNode<NodeType, ArcType>* pStart, GraphNode<NodeType, ArcType>* pDest,
+                                   void (*pProcess)(int), std::vector<GraphNode<NodeType, ArcType>*>& path ) const {
+	vector<int> indices;
+	float distance = query(forward, backward, pStart->index(), pDest->index(), pProcess, indices);
+	path.clear();
+	for (size_t i = 0; i < indices.size(); i++)
+		path.push_back(graph.nodeArray()[indices[i]]);
+	return distance;
+}
+
+// ----------------------------------------------------------------
+//  Name:           middle
+//  Description:    Finds the arc of the hierarchy between two nodes,
+//                  which is kept with the lower ranked of the two.
+//  Arguments:      The nodes the arc leaves and enters.
+//  Return Value:   The node the arc skips, or -1 for an original
+//                  arc.
+// ----------------------------------------------------------------
+inline int ContractionHierarchy::middle( int from, int to ) const {
+	if (m_rank[from] < m_rank[to]) {
+		for (int arc = m_upOffsets[from]; arc != m_upOffsets[from + 1]; arc++) {
+			if (m_upTargets[arc] == to)
+				return m_upMiddles[arc];
+		}
+	}
+	else {
+		for (int arc = m_downOffsets[to]; arc != m_downOffsets[to + 1]; arc++) {
+			if (m_downSources[arc] == from)
+				return m_downMiddles[arc];
+		}
+	}
+	return -1;
+}
+
+// ----------------------------------------------------------------
+//  Name:           unpack
+//  Description:    Expands an arc of the hierarchy into the arcs of
+//                  the graph, a shortcut being the arcs into and out
+//                  of the node it skips, each possibly a shortcut
+//                  again.
+//  Arguments:      The nodes the arc leaves and enters, and the
+//                  path to add the nodes after the first to.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void ContractionHierarchy::unpack( int from, int to, std::vector<int>& path ) const {
+	vector<pair<int, int> > pending;
+	pending.push_back(make_pair(from, to));
+	while (!pending.empty()) {
+		pair<int, int> arc = pending.back();
+		pending.pop_back();
+		int skipped = middle(arc.first, arc.second);
+		if (skipped == -1) {
+			path.push_back(arc.second);
+		}
+		else {
+			// the first half goes on top so it is expanded first
+			pending.push_back(make_pair(skipped, arc.second));
+			pending.push_back(make_pair(arc.first, skipped));
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           save
+//  Description:    Writes the hierarchy to a binary file, in the
+//                  byte order of this machine.
+//  Arguments:      The file name.
+//  Return Value:   True if the file was written.
+// ----------------------------------------------------------------
+inline bool ContractionHierarchy::save( string const & fileName ) const {
+	ofstream file(fileName.c_str(), ios::binary);
+	if (!file)
+		return false;
+	int32_t header[5] = { 0x48434650, 1, nodeCount(), static_cast<int32_t>(m_upTargets.size()), static_cast<int32_t>(m_downSources.size()) };
+	file.write(reinterpret_cast<char const *>(header), sizeof(header));
+	file.write(reinterpret_cast<char const *>(m_rank.data()), sizeof(int) * m_rank.size());
+	file.write(reinterpret_cast<char const *>(m_upOffsets.data()), sizeof(int) * m_upOffsets.size());
+	file.write(reinterpret_cast<char const *>(m_upTargets.data()), sizeof(int) * m_upTargets.size());
+	file.write(reinterpret_cast<char const *>(m_upWeights.data()), sizeof(float) * m_upWeights.size());
+	file.write(reinterpret_cast<char const *>(m_upMiddles.data()), sizeof(int) * m_upMiddles.size());
+	file.write(reinterpret_cast<char const *>(m_downOffsets.data()), sizeof(int) * m_downOffsets.size());
+	file.write(reinterpret_cast<char const *>(m_downSources.data()), sizeof(int) * m_downSources.size());
+	file.write(reinterpret_cast<char const *>(m_downWeights.data()), sizeof(float) * m_downWeights.size());
+	file.write(reinterpret_cast<char const *>(m_downMiddles.data()), sizeof(int) * m_downMiddles.size());
+	return static_cast<bool>(file);
+}
+
+// ----------------------------------------------------------------
+//  Name:           load
+//  Description:    Reads a hierarchy written by save. The hierarchy
+//                  is left empty if the file can't be read.
+//  Arguments:      The file name.
+//  Return Value:   True if the hierarchy was read.
+// ----------------------------------------------------------------
+inline bool ContractionHierarchy::load( string const & fileName ) {
+	*this = ContractionHierarchy();
+	ifstream file(fileName.c_str(), ios::binary);
+	int32_t header[5];
+	if (!file.read(reinterpret_cast<char *>(header), sizeof(header)))
+		return false;
+	if (header[0] != 0x48434650 || header[1] != 1 || header[2] < 0 || header[3] < 0 || header[4] < 0)
+		return false;
+
+	ContractionHierarchy loaded;
+	loaded.m_rank.resize(header[2]);
+	loaded.m_upOffsets.resize(header[2] + 1);
+	loaded.m_upTargets.resize(header[3]);
+	loaded.m_upWeights.resize(header[3]);
+	loaded.m_upMiddles.resize(header[3]);
+	loaded.m_downOffsets.resize(header[2] + 1);
+	loaded.m_downSources.resize(header[4]);
+	loaded.m_downWeights.resize(header[4]);
+	loaded.m_downMiddles.resize(header[4]);
+	file.read(reinterpret_cast<char *>(loaded.m_rank.data()), sizeof(int) * loaded.m_rank.size());
+	file.read(reinterpret_cast<char *>(loaded.m_upOffsets.data()), sizeof(int) * loaded.m_upOffsets.size());
+	file.read(reinterpret_cast<char *>(loaded.m_upTargets.data()), sizeof(int) * loaded.m_upTargets.size());
+	file.read(reinterpret_cast<char *>(loaded.m_upWeights.data()), sizeof(float) * loaded.m_upWeights.size());
+	file.read(reinterpret_cast<char *>(loaded.m_upMiddles.data()), sizeof(int) * loaded.m_upMiddles.size());
+	file.read(reinterpret_cast<char *>(loaded.m_downOffsets.data()), sizeof(int) * loaded.m_downOffsets.size());
+	file.read(reinterpret_cast<char *>(loaded.m_downSources.data()), sizeof(int) * loaded.m_downSources.size());
+	file.read(reinterpret_cast<char *>(loaded.m_downWeights.data()), sizeof(float) * loaded.m_downWeights.size());
+	file.read(reinterpret_cast<char *>(loaded.m_downMiddles.data()), sizeof(int) * loaded.m_downMiddles.size());
+	if (!file)
+		return false;
+
+	// the offsets must run through the arc arrays in order
+	for (int node = 0; node < header[2]; node++) {
+		if (loaded.m_upOffsets[node] > loaded.m_upOffsets[node + 1] || loaded.m_downOffsets[node] > loaded.m_downOffsets[node + 1])
+			return false;
+	}
+	if (loaded.m_upOffsets[0] != 0 || loaded.m_upOffsets[header[2]] != header[3]
+		|| loaded.m_downOffsets[0] != 0 || loaded.m_downOffsets[header[2]] != header[4])
+		return false;
+
+	// and every node index must be in range
+	int count = header[2];
+	for (int arc = 0; arc < header[3]; arc++) {
+		if (loaded.m_upTargets[arc] < 0 || loaded.m_upTargets[arc] >= count || loaded.m_upMiddles[arc] < -1 || loaded.m_upMiddles[arc] >= count)
+			return false;
+	}
+	for (int arc = 0; arc < header[4]; arc++) {
+		if (loaded.m_downSources[arc] < 0 || loaded.m_downSources[arc] >= count || loaded.m_downMiddles[arc] < -1 || loaded.m_downMiddles[arc] >= count)
+			return false;
+	}
+
+	*this = loaded;
+	return true;
+}
+
+#endif
@@ -0,0 +1,260 @@
+#ifndef EDGELIST_H
+#define EDGELIST_H
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "Graph.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           EdgeList
+//  Description:    Reads a text list of arcs, one "from to weight"
+//                  line per arc separated by spaces or tabs, as in
+//                  Q1Arcs.txt, straight into a compact graph. The
+//                  file is mapped and cut into chunks at line ends,
+//                  each chunk is parsed on the pool with from_chars,
+//                  which ignores the locale, and the arcs are then
+//                  grouped by node with a counting sort rather than
+//                  added one at a time.
+// ----------------------------------------------------------------
+template<class ArcType>
+class EdgeList {
+private:
+// ----------------------------------------------------------------
+//  Description:    The arcs of one chunk, in file order, and the
+//                  largest node index they name.
+// ----------------------------------------------------------------
+    struct Chunk {
+        vector<int> froms;
+        vector<int> tos;
+        vector<ArcType> weights;
+        int maxNode;
+        bool valid;
+    };
+
+public:
+// ----------------------------------------------------------------
+//  Description:    The most nodes the arcs may name unless the
+//                  caller says otherwise. The offsets alone take 4
+//                  bytes a node, so a line naming a huge index would
+//                  otherwise be a huge allocation.
+// ----------------------------------------------------------------
+    static const int DEFAULT_MAX_NODES = 1 << 26;
+
+    template<class NodeType>
+    static bool import( string const & fileName, vector<Vector2>& positions, CompactGraph<NodeType, ArcType>& graph, ThreadPool * pPool = 0,
+                        int maxNodes = DEFAULT_MAX_NODES );
+
+private:
+    static void parse( char const * pBegin, char const * pEnd, Chunk& chunk );
+    static char const * skipBlanks( char const * p, char const * pEnd );
+    static bool lineEnd( char const * p, char const * pEnd );
+};
+
+// ----------------------------------------------------------------
+//  Name:           import
+//  Description:    Reads an arc list into a compact graph. A node
+//                  is only given an arc once, later repeats are
+//                  dropped as addArc would.
+//  Arguments:      The first parameter is the file name
+//                  The second parameter is the position of each
+//                  node. It is padded with (0, 0) up to the largest
+//                  node the arcs name, then swapped into the graph.
+//                  The third parameter is the graph to set
+//                  The fourth parameter is a pool to parse the
+//                  chunks on, or 0 to use this thread
+//                  The fifth parameter is the most nodes the arcs
+//                  may name, every index must be below it.
+//  Return Value:   True if the file was read, false if it can't
+//                  be read, a line is not three numbers or an arc
+//                  names a node at or past maxNodes. The graph is
+//                  left as it was on failure.
+// ----------------------------------------------------------------
+template<class ArcType>
+template<class NodeType>
+bool EdgeList<ArcType>::import( string const & fileName, vector<Vector2>& positions, CompactGraph<NodeType, ArcType>& graph, ThreadPool * pPool,
+                                int maxNodes ) {
+	MappedFile file;
+	vector<Chunk> chunks;
+	if (file.open(fileName)) {
+		// a few chunks per worker so a slow one can be stolen from
+		size_t size = file.size();
+		size_t workers = pPool != 0 ? pPool->workerCount() : 1;
+		size_t count = max<size_t>(1, min(workers * 4, size / 65536 + 1));
+		vector<char const *> bounds(count + 1);
+		char const * pData = file.data();
+		bounds[0] = pData;
+		bounds[count] = pData + size;
+		for (size_t i = 1; i < count; i++) {
+			// move each cut to just after a line end
+			char const * pCut = max(bounds[i - 1], pData + size * i / count);
+			while (pCut != pData + size && pCut != pData && pCut[-1] != '\n')
+				pCut++;
+			bounds[i] = pCut;
+		}
+
+		chunks.resize(count);
+		function<void(int, int, int)> task = [&](int, int begin, int end) {
+			for (int i = begin; i < end; i++)
+				parse(bounds[i], bounds[i + 1], chunks[i]);
+		};
+		if (pPool != 0)
+			pPool->parallelFor(static_cast<int>(count), 1, task);
+		else
+			task(0, 0, static_cast<int>(count));
+	}
+	else {
+		// an empty file can't be mapped but is still an empty list
+		ifstream empty(fileName.c_str());
+		if (!empty || empty.peek() != ifstream::traits_type::eof())
+			return false;
+	}
+
+	size_t nodeCount = positions.size();
+	for (size_t i = 0; i < chunks.size(); i++) {
+		if (!chunks[i].valid || chunks[i].maxNode >= maxNodes)
+			return false;
+		if (chunks[i].maxNode >= 0)
+			nodeCount = max(nodeCount, static_cast<size_t>(chunks[i].maxNode) + 1);
+	}
+	int nodes = static_cast<int>(nodeCount);
+
+	// count the arcs leaving each node, then place each in its slot
+	vector<int> offsets(nodes + 1, 0);
+	for (size_t i = 0; i < chunks.size(); i++) {
+		for (size_t arc = 0; arc < chunks[i].froms.size(); arc++)
+			offsets[chunks[i].froms[arc] + 1]++;
+	}
+	for (int node = 0; node < nodes; node++)
+		offsets[node + 1] += offsets[node];
+	vector<int> targets(offsets[nodes]);
+	vector<ArcType> weights(offsets[nodes]);
+	vector<int> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < chunks.size(); i++) {
+		Chunk & chunk = chunks[i];
+		for (size_t arc = 0; arc < chunk.froms.size(); arc++) {
+			int slot = fill[chunk.froms[arc]]++;
+			targets[slot] = chunk.tos[arc];
+			weights[slot] = chunk.weights[arc];
+		}
+		// the chunk is no longer needed, give its memory back
+		chunk = Chunk();
+	}
+
+	// keep the first of any repeated arc, in file order
+	vector<int> seenBy(nodes, -1);
+	int kept = 0;
+	int begin = 0;
+	for (int node = 0; node < nodes; node++) {
+		int end = offsets[node + 1];
+		offsets[node] = kept;
+		for (int arc = begin; arc < end; arc++) {
+			if (seenBy[targets[arc]] != node) {
+				seenBy[targets[arc]] = node;
+				targets[kept] = targets[arc];
+				weights[kept] = weights[arc];
+				kept++;
+			}
+		}
+		begin = end;
+	}
+	offsets[nodes] = kept;
+	targets.resize(kept);
+	weights.resize(kept);
+
+	positions.resize(nodes);
+	graph = CompactGraph<NodeType, ArcType>(positions, offsets, targets, weights);
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           parse
+//  Description:    Parses the arcs of one chunk a line at a time.
+//                  Only spaces and tabs may come between the three
+//                  numbers, and the weight must be followed by the
+//                  line end or the end of the chunk. Lines that are
+//                  blank are skipped.
+//  Arguments:      The start and end of the chunk and the chunk to
+//                  fill in, which is marked invalid if any line is
+//                  not three numbers or names a node index that is
+//                  negative or too large to count up to.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class ArcType>
+void EdgeList<ArcType>::parse( char const * pBegin, char const * pEnd, Chunk& chunk ) {
+	chunk.maxNode = -1;
+	chunk.valid = false;
+	// a guess at the line length saves most of the regrowth
+	size_t guess = static_cast<size_t>(pEnd - pBegin) / 12;
+	chunk.froms.reserve(guess);
+	chunk.tos.reserve(guess);
+	chunk.weights.reserve(guess);
+
+	char const * p = pBegin;
+	while (p != pEnd) {
+		p = skipBlanks(p, pEnd);
+		if (p != pEnd && (*p == '\r' || *p == '\n')) {
+			p++;
+			continue;
+		}
+		if (p == pEnd)
+			break;
+
+		int from, to;
+		ArcType weight;
+		from_chars_result result = from_chars(p, pEnd, from);
+		if (result.ec != errc())
+			return;
+		result = from_chars(skipBlanks(result.ptr, pEnd), pEnd, to);
+		if (result.ec != errc())
+			return;
+		result = from_chars(skipBlanks(result.ptr, pEnd), pEnd, weight);
+		if (result.ec != errc())
+			return;
+		p = skipBlanks(result.ptr, pEnd);
+		// node counts are ints, so the largest index is one below the largest int
+		if (!lineEnd(p, pEnd) || from < 0 || to < 0
+			|| from == numeric_limits<int>::max() || to == numeric_limits<int>::max())
+			return;
+		chunk.froms.push_back(from);
+		chunk.tos.push_back(to);
+		chunk.weights.push_back(weight);
+		chunk.maxNode = max(chunk.maxNode, max(from, to));
+	}
+	chunk.valid = true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           skipBlanks
+//  Description:    Skips spaces and tabs, but not line ends.
+//  Arguments:      The position to start from and the end.
+//  Return Value:   The first position that is not a space or tab.
+// ----------------------------------------------------------------
+template<class ArcType>
+char const * EdgeList<ArcType>::skipBlanks( char const * p, char const * pEnd ) {
+	while (p != pEnd && (*p == ' ' || *p == '\t'))
+		p++;
+	return p;
+}
+
+// ----------------------------------------------------------------
+//  Name:           lineEnd
+//  Description:    Whether a position is the end of a line, a
+//                  carriage return, a line feed or the end of the
+//                  chunk.
+//  Arguments:      The position and the end.
+//  Return Value:   True at the end of a line.
+// ----------------------------------------------------------------
+template<class ArcType>
+bool EdgeList<ArcType>::lineEnd( char const * p, char const * pEnd ) {
+	return p == pEnd || *p == '\r' || *p == '\n';
+}
+
+#endif
@@ -1,22 +1,59 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
-#include "stdafx.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <list>
+#include <memory>
+#include <memory_resource>
+#include <new>
 #include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ArcIndex.h"
+#include "BestFirstSearch.h"
+#include "Heuristics.h"
+#include "IndexedHeap.h"
+#include "NodeHandle.h"
+#include "SearchContext.h"
+#include "SearchStats.h"
+#include "SpatialIndex.h"
+#include "ThreadPool.h"
+#include "Vector2.h"
 
 using namespace std;
 
 template <class NodeType, class ArcType> class GraphArc;
 template <class NodeType, class ArcType> class GraphNode;
+template <class NodeType, class ArcType> class CompactGraph;
 
 // ----------------------------------------------------------------
 //  Name:           Graph
 //  Description:    This is the graph class, it contains all the
-//                  nodes.
+//                  nodes. The node array grows as nodes are added,
+//                  and slots freed by removed nodes are reused. The
+//                  nodes and their arcs are allocated
+//                  from a memory resource, by default the heap, or
+//                  an arena or a pool the graph owns.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
 class Graph {
+public:
+
+// ----------------------------------------------------------------
+//  Description:    Where the graph places its nodes and arcs.
+//                  HEAP allocates each one with new. ARENA places
+//                  them one after another in large blocks and
+//                  never frees them before the graph goes, which
+//                  suits graphs that are built once. POOL keeps a
+//                  free list for each size, so suits graphs that
+//                  keep changing. Both hand all their memory back
+//                  at once when the graph is destroyed.
+// ----------------------------------------------------------------
+    enum Storage { HEAP, ARENA, POOL };
+
 private:
 
     // typedef the classes to make our lives easier.
@@ -29,20 +66,133 @@ private:
     Node** m_pNodes;
 
 // ----------------------------------------------------------------
-//  Description:    The maximum number of nodes in the graph.
+//  Description:    The number of slots in the node array, the
+//                  largest node index is one less.
 // ----------------------------------------------------------------
     int m_maxNodes;
 
+// ----------------------------------------------------------------
+//  Description:    The generation of each slot, moved on each
+//                  time the slot's node is removed.
+// ----------------------------------------------------------------
+    vector<unsigned> m_slotGenerations;
+
+// ----------------------------------------------------------------
+//  Description:    Empty slots below m_usedSlots that addNode can
+//                  reuse, the slots from m_usedSlots on have never
+//                  held a node. A slot filled by index since it was
+//                  freed is skipped when it comes off the list.
+// ----------------------------------------------------------------
+    vector<int> m_freeSlots;
+    int m_usedSlots;
+
 
 // ----------------------------------------------------------------
 //  Description:    The actual number of nodes in the graph.
 // ----------------------------------------------------------------
     int m_count;
 
+// ----------------------------------------------------------------
+//  Description:    The search state used by the searches that
+//                  record their results on the nodes.
+// ----------------------------------------------------------------
+    SearchContext m_context;
+
+// ----------------------------------------------------------------
+//  Description:    Counts the changes made to the nodes and arcs,
+//                  so anything worked out from the graph can tell
+//                  when it is out of date.
+// ----------------------------------------------------------------
+    unsigned long long m_generation;
+
+// ----------------------------------------------------------------
+//  Description:    The resource the nodes and arcs are allocated
+//                  from, and the arena or pool behind it when the
+//                  graph made it for itself.
+// ----------------------------------------------------------------
+    pmr::memory_resource * m_pResource;
+    unique_ptr<pmr::memory_resource> m_pOwnedResource;
+
+// ----------------------------------------------------------------
+//  Description:    Where each arc is kept in its node's arc list,
+//                  by (from, to), when m_indexArcs is set. Finding,
+//                  adding and removing an arc then take the same
+//                  time however many arcs the node has.
+// ----------------------------------------------------------------
+    ArcIndex<typename Node::ArcList::iterator> m_arcIndex;
+    bool m_indexArcs;
+
+// ----------------------------------------------------------------
+//  Description:    Where each node is, when m_indexPositions is
+//                  set, so nodes can be found by position without
+//                  looking at every one.
+// ----------------------------------------------------------------
+    SpatialIndex m_positions;
+    bool m_indexPositions;
+
 
 public:           
+// ----------------------------------------------------------------
+//  Description:    Steps through the nodes in index order,
+//                  skipping empty slots.
+// ----------------------------------------------------------------
+    class NodeIterator {
+    private:
+        Node* const * m_pNode;
+        Node* const * m_pEnd;
+
+    public:
+        NodeIterator( Node* const * pNode, Node* const * pEnd ) : m_pNode( pNode ), m_pEnd( pEnd ) {
+            skip();
+        }
+
+        Node* operator*() const {
+            return *m_pNode;
+        }
+
+        NodeIterator & operator++() {
+            ++m_pNode;
+            skip();
+            return *this;
+        }
+
+        bool operator!=( NodeIterator const & other ) const {
+            return m_pNode != other.m_pNode;
+        }
+
+    private:
+        void skip() {
+            while (m_pNode != m_pEnd && *m_pNode == 0)
+                ++m_pNode;
+        }
+    };
+
+// ----------------------------------------------------------------
+//  Description:    The nodes of the graph, for a range for loop.
+//                  Adding or removing nodes while stepping through
+//                  them is not allowed.
+// ----------------------------------------------------------------
+    class NodeRange {
+    private:
+        Node* const * m_pBegin;
+        Node* const * m_pEnd;
+
+    public:
+        NodeRange( Node* const * pBegin, Node* const * pEnd ) : m_pBegin( pBegin ), m_pEnd( pEnd ) {
+        }
+
+        NodeIterator begin() const {
+            return NodeIterator( m_pBegin, m_pEnd );
+        }
+
+        NodeIterator end() const {
+            return NodeIterator( m_pEnd, m_pEnd );
+        }
+    };
+
     // Constructor and destructor functions
-    Graph( int size );
+    Graph( int size = 0, Storage storage = HEAP );
+    Graph( int size, pmr::memory_resource * pResource );
     ~Graph();
 
     // Accessors
@@ -50,51 +200,233 @@ public:
        return m_pNodes;
     }
 
+    int maxNodes() const {
+       return m_maxNodes;
+    }
+
+    int nodeCount() const {
+       return m_count;
+    }
+
+    NodeRange nodes() const {
+       return NodeRange( m_pNodes, m_pNodes + m_maxNodes );
+    }
+
+    template<class Visit>
+    void visitArcs( int index, Visit visit ) const {
+       typename Node::ArcList::const_iterator iter = m_pNodes[index]->arcList().begin();
+       typename Node::ArcList::const_iterator endIter = m_pNodes[index]->arcList().end();
+       for (; iter != endIter; iter++) {
+          int target = (*iter).node()->index();
+          ArcType weight = (*iter).weight();
+          visit( &target, &weight, 1 );
+       }
+    }
+
+    bool valid( NodeHandle handle ) const {
+       return exists( handle.index ) && m_slotGenerations[handle.index] == handle.generation;
+    }
+
+    Node* node( NodeHandle handle ) const {
+       return valid( handle ) ? m_pNodes[handle.index] : 0;
+    }
+
+    NodeHandle handle( int index ) const {
+       return exists( index ) ? NodeHandle( index, m_slotGenerations[index] ) : NodeHandle();
+    }
+
+    Vector2 getPosition( int index ) const {
+       return m_pNodes[index]->getPosition();
+    }
+
+    unsigned long long generation() const {
+       return m_generation;
+    }
+
+    bool arcsIndexed() const {
+       return m_indexArcs;
+    }
+
+    bool positionsIndexed() const {
+       return m_indexPositions;
+    }
+
+    SpatialIndex const & positions() const {
+       return m_positions;
+    }
+
     // Public member functions.
-	bool addNode(NodeType data, float x, float y, sf::Font * font, int index);
+	bool addNode(NodeType data, float x, float y, int index);
+	NodeHandle addNode(NodeType data, float x, float y);
     void removeNode( int index );
+    bool removeNode( NodeHandle handle );
+    void reserve( int size );
     bool addArc( int from, int to, ArcType weight );
     void removeArc( int from, int to );
-    Arc* getArc( int from, int to );        
+    bool setWeight( int from, int to, ArcType weight );
+    Arc const * getArc( int from, int to );        
+    void indexArcs( bool index );
+    void indexPositions( bool index );
+    int nearestNode( float x, float y ) const;
+    CompactGraph<NodeType, ArcType> freeze() const;
     void clearMarks();
     void depthFirst( Node* pNode, void (*pProcess)(Node*) );
+    void depthFirst( SearchContext& context, Node* pNode, void (*pProcess)(Node*) ) const {
+        NoStats stats;
+        depthFirst( context, pNode, pProcess, stats );
+    }
+    template<class Stats>
+    void depthFirst( SearchContext& context, Node* pNode, void (*pProcess)(Node*), Stats& stats ) const;
     void breadthFirst( Node* pNode, void (*pProcess)(Node*) );
+    void breadthFirst( SearchContext& context, Node* pNode, void (*pProcess)(Node*) ) const {
+        NoStats stats;
+        breadthFirst( context, pNode, pProcess, stats );
+    }
+    template<class Stats>
+    void breadthFirst( SearchContext& context, Node* pNode, void (*pProcess)(Node*), Stats& stats ) const;
 	void breadthFirstSearch(Node* pStart, Node* pGoal, void (*pProcess)(Node*));
+	void breadthFirstSearch(SearchContext& context, Node* pStart, Node* pGoal, void (*pProcess)(Node*)) const {
+		NoStats stats;
+		breadthFirstSearch(context, pStart, pGoal, pProcess, stats);
+	}
+	template<class Stats>
+	void breadthFirstSearch(SearchContext& context, Node* pStart, Node* pGoal, void (*pProcess)(Node*), Stats& stats) const;
 	void ucs(Node* pStart, Node* pDest, void(*pVisitFunc)(Node*), std::vector<Node *>& path);
+	void ucs(SearchContext& context, Node* pStart, Node* pDest, void(*pVisitFunc)(Node*), std::vector<Node *>& path) const {
+		NoStats stats;
+		ucs(context, pStart, pDest, pVisitFunc, path, stats);
+	}
+	template<class Stats>
+	void ucs(SearchContext& context, Node* pStart, Node* pDest, void(*pVisitFunc)(Node*), std::vector<Node *>& path, Stats& stats) const {
+		NodeVisitor<Node> visitor(m_pNodes, pVisitFunc);
+		ucs(context, pStart, pDest, visitor, path, stats);
+	}
+	template<class Visitor, class Stats>
+	void ucs(SearchContext& context, Node* pStart, Node* pDest, Visitor& visitor, std::vector<Node *>& path, Stats& stats) const;
 	void aStar(Node* pStart, Node* pDest, void(*pProcess)(Node*), std::vector<Node *>& path);
-	void draw(sf::RenderWindow * window);
+	void aStar(SearchContext& context, Node* pStart, Node* pDest, void(*pProcess)(Node*), std::vector<Node *>& path) const {
+		NoStats stats;
+		aStar(context, EuclideanHeuristic<Graph>(*this), pStart, pDest, pProcess, path, stats);
+	}
+	template<class Stats>
+	void aStar(SearchContext& context, Node* pStart, Node* pDest, void(*pProcess)(Node*), std::vector<Node *>& path, Stats& stats) const {
+		aStar(context, EuclideanHeuristic<Graph>(*this), pStart, pDest, pProcess, path, stats);
+	}
+	template<class Heuristic>
+	void aStar(SearchContext& context, Heuristic const & heuristic, Node* pStart, Node* pDest, void(*pProcess)(Node*), std::vector<Node *>& path) const {
+		NoStats stats;
+		aStar(context, heuristic, pStart, pDest, pProcess, path, stats);
+	}
+	template<class Heuristic, class Stats>
+	void aStar(SearchContext& context, Heuristic const & heuristic, Node* pStart, Node* pDest, void(*pProcess)(Node*), std::vector<Node *>& path, Stats& stats) const {
+		NodeVisitor<Node> visitor(m_pNodes, pProcess);
+		aStar(context, heuristic, pStart, pDest, visitor, path, stats);
+	}
+	template<class Heuristic, class Visitor, class Stats>
+	void aStar(SearchContext& context, Heuristic const & heuristic, Node* pStart, Node* pDest, Visitor& visitor, std::vector<Node *>& path, Stats& stats) const;
+	void greedy(SearchContext& context, Node* pStart, Node* pDest, void(*pProcess)(Node*), std::vector<Node *>& path) const {
+		NoStats stats;
+		greedy(context, EuclideanHeuristic<Graph>(*this), pStart, pDest, pProcess, path, stats);
+	}
+	template<class Stats>
+	void greedy(SearchContext& context, Node* pStart, Node* pDest, void(*pProcess)(Node*), std::vector<Node *>& path, Stats& stats) const {
+		greedy(context, EuclideanHeuristic<Graph>(*this), pStart, pDest, pProcess, path, stats);
+	}
+	template<class Heuristic, class Stats>
+	void greedy(SearchContext& context, Heuristic const & heuristic, Node* pStart, Node* pDest, void(*pProcess)(Node*), std::vector<Node *>& path, Stats& stats) const {
+		NodeVisitor<Node> visitor(m_pNodes, pProcess);
+		greedy(context, heuristic, pStart, pDest, visitor, path, stats);
+	}
+	template<class Heuristic, class Visitor, class Stats>
+	void greedy(SearchContext& context, Heuristic const & heuristic, Node* pStart, Node* pDest, Visitor& visitor, std::vector<Node *>& path, Stats& stats) const;
+	void solveBatch(std::vector<std::pair<int, int> > const & queries, std::vector<float>& results) const;
+	void solveBatch(std::vector<std::pair<int, int> > const & queries, std::vector<float>& results, ThreadPool& pool) const;
+	void distanceTable(std::vector<int> const & sources, std::vector<int> const & targets, std::vector<float>& table) const;
 	Node* getNodeAtMouse(int x, int y);
 	void reset();
 
-	// functor struct for priority queue for ucs
-	struct UCSSearchCostCompare{
-	public:
-		bool operator()(Node * n1, Node * n2) {
-			return n1->getSearchDistance() > n2->getSearchDistance();
-		}
-	};
-
-	// functor struct for priority queue for A*
-	struct AStarSearchCostCompare{
-	public:
-		bool operator()(Node * n1, Node * n2) {
-			//bool ans = (n1->getHeuristic() + n1->getSearchDistance()) > (n2->getHeuristic() + n2->getSearchDistance());
-			int cost1 = n1->getCost();
-			int cost2 = n2->getCost();
-			bool ans = cost1 > cost2;
-			return ans;
-		}
-	};
+private:
+	template<class Stats>
+	void depthFirstVisit( SearchContext& context, Node* pNode, void (*pProcess)(Node*), Stats& stats, int depth ) const;
+	void buildPath(SearchContext const & context, Node* pDest, std::vector<Node *>& path) const;
+	void publish(SearchContext const & context);
+	void initialise();
+	void destroyNode(int index);
+	bool exists(int index) const {
+		return index >= 0 && index < m_maxNodes && m_pNodes[index] != 0;
+	}
 };
 
 // ----------------------------------------------------------------
 //  Name:           Graph
 //  Description:    Constructor, this constructs an empty graph
-//  Arguments:      The maximum number of nodes.
+//  Arguments:      The first parameter is the number of node slots
+//                  to start with, the graph grows past it as needed
+//                  The second parameter is where to place the
+//                  nodes and arcs.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+Graph<NodeType, ArcType>::Graph( int size, Storage storage ) : m_maxNodes( size ), m_context( size ) {
+   if (storage == ARENA) {
+      // start with room for the nodes, the blocks grow from there
+      m_pOwnedResource.reset(new pmr::monotonic_buffer_resource(max<size_t>(1024, sizeof(Node) * size)));
+   }
+   else if (storage == POOL) {
+      m_pOwnedResource.reset(new pmr::unsynchronized_pool_resource());
+   }
+   m_pResource = m_pOwnedResource ? m_pOwnedResource.get() : pmr::new_delete_resource();
+   initialise();
+}
+
+// ----------------------------------------------------------------
+//  Name:           Graph
+//  Description:    Constructor, this constructs an empty graph
+//                  that allocates from the caller's resource,
+//                  which must outlive the graph.
+//  Arguments:      The first parameter is the number of node slots
+//                  to start with
+//                  The second parameter is the memory resource.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+Graph<NodeType, ArcType>::Graph( int size, pmr::memory_resource * pResource ) : m_maxNodes( size ), m_context( size ),
+	m_pResource( pResource ) {
+   initialise();
+}
+
+// ----------------------------------------------------------------
+//  Name:           ~Graph
+//  Description:    destructor, This deletes every node
+//  Arguments:      None.
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-Graph<NodeType, ArcType>::Graph( int size ) : m_maxNodes( size ) {
+Graph<NodeType, ArcType>::~Graph() {
+   // the graph's own arena or pool frees every node and arc at once,
+   // so the nodes only need destroying one by one if they hold data
+   // that frees memory of its own
+   bool trivial = is_trivially_destructible<NodeType>::value && is_trivially_destructible<ArcType>::value;
+   if (!m_pOwnedResource || !trivial) {
+      int index;
+      for( index = 0; index < m_maxNodes; index++ ) {
+           if( m_pNodes[index] != 0 ) {
+               destroyNode(index);
+           }
+      }
+   }
+   // Delete the actual array
+   delete [] m_pNodes;
+}
+
+// ----------------------------------------------------------------
+//  Name:           initialise
+//  Description:    Sets up the empty node array.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void Graph<NodeType, ArcType>::initialise() {
    int i;
    m_pNodes = new Node * [m_maxNodes];
    // go through every index and clear it to null (0)
@@ -102,93 +434,196 @@ Graph<NodeType, ArcType>::Graph( int size ) : m_maxNodes( size ) {
         m_pNodes[i] = 0;
    }
 
+   m_slotGenerations.assign(m_maxNodes, 0);
+   m_usedSlots = 0;
+
    // set the node count to 0.
    m_count = 0;
+   m_generation = 0;
+   m_indexArcs = false;
+   m_indexPositions = false;
 }
 
 // ----------------------------------------------------------------
-//  Name:           ~Graph
-//  Description:    destructor, This deletes every node
-//  Arguments:      None.
+//  Name:           reserve
+//  Description:    Makes room for nodes up to a given index without
+//                  growing again. The node array may move, so a
+//                  pointer from nodeArray() must be fetched again,
+//                  but the nodes themselves stay where they are.
+//  Arguments:      The number of node slots wanted.
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-Graph<NodeType, ArcType>::~Graph() {
-   int index;
-   for( index = 0; index < m_maxNodes; index++ ) {
-        if( m_pNodes[index] != 0 ) {
-            delete m_pNodes[index];
-        }
+void Graph<NodeType, ArcType>::reserve( int size ) {
+   if (size > m_maxNodes) {
+      Node** pNodes = new Node * [size];
+      copy(m_pNodes, m_pNodes + m_maxNodes, pNodes);
+      fill(pNodes + m_maxNodes, pNodes + size, static_cast<Node *>(0));
+      delete [] m_pNodes;
+      m_pNodes = pNodes;
+      m_slotGenerations.resize(size, 0);
+      m_maxNodes = size;
    }
-   // Delete the actual array
-   delete m_pNodes;
+}
+
+// ----------------------------------------------------------------
+//  Name:           destroyNode
+//  Description:    Destroys a node and gives its memory back to
+//                  the resource, the arcs go with it.
+//  Arguments:      The index of the node.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void Graph<NodeType, ArcType>::destroyNode( int index ) {
+   Node * pNode = m_pNodes[index];
+   pNode->~Node();
+   m_pResource->deallocate(pNode, sizeof(Node), alignof(Node));
+   m_pNodes[index] = 0;
 }
 
 // ----------------------------------------------------------------
 //  Name:           addNode
-//  Description:    This adds a node at a given index in the graph.
+//  Description:    This adds a node at a given index in the graph,
+//                  growing the graph if the index is past the end.
 //  Arguments:      The first parameter is the data to store in the node.
-//                  The second parameter is the index to store the node.
-//  Return Value:   true if successful
+//                  The second and third parameters are the position.
+//                  The fourth parameter is the index to store the node.
+//  Return Value:   true if successful, false if the index is
+//                  negative or already holds a node.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-bool Graph<NodeType, ArcType>::addNode(NodeType data, float x, float y, sf::Font * font, int index) {
+bool Graph<NodeType, ArcType>::addNode(NodeType data, float x, float y, int index) {
+   if (index < 0) {
+      return false;
+   }
+   if (index >= m_maxNodes) {
+      // at least double, so adding nodes one by one stays linear
+      reserve(max(index + 1, 2 * m_maxNodes));
+   }
+   // slots skipped over have never held a node, they can be reused
+   for (; m_usedSlots < index; m_usedSlots++) {
+      m_freeSlots.push_back(m_usedSlots);
+   }
+   m_usedSlots = max(m_usedSlots, index + 1);
+
    bool nodeNotPresent = false;
    // find out if a node does not exist at that index.
    if ( m_pNodes[index] == 0) {
       nodeNotPresent = true;
       // create a new node, put the data in it, and unmark it.
-      m_pNodes[index] = new Node;
+      m_pNodes[index] = new (m_pResource->allocate(sizeof(Node), alignof(Node))) Node(m_pResource);
       m_pNodes[index]->setData(data);
+      m_pNodes[index]->setIndex(index);
       m_pNodes[index]->setMarked(false);
-	  m_pNodes[index]->setText(font);
 	  m_pNodes[index]->setPosition(x, y);
+      if (m_indexPositions) {
+         m_positions.insert(index, x, y);
+      }
 
       // increase the count and return success.
       m_count++;
+      m_generation++;
     }
         
     return nodeNotPresent;
 }
 
+// ----------------------------------------------------------------
+//  Name:           addNode
+//  Description:    This adds a node in the first free slot, reusing
+//                  the slot of a removed node if there is one, else
+//                  growing the graph.
+//  Arguments:      The first parameter is the data to store in the node.
+//                  The second and third parameters are the position.
+//  Return Value:   A handle to the new node.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+NodeHandle Graph<NodeType, ArcType>::addNode(NodeType data, float x, float y) {
+   int index = -1;
+   while (index == -1 && !m_freeSlots.empty()) {
+      // a slot may have been filled by index since it was freed
+      if (m_pNodes[m_freeSlots.back()] == 0) {
+         index = m_freeSlots.back();
+      }
+      m_freeSlots.pop_back();
+   }
+   if (index == -1) {
+      index = m_usedSlots;
+   }
+   addNode(data, x, y, index);
+   return handle(index);
+}
+
 // ----------------------------------------------------------------
 //  Name:           removeNode
-//  Description:    This removes a node from the graph
+//  Description:    This removes a node from the graph, along with
+//                  its arcs and the arcs pointing to it. The nodes
+//                  at the other ends are found from the node's own
+//                  arc and source lists, and each arc is taken off
+//                  the list at its other end by its stored slot, so
+//                  it costs time in proportion to the node's
+//                  in-degree plus out-degree, not the size of the
+//                  graph.
 //  Arguments:      The index of the node to return.
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
 void Graph<NodeType, ArcType>::removeNode( int index ) {
      // Only proceed if node does exist.
-     if( m_pNodes[index] != 0 ) {
-         // now find every arc that points to the node that
-         // is being removed and remove it.
-         int node;
-         Arc* arc;
-
-         // loop through every node
-         for( node = 0; node < m_maxNodes; node++ ) {
-              // if the node is valid...
-              if( m_pNodes[node] != 0 ) {
-                  // see if the node has an arc pointing to the current node.
-                  arc = m_pNodes[node]->getArc( m_pNodes[index] );
-              }
-              // if it has an arc pointing to the current node, then
-              // remove the arc.
-              if( arc != 0 ) {
-                  removeArc( node, index );
+     if( exists( index ) ) {
+         Node * pNode = m_pNodes[index];
+         // now remove every arc that points to the node that
+         // is being removed. The source list says where each
+         // one is, so none has to be searched for.
+         while( !pNode->sources().empty() ) {
+              Node * pSource = pNode->sources().back();
+              typename Node::ArcList::iterator arc = pNode->sourceArcs().back();
+              if (m_indexArcs) {
+                 m_arcIndex.erase(pSource->index(), index);
               }
+              pNode->removeSource(*arc);
+              pSource->removeArc(arc);
          }
-        
+
+        // the node's own arcs go with it
+        typename Node::ArcList::const_iterator iter = pNode->arcList().begin();
+        typename Node::ArcList::const_iterator endIter = pNode->arcList().end();
+        for (; iter != endIter; ++iter) {
+            (*iter).node()->removeSource(*iter);
+            if (m_indexArcs) {
+               m_arcIndex.erase(index, (*iter).node()->index());
+            }
+        }
 
         // now that every arc pointing to the current node has been removed,
         // the node can be deleted.
-        delete m_pNodes[index];
-        m_pNodes[index] = 0;
+        destroyNode(index);
+        if (m_indexPositions) {
+           m_positions.erase(index);
+        }
+        m_slotGenerations[index]++;
+        m_freeSlots.push_back(index);
         m_count--;
+        m_generation++;
     }
 }
 
+// ----------------------------------------------------------------
+//  Name:           removeNode
+//  Description:    This removes the node a handle names, if it has
+//                  not gone already.
+//  Arguments:      The handle of the node.
+//  Return Value:   True if the node was removed.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool Graph<NodeType, ArcType>::removeNode( NodeHandle handle ) {
+     bool present = valid( handle );
+     if (present) {
+        removeNode( handle.index );
+     }
+     return present;
+}
+
 // ----------------------------------------------------------------
 //  Name:           addArd
 //  Description:    Adds an arc from the first index to the 
@@ -202,18 +637,23 @@ template<class NodeType, class ArcType>
 bool Graph<NodeType, ArcType>::addArc( int from, int to, ArcType weight ) {
      bool proceed = true; 
      // make sure both nodes exist.
-     if( m_pNodes[from] == 0 || m_pNodes[to] == 0 ) {
+     if( !exists( from ) || !exists( to ) ) {
          proceed = false;
      }
         
      // if an arc already exists we should not proceed
-     if( m_pNodes[from]->getArc( m_pNodes[to] ) != 0 ) {
+     else if( getArc( from, to ) != 0 ) {
          proceed = false;
      }
 
      if (proceed == true) {
         // add the arc to the "from" node.
-        m_pNodes[from]->addArc( m_pNodes[to], weight );
+        typename Node::ArcList::iterator arc = m_pNodes[from]->addArc( m_pNodes[to], weight );
+        m_pNodes[to]->addSource( m_pNodes[from], arc );
+        if (m_indexArcs) {
+           m_arcIndex.insert(from, to, arc);
+        }
+        m_generation++;
      }
         
      return proceed;
@@ -221,7 +661,9 @@ bool Graph<NodeType, ArcType>::addArc( int from, int to, ArcType weight ) {
 
 // ----------------------------------------------------------------
 //  Name:           removeArc
-//  Description:    This removes the arc from the first index to the second index
+//  Description:    This removes the arc from the first index to the second index.
+//                  It takes constant time with the arc index on, and
+//                  a search of the first node's arcs with it off.
 //  Arguments:      The first parameter is the originating node index.
 //                  The second parameter is the ending node index.
 //  Return Value:   None.
@@ -231,37 +673,189 @@ void Graph<NodeType, ArcType>::removeArc( int from, int to ) {
      // Make sure that the node exists before trying to remove
      // an arc from it.
      bool nodeExists = true;
-     if( m_pNodes[from] == 0 || m_pNodes[to] == 0 ) {
+     if( !exists( from ) || !exists( to ) ) {
          nodeExists = false;
      }
 
      if (nodeExists == true) {
-        // remove the arc.
-        m_pNodes[from]->removeArc( m_pNodes[to] );
+        // find the arc, from the index or by searching the arc list.
+        typename Node::ArcList::iterator arc = m_pNodes[from]->arcEnd();
+        if (m_indexArcs) {
+           typename Node::ArcList::iterator * pArc = m_arcIndex.find(from, to);
+           if (pArc != 0) {
+              arc = *pArc;
+              m_arcIndex.erase(from, to);
+           }
+        }
+        else {
+           arc = m_pNodes[from]->findArc( m_pNodes[to] );
+        }
+
+        // the arc knows its slot in the source list, so taking it off
+        // is no search. a call that removes nothing keeps cached searches.
+        if (arc != m_pNodes[from]->arcEnd()) {
+           m_pNodes[to]->removeSource( *arc );
+           m_pNodes[from]->removeArc( arc );
+           m_generation++;
+        }
      }
 }
 
 
+// ----------------------------------------------------------------
+//  Name:           setWeight
+//  Description:    Changes the weight of the arc from the first
+//                  index to the second index. The change moves the
+//                  generation on, like adding or removing the arc,
+//                  so a QueryCache never answers from the old weight.
+//  Arguments:      The first parameter is the originating node index.
+//                  The second parameter is the ending node index.
+//                  The third parameter is the new weight.
+//  Return Value:   True if there was an arc to change.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool Graph<NodeType, ArcType>::setWeight( int from, int to, ArcType weight ) {
+     bool found = false;
+     if( exists( from ) && exists( to ) ) {
+        typename Node::ArcList::iterator arc = m_pNodes[from]->arcEnd();
+        if (m_indexArcs) {
+           typename Node::ArcList::iterator * pArc = m_arcIndex.find(from, to);
+           if (pArc != 0) {
+              arc = *pArc;
+           }
+        }
+        else {
+           arc = m_pNodes[from]->findArc( m_pNodes[to] );
+        }
+        if (arc != m_pNodes[from]->arcEnd()) {
+           (*arc).setWeight( weight );
+           m_generation++;
+           found = true;
+        }
+     }
+     return found;
+}
+
 // ----------------------------------------------------------------
 //  Name:           getArc
 //  Description:    Gets a pointer to an arc from the first index
-//                  to the second index.
+//                  to the second index. The arc can't be changed
+//                  through it, use setWeight so the change is
+//                  counted by generation.
 //  Arguments:      The first parameter is the originating node index.
 //                  The second parameter is the ending node index.
 //  Return Value:   pointer to the arc, or 0 if it doesn't exist.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
 // Dev-CPP doesn't like Arc* as the (typedef'd) return type?
-GraphArc<NodeType, ArcType>* Graph<NodeType, ArcType>::getArc( int from, int to ) {
-     Arc* pArc = 0;
+GraphArc<NodeType, ArcType> const * Graph<NodeType, ArcType>::getArc( int from, int to ) {
+     Arc const * pArc = 0;
      // make sure the to and from nodes exist
-     if( m_pNodes[from] != 0 && m_pNodes[to] != 0 ) {
-         pArc = m_pNodes[from]->getArc( m_pNodes[to] );
+     if( exists( from ) && exists( to ) ) {
+         if (m_indexArcs) {
+            typename Node::ArcList::iterator * pFound = m_arcIndex.find(from, to);
+            pArc = pFound != 0 ? &**pFound : 0;
+         }
+         else {
+            pArc = m_pNodes[from]->getArc( m_pNodes[to] );
+         }
      }
                 
      return pArc;
 }
 
+// ----------------------------------------------------------------
+//  Name:           indexArcs
+//  Description:    Turns the arc index on or off. Turning it on
+//                  indexes the arcs already in the graph, and it is
+//                  then kept up to date as arcs and nodes come and
+//                  go. It costs some memory per arc, so suits
+//                  graphs with high degree nodes or that change a
+//                  lot.
+//  Arguments:      True to index the arcs, false to drop the index.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void Graph<NodeType, ArcType>::indexArcs( bool index ) {
+     m_arcIndex.clear();
+     m_indexArcs = index;
+     if (index) {
+        for (int from = 0; from < m_maxNodes; from++) {
+            if (m_pNodes[from] != 0) {
+               typename Node::ArcList::iterator iter = m_pNodes[from]->arcBegin();
+               typename Node::ArcList::iterator endIter = m_pNodes[from]->arcEnd();
+               for (; iter != endIter; ++iter) {
+                   m_arcIndex.insert(from, (*iter).node()->index(), iter);
+               }
+            }
+        }
+     }
+}
+
+
+// ----------------------------------------------------------------
+//  Name:           freeze
+//  Description:    Builds an immutable compressed sparse row copy of
+//                  the graph for searching. Later changes to the
+//                  graph are not reflected in the copy.
+//  Arguments:      None.
+//  Return Value:   The compact graph, indexed by node index.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+CompactGraph<NodeType, ArcType> Graph<NodeType, ArcType>::freeze() const {
+     return CompactGraph<NodeType, ArcType>( m_pNodes, m_maxNodes );
+}
+
+
+// ----------------------------------------------------------------
+//  Name:           indexPositions
+//  Description:    Turns the position index on or off. Turning it
+//                  on indexes the nodes already in the graph, and
+//                  it is then kept up to date as nodes come and go.
+//                  It makes adding nodes slower, so suits graphs
+//                  that are searched by position, such as snapping
+//                  a point to the nearest node before a search.
+//  Arguments:      True to index the positions, false to drop the
+//                  index.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void Graph<NodeType, ArcType>::indexPositions( bool index ) {
+     m_positions.clear();
+     m_indexPositions = index;
+     if (index) {
+        for (Node * pNode : nodes()) {
+            m_positions.insert(pNode->index(), pNode->getPosition().x, pNode->getPosition().y);
+        }
+     }
+}
+
+// ----------------------------------------------------------------
+//  Name:           nearestNode
+//  Description:    Finds the node closest to a point, through the
+//                  position index if it is on, else by looking at
+//                  every node.
+//  Arguments:      The point.
+//  Return Value:   The index of the node, the lowest of any that
+//                  are equally close, or -1 if the graph is empty.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+int Graph<NodeType, ArcType>::nearestNode( float x, float y ) const {
+     if (m_indexPositions) {
+        return m_positions.nearest(x, y);
+     }
+     int nearest = -1;
+     float nearestDistance = numeric_limits<float>::infinity();
+     for (Node * pNode : nodes()) {
+         float dx = pNode->getPosition().x - x;
+         float dy = pNode->getPosition().y - y;
+         if (dx * dx + dy * dy < nearestDistance) {
+            nearestDistance = dx * dx + dy * dy;
+            nearest = pNode->index();
+         }
+     }
+     return nearest;
+}
 
 // ----------------------------------------------------------------
 //  Name:           clearMarks
@@ -283,26 +877,69 @@ void Graph<NodeType, ArcType>::clearMarks() {
 // ----------------------------------------------------------------
 //  Name:           depthFirst
 //  Description:    Performs a depth-first traversal on the specified 
-//                  node.
+//                  node, recording the marks on the nodes.
 //  Arguments:      The first argument is the starting node
 //                  The second argument is the processing function.
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
 void Graph<NodeType, ArcType>::depthFirst( Node* pNode, void (*pProcess)(Node*) ) {
+     depthFirst( m_context, pNode, pProcess );
+     publish( m_context );
+}
+
+// ----------------------------------------------------------------
+//  Name:           depthFirst
+//  Description:    Performs a depth-first traversal on the specified 
+//                  node.
+//  Arguments:      The first argument is the search context
+//                  The second argument is the starting node
+//                  The third argument is the processing function
+//                  The fourth argument is the stats policy, see
+//                  SearchStats.h.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Stats>
+void Graph<NodeType, ArcType>::depthFirst( SearchContext& context, Node* pNode, void (*pProcess)(Node*), Stats& stats ) const {
+     stats.start();
+     context.reset( m_maxNodes );
+     depthFirstVisit( context, pNode, pProcess, stats, 1 );
+     stats.stop();
+}
+
+// ----------------------------------------------------------------
+//  Name:           depthFirstVisit
+//  Description:    Processes a node and recurses into every linked
+//                  node that is not yet marked in the context.
+//  Arguments:      The first argument is the search context
+//                  The second argument is the current node
+//                  The third argument is the processing function
+//                  The fourth argument is the stats policy
+//                  The fifth argument is the depth of the recursion.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Stats>
+void Graph<NodeType, ArcType>::depthFirstVisit( SearchContext& context, Node* pNode, void (*pProcess)(Node*), Stats& stats, int depth ) const {
      if( pNode != 0 ) {
            // process the current node and mark it
+           stats.push( depth );
+           stats.expand();
            pProcess( pNode );
-           pNode->setMarked(true);
+           context.setMarked( pNode->index(), true );
 
            // go through each connecting node
-           list<Arc>::iterator iter = pNode->arcList().begin();
-           list<Arc>::iterator endIter = pNode->arcList().end();
+           typename Node::ArcList::const_iterator iter = pNode->arcList().begin();
+           typename Node::ArcList::const_iterator endIter = pNode->arcList().end();
         
 		   for( ; iter != endIter; ++iter) {
 			    // process the linked node if it isn't already marked.
-                if ( (*iter).node()->marked() == false ) {
-                   depthFirst( (*iter).node(), pProcess);
+                stats.scan();
+                if ( context.marked( (*iter).node()->index() ) == false ) {
+                   stats.relax();
+                   context.setPrevious( (*iter).node()->index(), pNode->index() );
+                   depthFirstVisit( context, (*iter).node(), pProcess, stats, depth + 1 );
                 }            
            }
      }
@@ -311,35 +948,62 @@ void Graph<NodeType, ArcType>::depthFirst( Node* pNode, void (*pProcess)(Node*)
 
 // ----------------------------------------------------------------
 //  Name:           breadthFirst
-//  Description:    Performs a depth-first traversal the starting node
-//                  specified as an input parameter.
+//  Description:    Performs a breadth-first traversal the starting node
+//                  specified as an input parameter, recording the
+//                  marks on the nodes.
 //  Arguments:      The first parameter is the starting node
 //                  The second parameter is the processing function.
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<class NodeType, class ArcType>
 void Graph<NodeType, ArcType>::breadthFirst( Node* pNode, void (*pProcess)(Node*) ) {
+   breadthFirst( m_context, pNode, pProcess );
+   publish( m_context );
+}
+
+// ----------------------------------------------------------------
+//  Name:           breadthFirst
+//  Description:    Performs a breadth-first traversal the starting node
+//                  specified as an input parameter.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the starting node
+//                  The third parameter is the processing function
+//                  The fourth parameter is the stats policy, see
+//                  SearchStats.h.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Stats>
+void Graph<NodeType, ArcType>::breadthFirst( SearchContext& context, Node* pNode, void (*pProcess)(Node*), Stats& stats ) const {
+   stats.start();
+   context.reset( m_maxNodes );
    if( pNode != 0 ) {
 	  queue<Node*> nodeQueue;        
 	  // place the first node on the queue, and mark it.
       nodeQueue.push( pNode );
-      pNode->setMarked(true);
+      stats.push( 1 );
+      context.setMarked( pNode->index(), true );
 
       // loop through the queue while there are nodes in it.
       while( nodeQueue.size() != 0 ) {
          // process the node at the front of the queue.
+         stats.expand();
          pProcess( nodeQueue.front() );
 
          // add all of the child nodes that have not been 
          // marked into the queue
-         list<Arc>::const_iterator iter = nodeQueue.front()->arcList().begin();
-         list<Arc>::const_iterator endIter = nodeQueue.front()->arcList().end();
+         typename Node::ArcList::const_iterator iter = nodeQueue.front()->arcList().begin();
+         typename Node::ArcList::const_iterator endIter = nodeQueue.front()->arcList().end();
          
 		 for( ; iter != endIter; iter++ ) {
-              if ( (*iter).node()->marked() == false) {
+              stats.scan();
+              if ( context.marked( (*iter).node()->index() ) == false) {
 				 // mark the node and add it to the queue.
-                 (*iter).node()->setMarked(true);
+                 stats.relax();
+                 context.setMarked( (*iter).node()->index(), true );
+                 context.setPrevious( (*iter).node()->index(), nodeQueue.front()->index() );
                  nodeQueue.push( (*iter).node() );
+                 stats.push( static_cast<int>(nodeQueue.size()) - 1 );
               }
          }
 
@@ -347,39 +1011,65 @@ void Graph<NodeType, ArcType>::breadthFirst( Node* pNode, void (*pProcess)(Node*
          nodeQueue.pop();
       }
    }  
+   stats.stop();
 }
 
 template<class NodeType, class ArcType>
 void Graph<NodeType, ArcType>::breadthFirstSearch(Node* pStart, Node* pGoal, void(*pProcess)(Node*)) {
+	breadthFirstSearch(m_context, pStart, pGoal, pProcess);
+	publish(m_context);
+}
+
+// ----------------------------------------------------------------
+//  Name:           breadthFirstSearch
+//  Description:    Performs a breadth-first search for the goal and
+//                  processes the path back to the start.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the starting node
+//                  The third parameter is the goal node
+//                  The fourth parameter is the processing function
+//                  The fifth parameter is the stats policy, see
+//                  SearchStats.h.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Stats>
+void Graph<NodeType, ArcType>::breadthFirstSearch(SearchContext& context, Node* pStart, Node* pGoal, void(*pProcess)(Node*), Stats& stats) const {
+	stats.start();
+	context.reset(m_maxNodes);
 	if (pStart != 0) {
 		queue<Node*> nodeQueue;
 		// place the first node on the queue, and mark it.
 		nodeQueue.push(pStart);
-		pStart->setMarked(true);
+		stats.push(1);
+		context.setMarked(pStart->index(), true);
 
 		bool goalReached = false;
 		// loop through the queue while there are nodes in it.
 		while (nodeQueue.size() != 0 && !goalReached) {
-			// process the node at the front of the queue.
-			//pProcess(nodeQueue.front());
-
 			// add all of the child nodes that have not been 
 			// marked into the queue
-			list<Arc>::const_iterator iter = nodeQueue.front()->arcList().begin();
-			list<Arc>::const_iterator endIter = nodeQueue.front()->arcList().end();
+			stats.expand();
+			typename Node::ArcList::const_iterator iter = nodeQueue.front()->arcList().begin();
+			typename Node::ArcList::const_iterator endIter = nodeQueue.front()->arcList().end();
 
 			for (; iter != endIter && !goalReached; iter++) {
+				stats.scan();
 				if ((*iter).node() == pGoal) {
 					goalReached = true;
-					pGoal->setPrevious(nodeQueue.front());
-					pProcess(pGoal);
-					pGoal->printPrevious(pProcess);
+					context.setPrevious(pGoal->index(), nodeQueue.front()->index());
+					// process the path back from the goal
+					for (int node = pGoal->index(); node != -1; node = context.previous(node)) {
+						pProcess(m_pNodes[node]);
+					}
 				}
-				if ((*iter).node()->marked() == false) {
+				if (context.marked((*iter).node()->index()) == false) {
 					// mark the node and add it to the queue.
-					(*iter).node()->setPrevious(nodeQueue.front());
-					(*iter).node()->setMarked(true);
+					stats.relax();
+					context.setPrevious((*iter).node()->index(), nodeQueue.front()->index());
+					context.setMarked((*iter).node()->index(), true);
 					nodeQueue.push((*iter).node());
+					stats.push(static_cast<int>(nodeQueue.size()) - 1);
 				}
 			}
 
@@ -387,214 +1077,299 @@ void Graph<NodeType, ArcType>::breadthFirstSearch(Node* pStart, Node* pGoal, voi
 			nodeQueue.pop();
 		}
 	}
+	stats.stop();
 }
 
 template<class NodeType, class ArcType>
 void Graph<NodeType, ArcType>::ucs(Node* pStart, Node* pDest, void(*pVisitFunc)(Node*), std::vector<Node *>& path){
-	if (pStart != 0) {
-		priority_queue<Node*, vector<Node *>, UCSSearchCostCompare> nodeQueue;
-
-		// set starting search distance to be 0
-		pStart->setSearchDistance(0);
-		pStart->setHeuristic(0);
-		for (int i = 0; i < m_count; i++)
-		{
-			// if not starting set to be large number
-			if (m_pNodes[i] != pStart)
-				m_pNodes[i]->setSearchDistance(numeric_limits<float>::infinity());
-			// reset all previous pointers
-			m_pNodes[i]->setPrevious(nullptr);
-			m_pNodes[i]->setMarked(false);
-		}
-
-		// add start node to top of queue and mark it
-		nodeQueue.push(pStart);
-		pStart->setMarked(true);
+	ucs(m_context, pStart, pDest, pVisitFunc, path);
+	publish(m_context);
+}
 
-		// loop through the queue while there are nodes in it.
-		while (!nodeQueue.empty()) {
-			// print visiting current top of queue
-			//pVisitFunc(nodeQueue.top());
-
-			// iterate through the children of the top of queue
-			list<Arc>::const_iterator iter = nodeQueue.top()->arcList().begin();
-			list<Arc>::const_iterator endIter = nodeQueue.top()->arcList().end();
-			for (; iter != endIter; iter++) {
-				if ((*iter).node() != nodeQueue.top()->getPrevious())
-				{
-					// if the distance of the current route is shorter than the distance of 
-					// the previous shortest route, change the distance and previous node accordingly
-					float dist = (*iter).weight() + nodeQueue.top()->getSearchDistance();
-					if (dist < (*iter).node()->getSearchDistance()){
-						(*iter).node()->setSearchDistance(dist);
-						// this is for question 1 of A* assignment
-						//(*iter).node()->setHeuristic(dist * 0.9);
-						(*iter).node()->setPrevious(nodeQueue.top());
-					}
-					// add all of the child nodes that have not been 
-					// marked into the queue
-					if (!(*iter).node()->marked()){
-						nodeQueue.push((*iter).node());
-						(*iter).node()->setMarked(true);
-					}
-				}
-			}
-			// dequeue the current node.
-			nodeQueue.pop();
-		}
+// ----------------------------------------------------------------
+//  Name:           ucs
+//  Description:    Uniform cost search from the start node that
+//                  stops once the destination is settled, or runs
+//                  to completion if the destination is null. The
+//                  path is returned from the destination back to
+//                  the start.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the starting node
+//                  The third parameter is the destination node
+//                  The fourth parameter is the visit function, or a
+//                  visitor policy called with each node's index,
+//                  see BestFirstSearch.h. NoVisitor costs nothing
+//                  where a function costs a call per node
+//                  The fifth parameter receives the path
+//                  The sixth parameter is the stats policy, see
+//                  SearchStats.h.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Visitor, class Stats>
+void Graph<NodeType, ArcType>::ucs(SearchContext& context, Node* pStart, Node* pDest, Visitor& visitor, std::vector<Node *>& path, Stats& stats) const {
+	if (pStart != 0) {
+		// a null destination is never settled, so the search covers
+		// the whole reachable graph
+		StopAtGoal termination(pDest != 0 ? pDest->index() : -1);
+		bestFirstSearch<UniformCostPriority>(*this, context, context.queue(), NoHeuristic(), visitor, termination, stats, pStart->index(), -1);
 	}
-	// add path nodes onto the reference vector: path
-	Node * currNode = pDest;
-	while (currNode != nullptr)
-	{
-		path.push_back(currNode);
-		currNode = currNode->getPrevious();
+	else {
+		stats.start();
+		context.reset(m_maxNodes);
+		stats.stop();
 	}
+	// add path nodes onto the reference vector: path
+	buildPath(context, pDest, path);
 }
 
 template<class NodeType, class ArcType>
 void Graph<NodeType, ArcType>::aStar(Node* pStart, Node* pDest, void(*pProcess)(Node*), std::vector<Node *>& path) {
+	aStar(m_context, pStart, pDest, pProcess, path);
+	publish(m_context);
+}
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    A* search with h(n) taken from a heuristic
+//                  policy, see Heuristics.h. h(n) is worked out for
+//                  a node when the search first reaches it.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the heuristic policy
+//                  The third parameter is the starting node
+//                  The fourth parameter is the destination node
+//                  The fifth parameter is the processing function,
+//                  or a visitor policy as for ucs
+//                  The sixth parameter receives the path
+//                  The seventh parameter is the stats policy, see
+//                  SearchStats.h.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Heuristic, class Visitor, class Stats>
+void Graph<NodeType, ArcType>::aStar(SearchContext& context, Heuristic const & heuristic, Node* pStart, Node* pDest, Visitor& visitor, std::vector<Node *>& path, Stats& stats) const {
 	/*Let s = the starting node, g = goal node
-	Let pq = a new priority queue
+	Let pq = a new priority queue ordered by f = g + h
 	Initialise g[s] to 0  
 	For each node v in graph G
-		Calculate h[v] // Compute estimated distance to goal for each node.
-	   Initialise g[v] to infinity // Dont yet know the distances to these nodes 
+	   Initialise g[v] to infinity // Don't yet know the distances to these nodes 
 
 	Add s to the pq
-	Mark(s)
 	While the queue is not empty AND pq.top() != g
-		For each child node c of pq.top()
-		   If (c != previous(pq.top() AND c has not been removed from the pq)
-				Let distC = h(c) + g(c) // g(c) is actual path cost to child
-			   If ( distC < f(c) )
-				  let f[c] = distC
-				  Set previous pointer of c to pq.top()
-			   End if
-  				If (notMarked(c))
-					  Add c to the pq 
-					  Mark(c)
-			   End if
-			  End if
+		Remove pq.top() and mark it
+		For each unmarked child node c of the removed node
+			Let distC = g(removed) + weight // actual path cost to child
+			If ( distC < g(c) )
+				If g(c) is infinity, calculate h[c] // only for nodes the search reaches
+				let g[c] = distC
+				Set previous pointer of c to the removed node
+				Add c to the pq, or lower its priority if it is already there
+			End if
 		End for
-	   Remove pq.top()	
 	End while
 	*/
 	if (pStart != 0) {
-		// create priority queue with ordering based on f(n) or total cost
-		priority_queue<Node*, vector<Node *>, AStarSearchCostCompare> nodeQueue;
-		vector<Node *> newNodes;
-		// ucs heuristic for part 1
-		//ucs(pDest, pStart, pProcess, path);
-
-		// set starting search distance to be 0
-		pStart->setSearchDistance(0);
-		sf::Vector2f endPos = pDest->getPosition();
-		for (int i = 0; i < m_count; i++)
-		{
-			// if not starting set to be large number
-			if (m_pNodes[i] != pStart) {
-				m_pNodes[i]->setSearchDistance(numeric_limits<float>::infinity());
-				
-			}
-			sf::Vector2f currPos = m_pNodes[i]->getPosition();
-			m_pNodes[i]->setHeuristic(sqrt((currPos.x - endPos.x) * (currPos.x - endPos.x) + (currPos.y - endPos.y) * (currPos.y - endPos.y)));
-			// reset all previous pointers
-			m_pNodes[i]->setPrevious(nullptr);
-			m_pNodes[i]->setMarked(false);
-		}
+		StopAtGoal termination(pDest->index());
+		bestFirstSearch<AStarPriority>(*this, context, context.queue(), heuristic, visitor, termination, stats, pStart->index(), pDest->index());
+	}
+	else {
+		stats.start();
+		context.reset(m_maxNodes);
+		stats.stop();
+	}
+	buildPath(context, pDest, path);
+}
 
-		bool found = false;
+// ----------------------------------------------------------------
+//  Name:           greedy
+//  Description:    Greedy best first search, which always settles
+//                  the node with the smallest h(n), taken from a
+//                  heuristic policy as for aStar. It settles far
+//                  fewer nodes than aStar but the path it finds
+//                  need not be the shortest.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the heuristic policy
+//                  The third parameter is the starting node
+//                  The fourth parameter is the destination node
+//                  The fifth parameter is the processing function,
+//                  or a visitor policy as for ucs
+//                  The sixth parameter receives the path
+//                  The seventh parameter is the stats policy, see
+//                  SearchStats.h.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+template<class Heuristic, class Visitor, class Stats>
+void Graph<NodeType, ArcType>::greedy(SearchContext& context, Heuristic const & heuristic, Node* pStart, Node* pDest, Visitor& visitor, std::vector<Node *>& path, Stats& stats) const {
+	if (pStart != 0) {
+		StopAtGoal termination(pDest->index());
+		bestFirstSearch<GreedyPriority>(*this, context, context.queue(), heuristic, visitor, termination, stats, pStart->index(), pDest->index());
+	}
+	else {
+		stats.start();
+		context.reset(m_maxNodes);
+		stats.stop();
+	}
+	buildPath(context, pDest, path);
+}
 
-		// add start node to top of queue and mark it
-		nodeQueue.push(pStart);
-		pStart->setMarked(true);
-		while (!nodeQueue.empty() && !found) {
-			Node * currNode = nodeQueue.top();
-			nodeQueue.pop();
+// ----------------------------------------------------------------
+//  Name:           solveBatch
+//  Description:    Finds the A* distance of many (start, destination)
+//                  index pairs at once, spread over a thread pool
+//                  made for the call with one worker per hardware
+//                  thread.
+//  Arguments:      The first parameter is the queries
+//                  The second parameter receives the distances.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void Graph<NodeType, ArcType>::solveBatch(std::vector<std::pair<int, int> > const & queries, std::vector<float>& results) const {
+	ThreadPool pool;
+	solveBatch(queries, results, pool);
+}
 
-			// print visiting current top of queue
-			pProcess(currNode);
-
-			// iterate through the children of the top of queue
-			list<Arc>::const_iterator iter = currNode->arcList().begin();
-			list<Arc>::const_iterator endIter = currNode->arcList().end();
-			for (; iter != endIter; iter++) {
-				if ((*iter).node() != currNode->getPrevious())
-				{
-					// if the distance of the current route is shorter than the distance of 
-					// the previous shortest route, change the distance and accordingly
-					float searchDist = (*iter).weight() + currNode->getSearchDistance();
-					float distC = (*iter).node()->getHeuristic() + searchDist;
-					float cost = (*iter).node()->getHeuristic() + (*iter).node()->getSearchDistance();
-					if (distC < cost) {						
-						(*iter).node()->setSearchDistance(searchDist);
-						(*iter).node()->setPrevious(currNode);
-						
-						if (!nodeQueue.empty() && find(const_cast<Node**>(&nodeQueue.top()), const_cast<Node**>(&nodeQueue.top()) + nodeQueue.size(), (*iter).node()) != (const_cast<Node**>(&nodeQueue.top()) + nodeQueue.size()))
-							std::make_heap(const_cast<Node**>(&nodeQueue.top()),
-							const_cast<Node**>(&nodeQueue.top()) + nodeQueue.size(),
-							AStarSearchCostCompare());
-					}
-					// add all of the child nodes that have not been 
-					// marked into the queue
-					if (!(*iter).node()->marked()){
-						newNodes.push_back((*iter).node());
-						(*iter).node()->setMarked(true);
-					}
-					if ((*iter).node() == pDest) {
-						found = true;
-					}
-				}
-			}
-			// dequeue the current node.
-			//nodeQueue.pop();
-			for (int i = 0; i < newNodes.size(); i++)
-			{
-				nodeQueue.push(newNodes[i]);
-			}
-			newNodes.clear();
+// ----------------------------------------------------------------
+//  Name:           solveBatch
+//  Description:    Finds the A* distance of many (start, destination)
+//                  index pairs at once. The queries run on a frozen
+//                  copy of the graph, and each worker of the pool
+//                  keeps its own search context and queue for all
+//                  the queries it runs. results[i] is the distance
+//                  for queries[i], or infinity if there is no path,
+//                  results is only resized if it is the wrong size.
+//  Arguments:      The first parameter is the queries
+//                  The second parameter receives the distances
+//                  The third parameter is the pool to run on.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void Graph<NodeType, ArcType>::solveBatch(std::vector<std::pair<int, int> > const & queries, std::vector<float>& results, ThreadPool& pool) const {
+	if (results.size() != queries.size())
+		results.resize(queries.size());
+
+	struct Workspace {
+		SearchContext context;
+		vector<int> path;
+	};
+
+	CompactGraph<NodeType, ArcType> compact = freeze();
+	EuclideanArrayHeuristic heuristic(compact.xs(), compact.ys());
+	vector<Workspace> workspaces(pool.workerCount());
+	// queries vary a lot in cost, small chunks let idle workers steal
+	pool.parallelFor(static_cast<int>(queries.size()), 16, [&](int worker, int begin, int end) {
+		Workspace & workspace = workspaces[worker];
+		// nothing watches the nodes, so no call is made for each one
+		NoVisitor visitor;
+		NoStats stats;
+		for (int q = begin; q < end; q++) {
+			int dest = queries[q].second;
+			compact.aStar(workspace.context, workspace.context.queue(), heuristic, queries[q].first, dest, visitor, workspace.path, stats);
+			results[q] = workspace.context.distance(dest);
 		}
-	}
-	Node * currNode = pDest;
+	});
+}
+
+// ----------------------------------------------------------------
+//  Name:           distanceTable
+//  Description:    The distance from every source index to every
+//                  target index, see CompactGraph::distanceTable.
+//                  The searches run on a frozen copy of the graph
+//                  over a pool with one worker per hardware thread.
+//  Arguments:      The first parameter is the source indices
+//                  The second parameter is the target indices
+//                  The third parameter receives the table, row i
+//                  holding the distances from sources[i].
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void Graph<NodeType, ArcType>::distanceTable(std::vector<int> const & sources, std::vector<int> const & targets, std::vector<float>& table) const {
+	ThreadPool pool;
+	freeze().distanceTable(sources, targets, table, pool);
+}
+
+// ----------------------------------------------------------------
+//  Name:           buildPath
+//  Description:    Follows the previous nodes recorded in the
+//                  context back from the destination.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the destination node
+//                  The third parameter receives the path.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void Graph<NodeType, ArcType>::buildPath(SearchContext const & context, Node* pDest, std::vector<Node *>& path) const {
 	path.clear();
-	while (currNode != nullptr)
-	{
-		path.push_back(currNode);
-		currNode = currNode->getPrevious();
+	if (pDest != 0) {
+		for (int node = pDest->index(); node != -1; node = context.previous(node)) {
+			path.push_back(m_pNodes[node]);
+		}
 	}
 }
 
+// ----------------------------------------------------------------
+//  Name:           publish
+//  Description:    Copies the state of a search onto the nodes so
+//                  that it can be displayed.
+//  Arguments:      The search context.
+//  Return Value:   None.
+// ----------------------------------------------------------------
 template<class NodeType, class ArcType>
-void Graph<NodeType, ArcType>::draw(sf::RenderWindow * window){
-	for (int i = 0; i < m_count; i++)
+void Graph<NodeType, ArcType>::publish(SearchContext const & context) {
+	for (int i = 0; i < m_maxNodes; i++)
 	{
-		m_pNodes[i]->draw(window);
+		if (m_pNodes[i] != 0) {
+			m_pNodes[i]->setSearchDistance(context.distance(i));
+			m_pNodes[i]->setHeuristic(context.heuristic(i));
+			m_pNodes[i]->setMarked(context.marked(i));
+			m_pNodes[i]->setPrevious(context.previous(i) != -1 ? m_pNodes[context.previous(i)] : nullptr);
+		}
 	}
 }
 
+// ----------------------------------------------------------------
+//  Name:           getNodeAtMouse
+//  Description:    Finds the node drawn under a point. A node is
+//                  drawn in the box from its position to its
+//                  position plus twice its radius, so with the
+//                  positions indexed only nodes positioned up to
+//                  that far before the point are looked at.
+//  Arguments:      The point.
+//  Return Value:   The node with the lowest index under the point,
+//                  or nullptr if there is none.
+// ----------------------------------------------------------------
 template<class NodeType, class ArcType>
 GraphNode<NodeType, ArcType>* Graph<NodeType, ArcType>::getNodeAtMouse(int x, int y) {
-	for (int i = 0; i < m_count; i++)
+	if (!m_indexPositions) {
+		for (Node * pNode : nodes())
+		{
+			if (pNode->intersects(x, y))
+				return pNode;
+		}
+		return nullptr;
+	}
+	vector<int> candidates;
+	m_positions.withinBox(x - 2.0f * Node::RADIUS, y - 2.0f * Node::RADIUS, static_cast<float>(x), static_cast<float>(y), candidates);
+	Node * pFound = nullptr;
+	for (int index : candidates)
 	{
-		if (m_pNodes[i]->intersects(x, y))
-			return m_pNodes[i];
+		if (m_pNodes[index]->intersects(x, y) && (pFound == nullptr || index < pFound->index()))
+			pFound = m_pNodes[index];
 	}
-	return nullptr;
+	return pFound;
 }
 
 template<class NodeType, class ArcType>
 void Graph<NodeType, ArcType>::reset(){
-	for (int i = 0; i < m_count; i++)
+	for (Node * pNode : nodes())
 	{
-		m_pNodes[i]->setColour(sf::Color::White);
-		m_pNodes[i]->setSearchDistance(numeric_limits<float>::infinity());
-		m_pNodes[i]->setHeuristic(0);
+		pNode->setSearchDistance(numeric_limits<float>::infinity());
+		pNode->setHeuristic(0);
 	}
 }
 
 #include "GraphNode.h"
 #include "GraphArc.h"
-
+#include "CompactGraph.h"
 
 #endif
@@ -23,6 +23,12 @@ private:
 // -------------------------------------------------------
     ArcType m_weight;
 
+// -------------------------------------------------------
+// Description: where the arc is in its target's source
+//              list, so it can be taken off without a search
+// -------------------------------------------------------
+    int m_sourceSlot;
+
 public:    
     
     // Accessor functions
@@ -33,6 +39,10 @@ public:
     ArcType weight() const {
         return m_weight;
     }
+
+    int sourceSlot() const {
+        return m_sourceSlot;
+    }
     
     // Manipulator functions
     void setNode(GraphNode<NodeType, ArcType>* pNode) {
@@ -42,6 +52,10 @@ public:
     void setWeight(ArcType weight) {
        m_weight = weight;
     }
+
+    void setSourceSlot(int slot) {
+       m_sourceSlot = slot;
+    }
     
 };
 
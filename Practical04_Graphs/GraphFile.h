@@ -0,0 +1,407 @@
+#ifndef GRAPHFILE_H
+#define GRAPHFILE_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "EdgeList.h"
+#include "Graph.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           GraphFileWeight
+//  Description:    The code stored in a graph file for each arc
+//                  weight type it can hold.
+// ----------------------------------------------------------------
+template<class ArcType> struct GraphFileWeight;
+
+template<> struct GraphFileWeight<int32_t> {
+    static const uint32_t CODE = 0;
+};
+
+template<> struct GraphFileWeight<float> {
+    static const uint32_t CODE = 1;
+};
+
+// ----------------------------------------------------------------
+//  Name:           GraphFile
+//  Description:    A graph stored in a binary file that is mapped
+//                  into memory and searched in place. Opening a
+//                  graph reads the offsets, targets, sources and
+//                  label offsets once to check them, but not the
+//                  positions or weights, which are only read as a
+//                  search touches their pages.
+//
+//                  The file is a header followed by these arrays,
+//                  each starting on an 8 byte boundary and in the
+//                  byte order of the machine that wrote it:
+//                      float    xs[nodes]
+//                      float    ys[nodes]
+//                      int32    offsets[nodes + 1]
+//                      int32    targets[arcs]
+//                      weight   weights[arcs]
+//                      int32    reverseOffsets[nodes + 1]
+//                      int32    reverseSources[arcs]
+//                      weight   reverseWeights[arcs]
+//                      uint32   labelOffsets[nodes + 1]
+//                      char     labels[labelBytes]
+//                  which are the arrays of a CompactGraph, and the
+//                  node labels, each ended by a 0. Version 1 files
+//                  held the positions as one array of x, y pairs
+//                  and are no longer read.
+// ----------------------------------------------------------------
+class GraphFile {
+private:
+    static const uint32_t MAGIC = 0x52474650;
+    static const uint32_t VERSION = 2;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t weightType;
+        uint32_t nodes;
+        uint32_t arcs;
+        uint32_t reserved;
+        uint64_t labelBytes;
+    };
+
+// ----------------------------------------------------------------
+//  Description:    Where each array starts, worked out from the
+//                  counts in the header.
+// ----------------------------------------------------------------
+    struct Layout {
+        size_t xs;
+        size_t ys;
+        size_t offsets;
+        size_t targets;
+        size_t weights;
+        size_t reverseOffsets;
+        size_t reverseSources;
+        size_t reverseWeights;
+        size_t labelOffsets;
+        size_t labels;
+        size_t end;
+    };
+
+    shared_ptr<MappedFile> m_pFile;
+    Header m_header;
+    Layout m_layout;
+
+public:
+    GraphFile();
+
+    bool open( string const & fileName );
+
+    int nodeCount() const {
+        return static_cast<int>(m_header.nodes);
+    }
+
+    int arcCount() const {
+        return static_cast<int>(m_header.arcs);
+    }
+
+    char const * label( int node ) const {
+        uint32_t const * pOffsets = reinterpret_cast<uint32_t const *>(m_pFile->data() + m_layout.labelOffsets);
+        return m_pFile->data() + m_layout.labels + pOffsets[node];
+    }
+
+    template<class NodeType, class ArcType>
+    bool graph( CompactGraph<NodeType, ArcType>& graph ) const;
+    template<class NodeType, class ArcType>
+    static bool write( string const & fileName, CompactGraph<NodeType, ArcType> const & graph, vector<string> const & labels );
+    template<class ArcType>
+    static bool convert( string const & nodesFileName, string const & arcsFileName, string const & fileName, ThreadPool * pPool = 0 );
+
+private:
+    static Layout layout( Header const & header, size_t weightSize );
+    static bool validOffsets( int32_t const * pOffsets, uint32_t nodes, uint32_t arcs );
+    static bool validNodes( int32_t const * pNodes, uint32_t arcs, uint32_t nodes );
+    static void writeArray( ofstream& file, void const * pData, size_t bytes );
+};
+
+// ----------------------------------------------------------------
+//  Name:           GraphFile
+//  Description:    Constructor, this makes an empty graph file.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline GraphFile::GraphFile() {
+	memset(&m_header, 0, sizeof(m_header));
+	m_layout = layout(m_header, 4);
+}
+
+// ----------------------------------------------------------------
+//  Name:           layout
+//  Description:    Works out where each array starts.
+//  Arguments:      The header and the size of a weight.
+//  Return Value:   The layout.
+// ----------------------------------------------------------------
+inline GraphFile::Layout GraphFile::layout( Header const & header, size_t weightSize ) {
+	size_t nodes = header.nodes;
+	size_t arcs = header.arcs;
+	Layout l;
+	size_t at = sizeof(Header);
+	size_t sizes[10] = { sizeof(float) * nodes, sizeof(float) * nodes, sizeof(int32_t) * (nodes + 1), sizeof(int32_t) * arcs, weightSize * arcs,
+	                     sizeof(int32_t) * (nodes + 1), sizeof(int32_t) * arcs, weightSize * arcs,
+	                     sizeof(uint32_t) * (nodes + 1), static_cast<size_t>(header.labelBytes) };
+	size_t * pStarts[10] = { &l.xs, &l.ys, &l.offsets, &l.targets, &l.weights, &l.reverseOffsets,
+	                         &l.reverseSources, &l.reverseWeights, &l.labelOffsets, &l.labels };
+	for (int i = 0; i < 10; i++) {
+		at = (at + 7) / 8 * 8;
+		*pStarts[i] = at;
+		at += sizes[i];
+	}
+	l.end = at;
+	return l;
+}
+
+// ----------------------------------------------------------------
+//  Name:           open
+//  Description:    Maps a graph file and checks its header, that it
+//                  is long enough to hold the arrays, and everything
+//                  a search or label would follow out of them: the
+//                  offsets must rise from 0 to the number of arcs,
+//                  every target and source must be a node, and every
+//                  label must start and end within the label bytes.
+//                  The positions and weights are not checked.
+//  Arguments:      The file name.
+//  Return Value:   True if the file was opened.
+// ----------------------------------------------------------------
+inline bool GraphFile::open( string const & fileName ) {
+	*this = GraphFile();
+	shared_ptr<MappedFile> pFile(new MappedFile());
+	if (!pFile->open(fileName) || pFile->size() < sizeof(Header))
+		return false;
+
+	Header header;
+	memcpy(&header, pFile->data(), sizeof(header));
+	if (header.magic != MAGIC || header.version != VERSION || header.weightType > 1
+		|| header.nodes > 0x7fffffff || header.arcs > 0x7fffffff || header.labelBytes > pFile->size())
+		return false;
+	Layout l = layout(header, 4);
+	if (l.end > pFile->size())
+		return false;
+
+	char const * pData = pFile->data();
+	if (!validOffsets(reinterpret_cast<int32_t const *>(pData + l.offsets), header.nodes, header.arcs)
+		|| !validOffsets(reinterpret_cast<int32_t const *>(pData + l.reverseOffsets), header.nodes, header.arcs)
+		|| !validNodes(reinterpret_cast<int32_t const *>(pData + l.targets), header.arcs, header.nodes)
+		|| !validNodes(reinterpret_cast<int32_t const *>(pData + l.reverseSources), header.arcs, header.nodes))
+		return false;
+
+	// each label runs to a 0, so the last byte must be one
+	uint32_t const * pLabelOffsets = reinterpret_cast<uint32_t const *>(pData + l.labelOffsets);
+	if (header.nodes > 0 && (header.labelBytes == 0 || pData[l.labels + header.labelBytes - 1] != '\0'))
+		return false;
+	for (uint32_t node = 0; node < header.nodes; node++) {
+		if (pLabelOffsets[node] >= header.labelBytes)
+			return false;
+	}
+
+	m_pFile = pFile;
+	m_header = header;
+	m_layout = l;
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           validOffsets
+//  Description:    Whether an offsets array starts at 0, never
+//                  falls, and ends at the number of arcs, so every
+//                  node's arcs lie within the arc arrays.
+//  Arguments:      The first parameter is the offsets array
+//                  The second parameter is the number of nodes
+//                  The third parameter is the number of arcs.
+//  Return Value:   True if the offsets are valid.
+// ----------------------------------------------------------------
+inline bool GraphFile::validOffsets( int32_t const * pOffsets, uint32_t nodes, uint32_t arcs ) {
+	if (pOffsets[0] != 0 || pOffsets[nodes] != static_cast<int32_t>(arcs))
+		return false;
+	for (uint32_t node = 0; node < nodes; node++) {
+		if (pOffsets[node + 1] < pOffsets[node])
+			return false;
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           validNodes
+//  Description:    Whether every entry of an array of arc targets or
+//                  sources is a node index.
+//  Arguments:      The first parameter is the array
+//                  The second parameter is the number of arcs
+//                  The third parameter is the number of nodes.
+//  Return Value:   True if every entry is a node.
+// ----------------------------------------------------------------
+inline bool GraphFile::validNodes( int32_t const * pNodes, uint32_t arcs, uint32_t nodes ) {
+	for (uint32_t arc = 0; arc < arcs; arc++) {
+		if (pNodes[arc] < 0 || static_cast<uint32_t>(pNodes[arc]) >= nodes)
+			return false;
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           graph
+//  Description:    Makes a compact graph that searches the mapped
+//                  arrays in place. The graph keeps the file mapped
+//                  after this GraphFile is gone.
+//  Arguments:      The graph to set.
+//  Return Value:   True if the graph was set, false if no file is
+//                  open or its weights are not the graph's arc type.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool GraphFile::graph( CompactGraph<NodeType, ArcType>& graph ) const {
+	if (m_pFile == 0 || m_header.weightType != GraphFileWeight<ArcType>::CODE)
+		return false;
+	char const * pData = m_pFile->data();
+	typename CompactGraph<NodeType, ArcType>::Arrays arrays;
+	arrays.nodes = nodeCount();
+	arrays.arcs = arcCount();
+	arrays.pXs = reinterpret_cast<float const *>(pData + m_layout.xs);
+	arrays.pYs = reinterpret_cast<float const *>(pData + m_layout.ys);
+	arrays.pOffsets = reinterpret_cast<int const *>(pData + m_layout.offsets);
+	arrays.pTargets = reinterpret_cast<int const *>(pData + m_layout.targets);
+	arrays.pWeights = reinterpret_cast<ArcType const *>(pData + m_layout.weights);
+	arrays.pReverseOffsets = reinterpret_cast<int const *>(pData + m_layout.reverseOffsets);
+	arrays.pReverseSources = reinterpret_cast<int const *>(pData + m_layout.reverseSources);
+	arrays.pReverseWeights = reinterpret_cast<ArcType const *>(pData + m_layout.reverseWeights);
+	graph = CompactGraph<NodeType, ArcType>(arrays, m_pFile);
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           writeArray
+//  Description:    Pads the file to the next 8 byte boundary and
+//                  writes an array.
+//  Arguments:      The file, the array and its size in bytes.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void GraphFile::writeArray( ofstream& file, void const * pData, size_t bytes ) {
+	static const char padding[8] = { 0 };
+	size_t at = static_cast<size_t>(file.tellp());
+	file.write(padding, (8 - at % 8) % 8);
+	file.write(static_cast<char const *>(pData), bytes);
+}
+
+// ----------------------------------------------------------------
+//  Name:           write
+//  Description:    Writes a compact graph and its node labels to a
+//                  graph file.
+//  Arguments:      The first parameter is the file name
+//                  The second parameter is the graph
+//                  The third parameter is the label of each node,
+//                  or empty to leave them all blank.
+//  Return Value:   True if the file was written.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+bool GraphFile::write( string const & fileName, CompactGraph<NodeType, ArcType> const & graph, vector<string> const & labels ) {
+	int nodes = graph.nodeCount();
+	int arcs = graph.arcCount();
+	if (!labels.empty() && static_cast<int>(labels.size()) != nodes)
+		return false;
+
+	vector<uint32_t> labelOffsets(nodes + 1, 0);
+	string labelBytes;
+	for (int node = 0; node < nodes; node++) {
+		labelOffsets[node] = static_cast<uint32_t>(labelBytes.size());
+		if (!labels.empty())
+			labelBytes += labels[node];
+		labelBytes += '\0';
+	}
+	labelOffsets[nodes] = static_cast<uint32_t>(labelBytes.size());
+
+	// the accessors give the arrays back an element at a time
+	vector<float> xs(nodes);
+	vector<float> ys(nodes);
+	vector<int32_t> offsets(nodes + 1);
+	vector<int32_t> reverseOffsets(nodes + 1);
+	vector<int32_t> targets(arcs);
+	vector<int32_t> reverseSources(arcs);
+	vector<ArcType> weights(arcs);
+	vector<ArcType> reverseWeights(arcs);
+	for (int node = 0; node < nodes; node++) {
+		xs[node] = graph.getPosition(node).x;
+		ys[node] = graph.getPosition(node).y;
+		offsets[node] = graph.arcBegin(node);
+		reverseOffsets[node] = graph.reverseArcBegin(node);
+	}
+	offsets[nodes] = arcs;
+	reverseOffsets[nodes] = arcs;
+	for (int arc = 0; arc < arcs; arc++) {
+		targets[arc] = graph.target(arc);
+		weights[arc] = graph.weight(arc);
+		reverseSources[arc] = graph.reverseSource(arc);
+		reverseWeights[arc] = graph.reverseWeight(arc);
+	}
+
+	ofstream file(fileName.c_str(), ios::binary);
+	if (!file)
+		return false;
+	Header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.weightType = GraphFileWeight<ArcType>::CODE;
+	header.nodes = static_cast<uint32_t>(nodes);
+	header.arcs = static_cast<uint32_t>(arcs);
+	header.labelBytes = labelBytes.size();
+	file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+	writeArray(file, xs.data(), sizeof(float) * xs.size());
+	writeArray(file, ys.data(), sizeof(float) * ys.size());
+	writeArray(file, offsets.data(), sizeof(int32_t) * offsets.size());
+	writeArray(file, targets.data(), sizeof(int32_t) * targets.size());
+	writeArray(file, weights.data(), sizeof(ArcType) * weights.size());
+	writeArray(file, reverseOffsets.data(), sizeof(int32_t) * reverseOffsets.size());
+	writeArray(file, reverseSources.data(), sizeof(int32_t) * reverseSources.size());
+	writeArray(file, reverseWeights.data(), sizeof(ArcType) * reverseWeights.size());
+	writeArray(file, labelOffsets.data(), sizeof(uint32_t) * labelOffsets.size());
+	writeArray(file, labelBytes.data(), labelBytes.size());
+	return static_cast<bool>(file);
+}
+
+// ----------------------------------------------------------------
+//  Name:           convert
+//  Description:    Converts a graph in the text format read by the
+//                  viewer, a "label x y" line per node and a "from
+//                  to weight" line per arc, to a graph file. The
+//                  arcs are read with EdgeList, so a repeated arc
+//                  is dropped as addArc would.
+//  Arguments:      The first parameter is the nodes file name
+//                  The second parameter is the arcs file name
+//                  The third parameter is the graph file name
+//                  The fourth parameter is a pool to read the arcs
+//                  on, or 0 to use this thread.
+//  Return Value:   True if the file was written, false if either
+//                  text file can't be read or an arc refers to a
+//                  node that is not there.
+// ----------------------------------------------------------------
+template<class ArcType>
+bool GraphFile::convert( string const & nodesFileName, string const & arcsFileName, string const & fileName, ThreadPool * pPool ) {
+	ifstream nodesFile(nodesFileName.c_str());
+	if (!nodesFile)
+		return false;
+
+	vector<string> labels;
+	vector<Vector2> positions;
+	string label;
+	float x, y;
+	while (nodesFile >> label >> x >> y) {
+		labels.push_back(label);
+		positions.push_back(Vector2(x, y));
+	}
+
+	CompactGraph<string, ArcType> graph;
+	// an arc naming a node past the last label is rejected before any node arrays are made
+	if (!EdgeList<ArcType>::import(arcsFileName, positions, graph, pPool, static_cast<int>(labels.size()))
+		|| graph.nodeCount() != static_cast<int>(labels.size()))
+		return false;
+	return write(fileName, graph, labels);
+}
+
+#endif
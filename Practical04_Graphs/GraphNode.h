@@ -1,17 +1,25 @@
 #ifndef GRAPHNODE_H
 #define GRAPHNODE_H
 
-#include "stdafx.h"
+#include <limits>
 #include <list>
+#include <memory_resource>
+#include <vector>
+#include "Vector2.h"
+
+using namespace std;
 
 // Forward references
 template <typename NodeType, typename ArcType> class GraphArc;
+template <class NodeType, class ArcType> class Graph;
 
 // -------------------------------------------------------
 // Name:        GraphNode
 // Description: This is the node class. The node class 
 //              contains data, and has a linked list of 
-//              arcs.
+//              arcs. It also knows which nodes have an arc
+//              to it. The arcs are allocated from the
+//              memory resource the node is made with.
 // -------------------------------------------------------
 template<class NodeType, class ArcType>
 class GraphNode {
@@ -19,15 +27,27 @@ private:
 // typedef the classes to make our lives easier.
     typedef GraphArc<NodeType, ArcType> Arc;
     typedef GraphNode<NodeType, ArcType> Node;
+
+public:
+    typedef pmr::list<Arc> ArcList;
+    typedef pmr::vector<Node*> SourceList;
+    typedef pmr::vector<typename ArcList::iterator> SourceArcList;
+
+private:
 // -------------------------------------------------------
 // Description: data inside the node
 // -------------------------------------------------------
     NodeType m_data;
 
+// -------------------------------------------------------
+// Description: index of the node in the graph's node array
+// -------------------------------------------------------
+	int m_index;
+
 // -------------------------------------------------------
 // Description: physical position of the node
 // -------------------------------------------------------
-	sf::Vector2f m_pos;
+	Vector2 m_pos;
 
 // -------------------------------------------------------
 // Description: current distance from search node (g(n))
@@ -42,7 +62,19 @@ private:
 // -------------------------------------------------------
 // Description: list of arcs that the node has.
 // -------------------------------------------------------
-    list<Arc> m_arcList;
+    ArcList m_arcList;
+
+// -------------------------------------------------------
+// Description: the nodes with an arc to this node, once
+//              for each arc, in no particular order.
+// -------------------------------------------------------
+    SourceList m_sources;
+
+// -------------------------------------------------------
+// Description: each of those arcs' place in its source's
+//              arc list, in the same order as m_sources.
+// -------------------------------------------------------
+    SourceArcList m_sourceArcs;
 
 // -------------------------------------------------------
 // Description: This remembers if the node is marked.
@@ -54,12 +86,19 @@ private:
 // -------------------------------------------------------
 	Node* m_prevNode;
 
-	vector<sf::Text> m_text;
-	sf::CircleShape m_shape;
-
 public:
+// -------------------------------------------------------
+// Description: radius of the node when it is displayed
+// -------------------------------------------------------
+	static const int RADIUS = 30;
+
+	GraphNode( pmr::memory_resource * pResource = pmr::get_default_resource() ) : m_index( -1 ),
+		m_searchDistance( numeric_limits<float>::infinity() ), m_heuristic( 0 ), m_arcList( pResource ), m_sources( pResource ), m_sourceArcs( pResource ),
+		m_marked( false ), m_prevNode( 0 ) {
+	}
+
     // Accessor functions
-    list<Arc> const & arcList() const {
+    ArcList const & arcList() const {
         return m_arcList;              
     }
 
@@ -71,7 +110,11 @@ public:
         return m_data;
     }
 
-	sf::Vector2f getPosition() const {
+	int index() const {
+		return m_index;
+	}
+
+	Vector2 getPosition() const {
 		return m_pos;
 	}
 
@@ -83,7 +126,7 @@ public:
 		return m_heuristic;
 	}
 
-	float const & getCost() const {
+	float getCost() const {
 		return m_heuristic + m_searchDistance;
 	}
 
@@ -92,32 +135,13 @@ public:
         m_data = data;
     }
 
+	void setIndex(int index) {
+		m_index = index;
+	}
+
 	void setPosition(float x, float y) {
 		m_pos.x = x;
 		m_pos.y = y;
-		m_shape = sf::CircleShape(30);
-		m_shape.setPosition(m_pos);
-		m_text[0].setPosition(m_pos + sf::Vector2f(10,0));
-		m_text[1].setPosition(m_pos + sf::Vector2f(10, 16));
-		m_text[2].setPosition(m_pos + sf::Vector2f(10, 32));
-	}
-
-	void setText(sf::Font * f) {
-		m_text = vector<sf::Text>(3);
-		m_text[0].setString(m_data);
-		m_text[0].setFont(*f);
-		m_text[0].setCharacterSize(20);
-		m_text[0].setColor(sf::Color::Black);
-
-		m_text[1].setString("g(n):0");
-		m_text[1].setFont(*f);
-		m_text[1].setCharacterSize(14);
-		m_text[1].setColor(sf::Color::Black);
-
-		m_text[2].setString("h(n):0");
-		m_text[2].setFont(*f);
-		m_text[2].setCharacterSize(14);
-		m_text[2].setColor(sf::Color::Black);
 	}
     
     void setMarked(bool mark) {
@@ -126,35 +150,54 @@ public:
 
 	void setSearchDistance(float dist) {
 		m_searchDistance = dist;
-		if (m_searchDistance != numeric_limits<float>::infinity())
-			m_text[1].setString("g(n):" + to_string(static_cast<int>(m_searchDistance)));
-		else
-			m_text[1].setString("g(n):0");
 	}
 
 	void setHeuristic(float h) {
 		m_heuristic = h;
-		m_text[2].setString("h(n):" + to_string(static_cast<int>(m_heuristic)));
 	}
 
 	void setPrevious(Node* prev) {
 		m_prevNode = prev;
 	}
 
-	void setColour(sf::Color c) {
-		m_shape.setFillColor(c);
-	}
-
 	Node* getPrevious(){
 		return m_prevNode;
 	}
 
-    Arc* getArc( Node* pNode );    
-    void addArc( Node* pNode, ArcType pWeight );
-    void removeArc( Node* pNode );
+    SourceList const & sources() const {
+        return m_sources;
+    }
+
+    SourceArcList const & sourceArcs() const {
+        return m_sourceArcs;
+    }
+
+    Arc const * getArc( Node* pNode );    
 	void printPrevious(void(*pProcess)(Node*));
-	void draw(sf::RenderWindow * window);
 	bool intersects(int x, int y);
+
+private:
+// -------------------------------------------------------
+// Description: only the graph adds, removes and reweights
+//              arcs, as it keeps the source lists and its arc
+//              index in step with the arc lists, and counts
+//              each change in its generation.
+// -------------------------------------------------------
+    friend class Graph<NodeType, ArcType>;
+
+    typename ArcList::iterator arcBegin() {
+        return m_arcList.begin();
+    }
+
+    typename ArcList::iterator arcEnd() {
+        return m_arcList.end();
+    }
+
+    typename ArcList::iterator findArc( Node* pNode );
+    typename ArcList::iterator addArc( Node* pNode, ArcType pWeight );
+    void removeArc( typename ArcList::iterator arc );
+    void addSource( Node* pNode, typename ArcList::iterator arc );
+    void removeSource( Arc const & arc );
 };
 
 // ----------------------------------------------------------------
@@ -166,11 +209,11 @@ public:
 //                  exist from this to the specified input node.
 // ----------------------------------------------------------------
 template<typename NodeType, typename ArcType>
-GraphArc<NodeType, ArcType>* GraphNode<NodeType, ArcType>::getArc( Node* pNode ) {
+GraphArc<NodeType, ArcType> const * GraphNode<NodeType, ArcType>::getArc( Node* pNode ) {
 
-     list<Arc>::iterator iter = m_arcList.begin();
-     list<Arc>::iterator endIter = m_arcList.end();
-     Arc* pArc = 0;
+     typename ArcList::iterator iter = m_arcList.begin();
+     typename ArcList::iterator endIter = m_arcList.end();
+     Arc const * pArc = 0;
      
      // find the arc that matches the node
      for( ; iter != endIter && pArc == 0; ++iter ) {         
@@ -183,6 +226,25 @@ GraphArc<NodeType, ArcType>* GraphNode<NodeType, ArcType>::getArc( Node* pNode )
      return pArc;
 }
 
+// ----------------------------------------------------------------
+//  Name:           findArc
+//  Description:    This finds the place in the arc list of the arc
+//                  from the current node to the node in the
+//                  parameter.
+//  Arguments:      The node that the arc connects to.
+//  Return Value:   The arc's place, or arcEnd() if there is no arc
+//                  to the node.
+// ----------------------------------------------------------------
+template<typename NodeType, typename ArcType>
+typename GraphNode<NodeType, ArcType>::ArcList::iterator GraphNode<NodeType, ArcType>::findArc( Node* pNode ) {
+     typename ArcList::iterator iter = m_arcList.begin();
+     typename ArcList::iterator endIter = m_arcList.end();
+     while( iter != endIter && (*iter).node() != pNode ) {
+          ++iter;
+     }
+     return iter;
+}
+
 
 // ----------------------------------------------------------------
 //  Name:           addArc
@@ -191,39 +253,64 @@ GraphArc<NodeType, ArcType>* GraphNode<NodeType, ArcType>::getArc( Node* pNode )
 //                  as the weight.
 //  Arguments:      First argument is the node to connect the arc to.
 //                  Second argument is the weight of the arc.
-//  Return Value:   None.
+//  Return Value:   The new arc's place in the arc list.
 // ----------------------------------------------------------------
 template<typename NodeType, typename ArcType>
-void GraphNode<NodeType, ArcType>::addArc( Node* pNode, ArcType weight ) {
+typename GraphNode<NodeType, ArcType>::ArcList::iterator GraphNode<NodeType, ArcType>::addArc( Node* pNode, ArcType weight ) {
    // Create a new arc.
    Arc a;
    a.setNode(pNode);
    a.setWeight(weight);   
    // Add it to the arc list.
-   m_arcList.push_back( a );
+   return m_arcList.insert( m_arcList.end(), a );
 }
 
 
 // ----------------------------------------------------------------
 //  Name:           removeArc
-//  Description:    This finds an arc from this node to input node 
-//                  and removes it.
-//  Arguments:      None.
+//  Description:    This removes an arc already found, without
+//                  searching the arc list for it.
+//  Arguments:      The arc's place in the arc list.
 //  Return Value:   None.
 // ----------------------------------------------------------------
 template<typename NodeType, typename ArcType>
-void GraphNode<NodeType, ArcType>::removeArc( Node* pNode ) {
-     list<Arc>::iterator iter = m_arcList.begin();
-     list<Arc>::iterator endIter = m_arcList.end();
+void GraphNode<NodeType, ArcType>::removeArc( typename ArcList::iterator arc ) {
+     m_arcList.erase( arc );
+}
 
-     int size = m_arcList.size();
-     // find the arc that matches the node
-     for( ; iter != endIter && m_arcList.size() == size;  
-                                                    ++iter ) {
-          if ( (*iter).node() == pNode) {
-             m_arcList.remove( (*iter) );
-          }                           
-     }
+// ----------------------------------------------------------------
+//  Name:           addSource
+//  Description:    Records that a node has an arc to this one, and
+//                  tells the arc where in the list it went.
+//  Arguments:      The first parameter is the node the arc comes from.
+//                  The second parameter is the arc's place in that
+//                  node's arc list.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<typename NodeType, typename ArcType>
+void GraphNode<NodeType, ArcType>::addSource( Node* pNode, typename ArcList::iterator arc ) {
+     (*arc).setSourceSlot( static_cast<int>( m_sources.size() ) );
+     m_sources.push_back( pNode );
+     m_sourceArcs.push_back( arc );
+}
+
+// ----------------------------------------------------------------
+//  Name:           removeSource
+//  Description:    Forgets an arc to this node. The arc knows its
+//                  slot, so there is no search: the last source is
+//                  moved into the gap and its arc told the new slot.
+//  Arguments:      The arc, which must still be in its source's
+//                  arc list.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<typename NodeType, typename ArcType>
+void GraphNode<NodeType, ArcType>::removeSource( Arc const & arc ) {
+     int slot = arc.sourceSlot();
+     m_sources[slot] = m_sources.back();
+     m_sourceArcs[slot] = m_sourceArcs.back();
+     (*m_sourceArcs[slot]).setSourceSlot( slot );
+     m_sources.pop_back();
+     m_sourceArcs.pop_back();
 }
 
 template<typename NodeType, typename ArcType>
@@ -234,18 +321,9 @@ void GraphNode<NodeType, ArcType>::printPrevious(void(*pProcess)(Node*)) {
 	}
 }
 
-template<typename NodeType, typename ArcType>
-void GraphNode<NodeType, ArcType>::draw(sf::RenderWindow * window){
-	window->draw(m_shape);
-	for (int i = 0; i < m_text.size(); i++)
-	{
-		window->draw(m_text[i]);
-	}
-}
-
 template<typename NodeType, typename ArcType>
 bool GraphNode<NodeType, ArcType>::intersects(int x, int y){
-	return x > m_pos.x && x < m_pos.x + 2 * m_shape.getRadius() && y > m_pos.y && y < m_pos.y + 2 * m_shape.getRadius();
+	return x > m_pos.x && x < m_pos.x + 2 * RADIUS && y > m_pos.y && y < m_pos.y + 2 * RADIUS;
 }
 
 #include "GraphArc.h"
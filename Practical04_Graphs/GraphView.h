@@ -0,0 +1,144 @@
+#ifndef GRAPHVIEW_H
+#define GRAPHVIEW_H
+
+#include "stdafx.h"
+#include <string>
+#include <vector>
+#include "Graph.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           GraphView
+//  Description:    Draws the nodes of a graph with SFML, showing
+//                  the g(n) and h(n) recorded by the last search.
+//                  The graph itself knows nothing about drawing.
+//                  Only the nodes the graph had when the view was
+//                  made are drawn.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class GraphView {
+private:
+
+    // typedef the classes to make our lives easier.
+    typedef GraphNode<NodeType, ArcType> Node;
+
+// ----------------------------------------------------------------
+//  Description:    The graph being drawn.
+// ----------------------------------------------------------------
+    Graph<NodeType, ArcType> const & m_graph;
+
+// ----------------------------------------------------------------
+//  Description:    The circle drawn for each node.
+// ----------------------------------------------------------------
+    vector<sf::CircleShape> m_shapes;
+
+// ----------------------------------------------------------------
+//  Description:    The name, g(n) and h(n) labels for each node.
+// ----------------------------------------------------------------
+    vector<vector<sf::Text> > m_text;
+
+// ----------------------------------------------------------------
+//  Description:    The g(n) and h(n) currently shown, so labels
+//                  are only rebuilt when they change.
+// ----------------------------------------------------------------
+    vector<float> m_shownDistance;
+    vector<float> m_shownHeuristic;
+
+public:
+    GraphView( Graph<NodeType, ArcType> const & graph, sf::Font * font );
+
+    void setColour( Node* pNode, sf::Color c ) {
+        m_shapes[pNode->index()].setFillColor( c );
+    }
+
+    void reset();
+    void draw( sf::RenderWindow * window );
+};
+
+// ----------------------------------------------------------------
+//  Name:           GraphView
+//  Description:    Constructor, this creates the shape and labels
+//                  for every node currently in the graph.
+//  Arguments:      The first parameter is the graph to draw.
+//                  The second parameter is the font for labels.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+GraphView<NodeType, ArcType>::GraphView( Graph<NodeType, ArcType> const & graph, sf::Font * font )
+	: m_graph( graph ), m_shapes( graph.maxNodes() ), m_text( graph.maxNodes() ),
+	  m_shownDistance( graph.maxNodes(), 0.0f ), m_shownHeuristic( graph.maxNodes(), 0.0f ) {
+	for (int i = 0; i < graph.maxNodes(); i++)
+	{
+		Node * pNode = graph.nodeArray()[i];
+		if (pNode != 0) {
+			sf::Vector2f pos(pNode->getPosition().x, pNode->getPosition().y);
+			m_shapes[i] = sf::CircleShape(Node::RADIUS);
+			m_shapes[i].setPosition(pos);
+
+			m_text[i] = vector<sf::Text>(3);
+			m_text[i][0].setString(pNode->data());
+			m_text[i][0].setCharacterSize(20);
+			m_text[i][1].setString("g(n):0");
+			m_text[i][1].setCharacterSize(14);
+			m_text[i][2].setString("h(n):0");
+			m_text[i][2].setCharacterSize(14);
+			for (int t = 0; t < 3; t++)
+			{
+				m_text[i][t].setFont(*font);
+				m_text[i][t].setColor(sf::Color::Black);
+				m_text[i][t].setPosition(pos + sf::Vector2f(10, 16.0f * t));
+			}
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           reset
+//  Description:    Sets every node back to white.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::reset() {
+	for (int i = 0; i < static_cast<int>(m_shapes.size()); i++)
+	{
+		m_shapes[i].setFillColor(sf::Color::White);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           draw
+//  Description:    Draws every node, rebuilding the g(n) and h(n)
+//                  labels of the nodes whose values have changed.
+//  Arguments:      The window to draw to.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void GraphView<NodeType, ArcType>::draw( sf::RenderWindow * window ) {
+	for (int i = 0; i < static_cast<int>(m_shapes.size()); i++)
+	{
+		Node * pNode = m_graph.nodeArray()[i];
+		if (pNode != 0 && !m_text[i].empty()) {
+			if (pNode->getSearchDistance() != m_shownDistance[i]) {
+				m_shownDistance[i] = pNode->getSearchDistance();
+				if (m_shownDistance[i] != numeric_limits<float>::infinity())
+					m_text[i][1].setString("g(n):" + to_string(static_cast<int>(m_shownDistance[i])));
+				else
+					m_text[i][1].setString("g(n):0");
+			}
+			if (pNode->getHeuristic() != m_shownHeuristic[i]) {
+				m_shownHeuristic[i] = pNode->getHeuristic();
+				m_text[i][2].setString("h(n):" + to_string(static_cast<int>(m_shownHeuristic[i])));
+			}
+
+			window->draw(m_shapes[i]);
+			for (int t = 0; t < m_text[i].size(); t++)
+			{
+				window->draw(m_text[i][t]);
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,475 @@
+#ifndef GRIDGRAPH_H
+#define GRIDGRAPH_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+#include "SearchContext.h"
+#include "Vector2.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           GridGraph
+//  Description:    An 8-connected grid of cells, each open or
+//                  blocked, held as one bit per cell. A cell's
+//                  neighbours are worked out from the bits rather
+//                  than stored, so there are no node or arc objects.
+//                  Node indices run along the rows, y * width + x,
+//                  and a node's position is its cell. Straight moves
+//                  cost 1 and diagonal moves the square root of 2. A
+//                  move only needs the cell moved into to be open,
+//                  so a diagonal may pass between blocked cells, as
+//                  in the benchmark's grid generator.
+//
+//                  Besides A* it offers Jump Point Search, which
+//                  only queues the cells where the best path may
+//                  turn and runs over the rest, and JPS+, which
+//                  looks those runs up in a table built beforehand.
+//                  The table costs 16 bytes a cell. Every search
+//                  fills in a SearchContext like the other graphs
+//                  and gives the full path, cell by cell, from the
+//                  destination back to the start.
+// ----------------------------------------------------------------
+class GridGraph {
+private:
+
+// ----------------------------------------------------------------
+//  Description:    The size of the grid in cells.
+// ----------------------------------------------------------------
+    int m_width;
+    int m_height;
+
+// ----------------------------------------------------------------
+//  Description:    One bit per cell in node order, set if the cell
+//                  is blocked.
+// ----------------------------------------------------------------
+    vector<uint64_t> m_blocked;
+
+// ----------------------------------------------------------------
+//  Description:    The JPS+ table, eight entries per cell, one for
+//                  each direction. A positive entry is the number
+//                  of steps to the next jump point that way, and
+//                  anything else is minus the number of open cells
+//                  before a blocked one. Empty until preprocess.
+// ----------------------------------------------------------------
+    vector<int16_t> m_jumps;
+
+// ----------------------------------------------------------------
+//  Description:    The eight directions, straight ones even and
+//                  diagonal ones odd, going round anticlockwise
+//                  from +x.
+// ----------------------------------------------------------------
+    static constexpr int DX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+    static constexpr int DY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+    static constexpr float DIAGONAL = 1.41421356f;
+
+public:
+    // Constructor functions
+    GridGraph() : m_width( 0 ), m_height( 0 ) {
+    }
+
+    GridGraph( int width, int height ) : m_width( width ), m_height( height ),
+        m_blocked( (static_cast<size_t>(width) * height + 63) / 64, 0 ) {
+    }
+
+    // Accessor functions
+    int width() const {
+        return m_width;
+    }
+
+    int height() const {
+        return m_height;
+    }
+
+    int nodeCount() const {
+        return m_width * m_height;
+    }
+
+    int index( int x, int y ) const {
+        return y * m_width + x;
+    }
+
+    Vector2 getPosition( int node ) const {
+        return Vector2( static_cast<float>(node % m_width), static_cast<float>(node / m_width) );
+    }
+
+    // cells off the grid count as blocked
+    bool blocked( int x, int y ) const {
+        if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+            return true;
+        size_t cell = static_cast<size_t>(index( x, y ));
+        return (m_blocked[cell >> 6] >> (cell & 63)) & 1;
+    }
+
+    bool preprocessed() const {
+        return !m_jumps.empty();
+    }
+
+    // the octile distance, exact on an open grid
+    float heuristic( int node, int dest ) const {
+        int dx = abs( node % m_width - dest % m_width );
+        int dy = abs( node / m_width - dest / m_width );
+        int diagonal = dx < dy ? dx : dy;
+        return static_cast<float>(dx + dy - 2 * diagonal) + DIAGONAL * diagonal;
+    }
+
+    // Manipulator functions
+    void setBlocked( int x, int y, bool isBlocked );
+
+    // Public member functions.
+    bool preprocess();
+    void aStar( SearchContext& context, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const;
+    void jps( SearchContext& context, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const;
+    void jpsPlus( SearchContext& context, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const;
+
+private:
+    static int direction( int dx, int dy );
+    bool open( int x, int y ) const {
+        return !blocked( x, y );
+    }
+    bool forced( int x, int y, int dir ) const;
+    int prune( int node, int previous ) const;
+    int jump( int node, int dir, int dest ) const;
+    int lookUp( int node, int dir, int dest ) const;
+    void jumpSearch( SearchContext& context, int start, int dest, bool useTable, void (*pProcess)(int), std::vector<int>& path ) const;
+    void buildPath( SearchContext const & context, int dest, std::vector<int>& path ) const;
+};
+
+// ----------------------------------------------------------------
+//  Name:           setBlocked
+//  Description:    Opens or blocks a cell. The JPS+ table no longer
+//                  holds, so it is dropped until preprocess is
+//                  called again.
+//  Arguments:      The first and second parameters are the cell
+//                  The third parameter is true to block it.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void GridGraph::setBlocked( int x, int y, bool isBlocked ) {
+	size_t cell = static_cast<size_t>(index(x, y));
+	if (isBlocked)
+		m_blocked[cell >> 6] |= uint64_t(1) << (cell & 63);
+	else
+		m_blocked[cell >> 6] &= ~(uint64_t(1) << (cell & 63));
+	vector<int16_t>().swap(m_jumps);
+}
+
+// ----------------------------------------------------------------
+//  Name:           preprocess
+//  Description:    Builds the JPS+ table. Each straight entry is
+//                  worked out from the next cell's, sweeping
+//                  against its direction, and the diagonal entries
+//                  then from the straight ones.
+//  Arguments:      None.
+//  Return Value:   True if the table was built, false if the grid
+//                  is too big for its entries.
+// ----------------------------------------------------------------
+inline bool GridGraph::preprocess() {
+	if (m_width > numeric_limits<int16_t>::max() || m_height > numeric_limits<int16_t>::max())
+		return false;
+	m_jumps.assign(static_cast<size_t>(nodeCount()) * 8, 0);
+	// the straight directions first, the diagonals need them
+	const int order[8] = { 0, 2, 4, 6, 1, 3, 5, 7 };
+	for (int o = 0; o < 8; o++) {
+		int dir = order[o];
+		int dx = DX[dir];
+		int dy = DY[dir];
+		for (int row = 0; row < m_height; row++) {
+			// sweep against the direction so the next cell is done
+			int y = dy > 0 ? m_height - 1 - row : row;
+			for (int column = 0; column < m_width; column++) {
+				int x = dx > 0 ? m_width - 1 - column : column;
+				int nextX = x + dx;
+				int nextY = y + dy;
+				if (blocked(x, y) || blocked(nextX, nextY))
+					continue;
+				int next = index(nextX, nextY);
+				bool stop = forced(nextX, nextY, dir);
+				if (dir % 2 == 1) {
+					stop = stop || m_jumps[next * 8 + direction(dx, 0)] > 0 || m_jumps[next * 8 + direction(0, dy)] > 0;
+				}
+				int steps = m_jumps[next * 8 + dir];
+				m_jumps[index(x, y) * 8 + dir] = static_cast<int16_t>(stop ? 1 : steps > 0 ? steps + 1 : steps - 1);
+			}
+		}
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    A* over every open neighbour of each cell, with
+//                  the octile distance for h(n).
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the starting node index
+//                  The third parameter is the destination index
+//                  The fourth parameter is called for each settled node
+//                  The fifth parameter receives the path.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void GridGraph::aStar( SearchContext& context, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const {
+	context.reset(nodeCount());
+	IndexedDaryHeap<4>& nodeQueue = context.queue();
+	if (!blocked(start % m_width, start / m_width) && !blocked(dest % m_width, dest / m_width)) {
+		context.setHeuristic(start, heuristic(start, dest));
+		context.setDistance(start, 0);
+		nodeQueue.push(start, context.cost(start));
+	}
+
+	bool found = false;
+	while (!nodeQueue.empty() && !found) {
+		// the node at the top of the queue is settled
+		int currNode = nodeQueue.pop();
+		context.setMarked(currNode, true);
+		pProcess(currNode);
+		found = (currNode == dest);
+
+		int x = currNode % m_width;
+		int y = currNode / m_width;
+		for (int dir = 0; dir < 8 && !found; dir++) {
+			if (blocked(x + DX[dir], y + DY[dir]))
+				continue;
+			int next = index(x + DX[dir], y + DY[dir]);
+			float dist = context.distance(currNode) + (dir % 2 == 1 ? DIAGONAL : 1.0f);
+			if (!context.marked(next) && dist < context.distance(next)) {
+				// h(n) is only needed once a node is reached
+				if (context.distance(next) == numeric_limits<float>::infinity())
+					context.setHeuristic(next, heuristic(next, dest));
+				context.setDistance(next, dist);
+				context.setPrevious(next, currNode);
+				nodeQueue.pushOrDecrease(next, context.cost(next));
+			}
+		}
+	}
+	buildPath(context, dest, path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           jps
+//  Description:    Jump Point Search, A* that only queues the jump
+//                  points, found by running along the grid from
+//                  each one. Only the jump points are settled and
+//                  given a distance, the path fills in the cells
+//                  between them.
+//  Arguments:      As aStar.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void GridGraph::jps( SearchContext& context, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const {
+	jumpSearch(context, start, dest, false, pProcess, path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           jpsPlus
+//  Description:    Jump Point Search with the runs looked up in
+//                  the table from preprocess rather than walked,
+//                  plain jps if there is no table.
+//  Arguments:      As aStar.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void GridGraph::jpsPlus( SearchContext& context, int start, int dest, void (*pProcess)(int), std::vector<int>& path ) const {
+	jumpSearch(context, start, dest, preprocessed(), pProcess, path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           direction
+//  Description:    The direction of a step.
+//  Arguments:      The step, each part -1, 0 or 1 and not both 0.
+//  Return Value:   The direction.
+// ----------------------------------------------------------------
+inline int GridGraph::direction( int dx, int dy ) {
+	static const int directions[9] = { 5, 6, 7, 4, -1, 0, 3, 2, 1 };
+	return directions[(dy + 1) * 3 + dx + 1];
+}
+
+// ----------------------------------------------------------------
+//  Name:           forced
+//  Description:    Whether a cell reached going one way has a
+//                  neighbour that the best path may only reach
+//                  through it, because the cell beside it that
+//                  would have been the way round is blocked.
+//  Arguments:      The cell and the direction it was reached in.
+//  Return Value:   True if it has such a forced neighbour.
+// ----------------------------------------------------------------
+inline bool GridGraph::forced( int x, int y, int dir ) const {
+	int dx = DX[dir];
+	int dy = DY[dir];
+	if (dy == 0)
+		return (blocked(x, y + 1) && open(x + dx, y + 1)) || (blocked(x, y - 1) && open(x + dx, y - 1));
+	if (dx == 0)
+		return (blocked(x + 1, y) && open(x + 1, y + dy)) || (blocked(x - 1, y) && open(x - 1, y + dy));
+	return (blocked(x - dx, y) && open(x - dx, y + dy)) || (blocked(x, y - dy) && open(x + dx, y - dy));
+}
+
+// ----------------------------------------------------------------
+//  Name:           prune
+//  Description:    The directions worth searching from a jump
+//                  point, the way it was reached in and those
+//                  beside it, plus any forced neighbours.
+//  Arguments:      The jump point and the one before it, or -1
+//                  for the start, which searches every direction.
+//  Return Value:   A bit for each direction to search.
+// ----------------------------------------------------------------
+inline int GridGraph::prune( int node, int previous ) const {
+	if (previous == -1)
+		return 0xff;
+	int x = node % m_width;
+	int y = node / m_width;
+	int px = previous % m_width;
+	int py = previous / m_width;
+	int dx = (x > px) - (x < px);
+	int dy = (y > py) - (y < py);
+	int dirs = 1 << direction(dx, dy);
+	if (dy == 0) {
+		if (blocked(x, y + 1) && open(x + dx, y + 1))
+			dirs |= 1 << direction(dx, 1);
+		if (blocked(x, y - 1) && open(x + dx, y - 1))
+			dirs |= 1 << direction(dx, -1);
+	}
+	else if (dx == 0) {
+		if (blocked(x + 1, y) && open(x + 1, y + dy))
+			dirs |= 1 << direction(1, dy);
+		if (blocked(x - 1, y) && open(x - 1, y + dy))
+			dirs |= 1 << direction(-1, dy);
+	}
+	else {
+		dirs |= (1 << direction(dx, 0)) | (1 << direction(0, dy));
+		if (blocked(x - dx, y) && open(x - dx, y + dy))
+			dirs |= 1 << direction(-dx, dy);
+		if (blocked(x, y - dy) && open(x + dx, y - dy))
+			dirs |= 1 << direction(dx, -dy);
+	}
+	return dirs;
+}
+
+// ----------------------------------------------------------------
+//  Name:           jump
+//  Description:    Runs from a cell in one direction to the next
+//                  jump point, the destination or a cell with a
+//                  forced neighbour. A diagonal run also stops
+//                  where a straight run from it would find one.
+//  Arguments:      The cell, the direction and the destination.
+//  Return Value:   The number of steps to the jump point, or 0 if
+//                  the run ends at a blocked cell.
+// ----------------------------------------------------------------
+inline int GridGraph::jump( int node, int dir, int dest ) const {
+	int x = node % m_width;
+	int y = node / m_width;
+	int dx = DX[dir];
+	int dy = DY[dir];
+	for (int steps = 1; ; steps++) {
+		x += dx;
+		y += dy;
+		if (blocked(x, y))
+			return 0;
+		int cell = index(x, y);
+		if (cell == dest || forced(x, y, dir))
+			return steps;
+		if (dir % 2 == 1 && (jump(cell, direction(dx, 0), dest) != 0 || jump(cell, direction(0, dy), dest) != 0))
+			return steps;
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           lookUp
+//  Description:    jump, from the JPS+ table. The table knows
+//                  nothing of the destination, so a run that passes
+//                  it, or on a diagonal passes its row or column,
+//                  is cut short there.
+//  Arguments:      The cell, the direction and the destination.
+//  Return Value:   The number of steps to the jump point, or 0 if
+//                  there is none.
+// ----------------------------------------------------------------
+inline int GridGraph::lookUp( int node, int dir, int dest ) const {
+	int steps = m_jumps[node * 8 + dir];
+	int reach = steps > 0 ? steps : -steps;
+	int dx = DX[dir];
+	int dy = DY[dir];
+	int toX = dest % m_width - node % m_width;
+	int toY = dest / m_width - node / m_width;
+	// steps until the destination's row or column, if it is ahead
+	int ahead = 0;
+	if (dir % 2 == 0) {
+		if (dy == 0 && toY == 0 && toX * dx > 0)
+			ahead = abs(toX);
+		else if (dx == 0 && toX == 0 && toY * dy > 0)
+			ahead = abs(toY);
+	}
+	else if (toX * dx > 0 && toY * dy > 0) {
+		ahead = abs(toX) < abs(toY) ? abs(toX) : abs(toY);
+	}
+	if (ahead != 0 && ahead <= reach)
+		return ahead;
+	return steps > 0 ? steps : 0;
+}
+
+// ----------------------------------------------------------------
+//  Name:           jumpSearch
+//  Description:    The search behind jps and jpsPlus.
+//  Arguments:      As aStar, with whether to use the JPS+ table.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void GridGraph::jumpSearch( SearchContext& context, int start, int dest, bool useTable, void (*pProcess)(int), std::vector<int>& path ) const {
+	context.reset(nodeCount());
+	IndexedDaryHeap<4>& nodeQueue = context.queue();
+	if (!blocked(start % m_width, start / m_width) && !blocked(dest % m_width, dest / m_width)) {
+		context.setHeuristic(start, heuristic(start, dest));
+		context.setDistance(start, 0);
+		nodeQueue.push(start, context.cost(start));
+	}
+
+	bool found = false;
+	while (!nodeQueue.empty() && !found) {
+		// the jump point at the top of the queue is settled
+		int currNode = nodeQueue.pop();
+		context.setMarked(currNode, true);
+		pProcess(currNode);
+		found = (currNode == dest);
+
+		int dirs = found ? 0 : prune(currNode, context.previous(currNode));
+		for (int dir = 0; dir < 8; dir++) {
+			if ((dirs & (1 << dir)) == 0)
+				continue;
+			int steps = useTable ? lookUp(currNode, dir, dest) : jump(currNode, dir, dest);
+			if (steps == 0)
+				continue;
+			int next = currNode + steps * (DY[dir] * m_width + DX[dir]);
+			float dist = context.distance(currNode) + steps * (dir % 2 == 1 ? DIAGONAL : 1.0f);
+			if (!context.marked(next) && dist < context.distance(next)) {
+				if (context.distance(next) == numeric_limits<float>::infinity())
+					context.setHeuristic(next, heuristic(next, dest));
+				context.setDistance(next, dist);
+				context.setPrevious(next, currNode);
+				nodeQueue.pushOrDecrease(next, context.cost(next));
+			}
+		}
+	}
+	buildPath(context, dest, path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           buildPath
+//  Description:    Follows the previous indices back from the
+//                  destination, filling in the straight or
+//                  diagonal line of cells between jump points.
+//  Arguments:      The first parameter is the search context
+//                  The second parameter is the destination index
+//                  The third parameter receives the path.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void GridGraph::buildPath( SearchContext const & context, int dest, std::vector<int>& path ) const {
+	path.clear();
+	path.push_back(dest);
+	for (int node = dest; context.previous(node) != -1; node = context.previous(node)) {
+		int previous = context.previous(node);
+		int dx = previous % m_width - node % m_width;
+		int dy = previous / m_width - node / m_width;
+		int step = ((dy > 0) - (dy < 0)) * m_width + (dx > 0) - (dx < 0);
+		for (int cell = node + step; cell != previous; cell += step)
+			path.push_back(cell);
+		path.push_back(previous);
+	}
+}
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef HEURISTICS_H
+#define HEURISTICS_H
+
+#include <cmath>
+#include <type_traits>
+#include "Vector2.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define HEURISTICS_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HEURISTICS_SSE2
+#endif
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  The aStar searches take their h(n) from a heuristic policy, any
+//  object that can be called as
+//
+//      float h = heuristic( node, dest );
+//
+//  with two node indices, giving a lower bound on the distance from
+//  node to dest. It must also be consistent, h(u) <= w(u,v) + h(v)
+//  for every arc, as the searches never reopen a settled node.
+//
+//  A policy may also give h for a run of nodes at once,
+//
+//      heuristic.batch( pNodes, count, dest, pOut );
+//
+//  which a search over contiguous arc targets uses, see HasBatch,
+//  to work out h for all of a node's neighbours in one go.
+// ----------------------------------------------------------------
+
+// ----------------------------------------------------------------
+//  Name:           HasBatch
+//  Description:    Whether a heuristic policy has a batch member.
+// ----------------------------------------------------------------
+template<class Heuristic, class = void>
+struct HasBatch : false_type {
+};
+
+template<class Heuristic>
+struct HasBatch<Heuristic, void_t<decltype(declval<Heuristic const &>().batch( static_cast<int const *>(0), 0, 0, static_cast<float *>(0) ))> > : true_type {
+};
+
+// ----------------------------------------------------------------
+//  Name:           euclideanDistances
+//  Description:    The straight line distance from each of a list
+//                  of nodes to a point, with the node positions
+//                  held as separate x and y arrays. The distances
+//                  are worked out eight at a time with AVX2, four
+//                  at a time with SSE2, and the rest one at a time.
+//                  The lanes are filled one by one, which is no
+//                  slower than an AVX2 gather for so few nodes.
+//                  Every path gives the same answer up to rounding:
+//                  the square roots are correctly rounded, but the
+//                  compiler may fuse the scalar loop's multiply and
+//                  add, as it can under -mavx2, which moves the
+//                  last bit.
+//  Arguments:      The first and second parameters are the x and y
+//                  of every node
+//                  The third parameter is the node indices
+//                  The fourth parameter is how many there are
+//                  The fifth and sixth parameters are the point
+//                  The seventh parameter receives the distances.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void euclideanDistances( float const * pXs, float const * pYs, int const * pNodes, int count, float x, float y, float * pOut ) {
+	int i = 0;
+#if defined(__AVX2__)
+	__m256 vx8 = _mm256_set1_ps(x);
+	__m256 vy8 = _mm256_set1_ps(y);
+	for (; i + 8 <= count; i += 8) {
+		int const * p = pNodes + i;
+		__m256 dx = _mm256_sub_ps(_mm256_setr_ps(pXs[p[0]], pXs[p[1]], pXs[p[2]], pXs[p[3]], pXs[p[4]], pXs[p[5]], pXs[p[6]], pXs[p[7]]), vx8);
+		__m256 dy = _mm256_sub_ps(_mm256_setr_ps(pYs[p[0]], pYs[p[1]], pYs[p[2]], pYs[p[3]], pYs[p[4]], pYs[p[5]], pYs[p[6]], pYs[p[7]]), vy8);
+		_mm256_storeu_ps(pOut + i, _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy))));
+	}
+#endif
+#if defined(HEURISTICS_SSE2)
+	__m128 vx = _mm_set1_ps(x);
+	__m128 vy = _mm_set1_ps(y);
+	for (; i + 4 <= count; i += 4) {
+		__m128 dx = _mm_sub_ps(_mm_setr_ps(pXs[pNodes[i]], pXs[pNodes[i + 1]], pXs[pNodes[i + 2]], pXs[pNodes[i + 3]]), vx);
+		__m128 dy = _mm_sub_ps(_mm_setr_ps(pYs[pNodes[i]], pYs[pNodes[i + 1]], pYs[pNodes[i + 2]], pYs[pNodes[i + 3]]), vy);
+		_mm_storeu_ps(pOut + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))));
+	}
+#endif
+	for (; i < count; i++) {
+		float dx = pXs[pNodes[i]] - x;
+		float dy = pYs[pNodes[i]] - y;
+		pOut[i] = sqrt(dx * dx + dy * dy);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           EuclideanHeuristic
+//  Description:    The straight line distance between the positions
+//                  of two nodes, taken from any graph with a
+//                  getPosition( index ). It is only a lower bound
+//                  when no arc is shorter than the line it spans.
+// ----------------------------------------------------------------
+template<class GraphType>
+class EuclideanHeuristic {
+private:
+    GraphType const & m_graph;
+
+public:
+    EuclideanHeuristic( GraphType const & graph ) : m_graph( graph ) {
+    }
+
+    float operator()( int node, int dest ) const {
+        Vector2 nodePos = m_graph.getPosition( node );
+        Vector2 endPos = m_graph.getPosition( dest );
+        return sqrt( (nodePos.x - endPos.x) * (nodePos.x - endPos.x) + (nodePos.y - endPos.y) * (nodePos.y - endPos.y) );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           EuclideanArrayHeuristic
+//  Description:    The straight line distance between two nodes,
+//                  read from separate x and y arrays such as a
+//                  CompactGraph's, which lets a whole run of nodes
+//                  be worked out at once with euclideanDistances.
+//                  It is a lower bound under the same condition as
+//                  EuclideanHeuristic.
+// ----------------------------------------------------------------
+class EuclideanArrayHeuristic {
+private:
+    float const * m_pXs;
+    float const * m_pYs;
+
+public:
+    EuclideanArrayHeuristic( float const * pXs, float const * pYs ) : m_pXs( pXs ), m_pYs( pYs ) {
+    }
+
+    float operator()( int node, int dest ) const {
+        float dx = m_pXs[node] - m_pXs[dest];
+        float dy = m_pYs[node] - m_pYs[dest];
+        return sqrt( dx * dx + dy * dy );
+    }
+
+    void batch( int const * pNodes, int count, int dest, float * pOut ) const {
+        euclideanDistances( m_pXs, m_pYs, pNodes, count, m_pXs[dest], m_pYs[dest], pOut );
+    }
+};
+
+#endif
@@ -0,0 +1,530 @@
+#ifndef INCREMENTALPLANNER_H
+#define INCREMENTALPLANNER_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "Graph.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           IncrementalPlanner
+//  Description:    A shortest path from a start to a goal that is
+//                  kept up to date as arcs change and the start
+//                  moves, with D* Lite. The search runs backwards
+//                  from the goal and keeps its tree between calls,
+//                  so after a change only the nodes whose distance
+//                  to the goal it affects are searched again.
+//                  The planner keeps its own copy of the arcs, the
+//                  changes are given to it as a batch, and h(n) is
+//                  the straight line distance from the start, so
+//                  it is only a lower bound when no arc is shorter
+//                  than the line it spans.
+// ----------------------------------------------------------------
+class IncrementalPlanner {
+public:
+// ----------------------------------------------------------------
+//  Description:    A new weight for the arc between two nodes. An
+//                  arc that is not there is added, and a weight of
+//                  infinity removes it.
+// ----------------------------------------------------------------
+    struct ArcChange {
+        int from;
+        int to;
+        float weight;
+    };
+
+private:
+    struct Link {
+        int node;
+        float weight;
+    };
+
+// ----------------------------------------------------------------
+//  Description:    The D* Lite priority, compared first on the
+//                  estimated path cost then on the distance.
+// ----------------------------------------------------------------
+    struct Key {
+        float first;
+        float second;
+
+        bool operator<( Key const & other ) const {
+            return first < other.first || (first == other.first && second < other.second);
+        }
+    };
+
+// ----------------------------------------------------------------
+//  Name:           Queue
+//  Description:    A 4-ary heap of node indices by Key, like the
+//                  IndexedDaryHeap, that can also raise the key of
+//                  a waiting node or take it out.
+// ----------------------------------------------------------------
+    class Queue {
+    private:
+        struct Entry {
+            Key key;
+            int item;
+        };
+        vector<Entry> m_heap;
+        vector<int> m_slot;
+
+    public:
+        void reset( int capacity ) {
+            m_heap.clear();
+            m_slot.assign( capacity, -1 );
+        }
+
+        bool empty() const {
+            return m_heap.empty();
+        }
+
+        bool contains( int item ) const {
+            return m_slot[item] != -1;
+        }
+
+        int top() const {
+            return m_heap[0].item;
+        }
+
+        Key topKey() const {
+            return m_heap[0].key;
+        }
+
+        void push( int item, Key key ) {
+            Entry entry;
+            entry.key = key;
+            entry.item = item;
+            m_heap.push_back( entry );
+            m_slot[item] = static_cast<int>(m_heap.size()) - 1;
+            siftUp( static_cast<int>(m_heap.size()) - 1 );
+        }
+
+        void update( int item, Key key ) {
+            int slot = m_slot[item];
+            m_heap[slot].key = key;
+            siftUp( slot );
+            siftDown( m_slot[item] );
+        }
+
+        void remove( int item ) {
+            int slot = m_slot[item];
+            m_slot[item] = -1;
+            Entry last = m_heap.back();
+            m_heap.pop_back();
+            if (slot < static_cast<int>(m_heap.size())) {
+                m_heap[slot] = last;
+                m_slot[last.item] = slot;
+                siftUp( slot );
+                siftDown( m_slot[last.item] );
+            }
+        }
+
+    private:
+        void siftUp( int slot ) {
+            Entry entry = m_heap[slot];
+            while (slot > 0) {
+                int parent = (slot - 1) / 4;
+                if (!(entry.key < m_heap[parent].key))
+                    break;
+                m_heap[slot] = m_heap[parent];
+                m_slot[m_heap[slot].item] = slot;
+                slot = parent;
+            }
+            m_heap[slot] = entry;
+            m_slot[entry.item] = slot;
+        }
+
+        void siftDown( int slot ) {
+            Entry entry = m_heap[slot];
+            int count = static_cast<int>(m_heap.size());
+            for (;;) {
+                int first = slot * 4 + 1;
+                if (first >= count)
+                    break;
+                int best = first;
+                int last = min( first + 4, count );
+                for (int child = first + 1; child < last; child++) {
+                    if (m_heap[child].key < m_heap[best].key)
+                        best = child;
+                }
+                if (!(m_heap[best].key < entry.key))
+                    break;
+                m_heap[slot] = m_heap[best];
+                m_slot[m_heap[slot].item] = slot;
+                slot = best;
+            }
+            m_heap[slot] = entry;
+            m_slot[entry.item] = slot;
+        }
+    };
+
+// ----------------------------------------------------------------
+//  Description:    The arcs leaving and entering each node.
+// ----------------------------------------------------------------
+    vector<vector<Link> > m_successors;
+    vector<vector<Link> > m_predecessors;
+    vector<Vector2> m_positions;
+
+// ----------------------------------------------------------------
+//  Description:    g(n) is the distance from each node to the goal
+//                  as last worked out, rhs(n) the best distance
+//                  through its successors' g. A node whose two
+//                  differ waits in the queue to be put right.
+// ----------------------------------------------------------------
+    vector<float> m_g;
+    vector<float> m_rhs;
+    Queue m_queue;
+
+    int m_start;
+    int m_goal;
+
+// ----------------------------------------------------------------
+//  Description:    How far the start has moved since the search
+//                  began, added to new keys so that the keys worked
+//                  out from an earlier start stay lower bounds.
+// ----------------------------------------------------------------
+    float m_km;
+
+    bool m_useHeuristic;
+    int m_expanded;
+
+public:
+    // Constructor functions
+    template<class NodeType, class ArcType>
+    IncrementalPlanner( Graph<NodeType, ArcType> const & graph, int start, int goal, bool useHeuristic = true );
+    template<class NodeType, class ArcType>
+    IncrementalPlanner( CompactGraph<NodeType, ArcType> const & graph, int start, int goal, bool useHeuristic = true );
+
+    // Accessors
+    int start() const {
+        return m_start;
+    }
+
+    int goal() const {
+        return m_goal;
+    }
+
+    int expanded() const {
+        return m_expanded;
+    }
+
+    float distance() const {
+        return m_g[m_start];
+    }
+
+    // Public member functions.
+    float plan();
+    void moveStart( int start );
+    void changeArcs( vector<ArcChange> const & changes );
+    void getPath( vector<int>& path ) const;
+
+private:
+    void initialise( int start, int goal );
+    float heuristic( int from, int to ) const;
+    Key key( int node ) const;
+    void updateNode( int node );
+    float bestThroughSuccessors( int node ) const;
+    static bool setLink( vector<Link>& links, int node, float weight, float& oldWeight );
+};
+
+// ----------------------------------------------------------------
+//  Name:           IncrementalPlanner
+//  Description:    Constructor, this copies the arcs of a graph.
+//                  Later changes to the graph are not seen, they
+//                  must be passed to changeArcs.
+//  Arguments:      The first parameter is the graph
+//                  The second and third parameters are the start
+//                  and goal indices
+//                  The fourth parameter is false to search without
+//                  a heuristic.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+IncrementalPlanner::IncrementalPlanner( Graph<NodeType, ArcType> const & graph, int start, int goal, bool useHeuristic )
+	: m_useHeuristic( useHeuristic ) {
+	int count = graph.maxNodes();
+	m_successors.resize(count);
+	m_predecessors.resize(count);
+	m_positions.resize(count);
+	for (int i = 0; i < count; i++) {
+		GraphNode<NodeType, ArcType> * pNode = graph.nodeArray()[i];
+		if (pNode == 0)
+			continue;
+		m_positions[i] = pNode->getPosition();
+		typename GraphNode<NodeType, ArcType>::ArcList::const_iterator iter = pNode->arcList().begin();
+		typename GraphNode<NodeType, ArcType>::ArcList::const_iterator endIter = pNode->arcList().end();
+		for (; iter != endIter; ++iter) {
+			Link link = { (*iter).node()->index(), static_cast<float>((*iter).weight()) };
+			m_successors[i].push_back(link);
+			link.node = i;
+			m_predecessors[(*iter).node()->index()].push_back(link);
+		}
+	}
+	initialise(start, goal);
+}
+
+// ----------------------------------------------------------------
+//  Name:           IncrementalPlanner
+//  Description:    Constructor, this copies the arcs of a compact
+//                  graph.
+//  Arguments:      As above.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+IncrementalPlanner::IncrementalPlanner( CompactGraph<NodeType, ArcType> const & graph, int start, int goal, bool useHeuristic )
+	: m_useHeuristic( useHeuristic ) {
+	int count = graph.nodeCount();
+	m_successors.resize(count);
+	m_predecessors.resize(count);
+	m_positions.resize(count);
+	for (int i = 0; i < count; i++) {
+		m_positions[i] = graph.getPosition(i);
+		for (int arc = graph.arcBegin(i); arc != graph.arcEnd(i); arc++) {
+			Link link = { graph.target(arc), static_cast<float>(graph.weight(arc)) };
+			m_successors[i].push_back(link);
+		}
+		for (int arc = graph.reverseArcBegin(i); arc != graph.reverseArcEnd(i); arc++) {
+			Link link = { graph.reverseSource(arc), static_cast<float>(graph.reverseWeight(arc)) };
+			m_predecessors[i].push_back(link);
+		}
+	}
+	initialise(start, goal);
+}
+
+// ----------------------------------------------------------------
+//  Name:           initialise
+//  Description:    Starts a new search, with only the goal known.
+//  Arguments:      The start and goal indices.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void IncrementalPlanner::initialise( int start, int goal ) {
+	int count = static_cast<int>(m_successors.size());
+	m_start = start;
+	m_goal = goal;
+	m_km = 0;
+	m_expanded = 0;
+	m_g.assign(count, numeric_limits<float>::infinity());
+	m_rhs.assign(count, numeric_limits<float>::infinity());
+	m_queue.reset(count);
+	m_rhs[goal] = 0;
+	m_queue.push(goal, key(goal));
+}
+
+// ----------------------------------------------------------------
+//  Name:           heuristic
+//  Description:    The straight line distance between two nodes,
+//                  or 0 if the heuristic is off.
+//  Arguments:      The two node indices.
+//  Return Value:   The distance.
+// ----------------------------------------------------------------
+inline float IncrementalPlanner::heuristic( int from, int to ) const {
+	if (!m_useHeuristic)
+		return 0;
+	Vector2 d = m_positions[from] - m_positions[to];
+	return sqrt(d.x * d.x + d.y * d.y);
+}
+
+// ----------------------------------------------------------------
+//  Name:           key
+//  Description:    The priority of a node in the queue.
+//  Arguments:      The node index.
+//  Return Value:   The key.
+// ----------------------------------------------------------------
+inline IncrementalPlanner::Key IncrementalPlanner::key( int node ) const {
+	Key k;
+	k.second = min(m_g[node], m_rhs[node]);
+	k.first = k.second + heuristic(m_start, node) + m_km;
+	return k;
+}
+
+// ----------------------------------------------------------------
+//  Name:           updateNode
+//  Description:    Queues a node whose g and rhs differ, and takes
+//                  one out of the queue once they agree.
+//  Arguments:      The node index.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void IncrementalPlanner::updateNode( int node ) {
+	bool consistent = m_g[node] == m_rhs[node];
+	if (!consistent && m_queue.contains(node))
+		m_queue.update(node, key(node));
+	else if (!consistent)
+		m_queue.push(node, key(node));
+	else if (m_queue.contains(node))
+		m_queue.remove(node);
+}
+
+// ----------------------------------------------------------------
+//  Name:           bestThroughSuccessors
+//  Description:    Works out rhs(n) from the successors of a node.
+//  Arguments:      The node index.
+//  Return Value:   The shortest arc weight plus g of its target.
+// ----------------------------------------------------------------
+inline float IncrementalPlanner::bestThroughSuccessors( int node ) const {
+	float best = numeric_limits<float>::infinity();
+	vector<Link> const & links = m_successors[node];
+	for (size_t i = 0; i < links.size(); i++)
+		best = min(best, links[i].weight + m_g[links[i].node]);
+	return best;
+}
+
+// ----------------------------------------------------------------
+//  Name:           plan
+//  Description:    Brings the distances up to date after the start
+//                  has moved or arcs have changed, expanding only
+//                  the nodes that need it. The first call is a
+//                  plain backward A* from the goal.
+//  Arguments:      None.
+//  Return Value:   The distance from the start to the goal, or
+//                  infinity if there is no path.
+// ----------------------------------------------------------------
+inline float IncrementalPlanner::plan() {
+	m_expanded = 0;
+	while (!m_queue.empty() && (m_queue.topKey() < key(m_start) || m_rhs[m_start] != m_g[m_start])) {
+		int node = m_queue.top();
+		Key oldKey = m_queue.topKey();
+		Key newKey = key(node);
+		m_expanded++;
+		if (oldKey < newKey) {
+			// the key was worked out before the start last moved
+			m_queue.update(node, newKey);
+		}
+		else if (m_g[node] > m_rhs[node]) {
+			// the node got closer, which may bring its predecessors closer
+			m_g[node] = m_rhs[node];
+			m_queue.remove(node);
+			vector<Link> const & links = m_predecessors[node];
+			for (size_t i = 0; i < links.size(); i++) {
+				int previous = links[i].node;
+				if (previous != m_goal)
+					m_rhs[previous] = min(m_rhs[previous], links[i].weight + m_g[node]);
+				updateNode(previous);
+			}
+		}
+		else {
+			// the node got further, anything that went through it must look again
+			float oldG = m_g[node];
+			m_g[node] = numeric_limits<float>::infinity();
+			if (node != m_goal && m_rhs[node] == oldG)
+				m_rhs[node] = bestThroughSuccessors(node);
+			updateNode(node);
+			vector<Link> const & links = m_predecessors[node];
+			for (size_t i = 0; i < links.size(); i++) {
+				int previous = links[i].node;
+				if (previous != m_goal && m_rhs[previous] == links[i].weight + oldG)
+					m_rhs[previous] = bestThroughSuccessors(previous);
+				updateNode(previous);
+			}
+		}
+	}
+	return m_rhs[m_start];
+}
+
+// ----------------------------------------------------------------
+//  Name:           moveStart
+//  Description:    Moves the start, normally to the next node on
+//                  the path once the agent has reached it.
+//  Arguments:      The new start index.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void IncrementalPlanner::moveStart( int start ) {
+	m_km += heuristic(m_start, start);
+	m_start = start;
+}
+
+// ----------------------------------------------------------------
+//  Name:           changeArcs
+//  Description:    Adds, removes and reweights arcs. Only rhs of
+//                  the nodes the arcs leave is updated here, the
+//                  next plan call does the rest.
+//  Arguments:      The changes.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void IncrementalPlanner::changeArcs( vector<ArcChange> const & changes ) {
+	for (size_t i = 0; i < changes.size(); i++) {
+		int from = changes[i].from;
+		int to = changes[i].to;
+		float weight = changes[i].weight;
+		float oldWeight;
+		if (!setLink(m_successors[from], to, weight, oldWeight))
+			continue;
+		setLink(m_predecessors[to], from, weight, oldWeight);
+
+		if (from == m_goal)
+			continue;
+		if (weight < oldWeight)
+			m_rhs[from] = min(m_rhs[from], weight + m_g[to]);
+		else if (m_rhs[from] == oldWeight + m_g[to])
+			m_rhs[from] = bestThroughSuccessors(from);
+		updateNode(from);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           setLink
+//  Description:    Sets the weight of the link to a node, adding
+//                  or removing it as needed.
+//  Arguments:      The links, the node, the new weight and where
+//                  to put the old weight, infinity if there was no
+//                  link.
+//  Return Value:   True if the weight changed.
+// ----------------------------------------------------------------
+inline bool IncrementalPlanner::setLink( vector<Link>& links, int node, float weight, float& oldWeight ) {
+	oldWeight = numeric_limits<float>::infinity();
+	for (size_t i = 0; i < links.size(); i++) {
+		if (links[i].node == node) {
+			oldWeight = links[i].weight;
+			if (weight == numeric_limits<float>::infinity()) {
+				links[i] = links.back();
+				links.pop_back();
+			}
+			else {
+				links[i].weight = weight;
+			}
+			return oldWeight != weight;
+		}
+	}
+	if (weight == numeric_limits<float>::infinity())
+		return false;
+	Link link = { node, weight };
+	links.push_back(link);
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           getPath
+//  Description:    Follows the arcs from the start that keep to the
+//                  shortest distance. As with the searches, the
+//                  path is returned from the goal back to the
+//                  start, and is just the goal if there is no path.
+//  Arguments:      Receives the path.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void IncrementalPlanner::getPath( vector<int>& path ) const {
+	path.clear();
+	int count = static_cast<int>(m_successors.size());
+	if (m_g[m_start] != numeric_limits<float>::infinity()) {
+		for (int node = m_start; node != m_goal && static_cast<int>(path.size()) < count; ) {
+			path.push_back(node);
+			vector<Link> const & links = m_successors[node];
+			int next = -1;
+			float best = numeric_limits<float>::infinity();
+			for (size_t i = 0; i < links.size(); i++) {
+				float through = links[i].weight + m_g[links[i].node];
+				if (through < best) {
+					best = through;
+					next = links[i].node;
+				}
+			}
+			if (next == -1)
+				break;
+			node = next;
+		}
+	}
+	path.push_back(m_goal);
+	reverse(path.begin(), path.end());
+}
+
+#endif
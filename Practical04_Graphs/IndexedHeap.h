@@ -0,0 +1,437 @@
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  The priority queues in this file hold node indices in the range
+//  [0, capacity) keyed by a float cost, smallest first, and share
+//  one interface so the searches can be given any of them:
+//
+//      reset( capacity )       empty the queue
+//      empty(), size()
+//      contains( item )        item is waiting in the queue
+//      push( item, key )       item must not be in the queue
+//      decreaseKey( item, key) item must be in the queue
+//      pushOrDecrease( item, key )
+//      top(), topKey(), pop()
+// ----------------------------------------------------------------
+
+// ----------------------------------------------------------------
+//  Name:           IndexedDaryHeap
+//  Description:    An array based heap with D children per node
+//                  that remembers where each item is, so the key
+//                  of a waiting item can be lowered in O(log n).
+//                  A wider heap is shallower, which suits the
+//                  many decrease-keys of a search.
+// ----------------------------------------------------------------
+template<int D = 4>
+class IndexedDaryHeap {
+private:
+    struct Entry {
+        float key;
+        int item;
+    };
+
+// ----------------------------------------------------------------
+//  Description:    The heap, smallest key at the front.
+// ----------------------------------------------------------------
+    vector<Entry> m_heap;
+
+// ----------------------------------------------------------------
+//  Description:    The slot of each item in the heap, or -1.
+// ----------------------------------------------------------------
+    vector<int> m_slot;
+
+public:
+    IndexedDaryHeap( int capacity = 0 ) {
+        reset( capacity );
+    }
+
+    bool empty() const {
+        return m_heap.empty();
+    }
+
+    int size() const {
+        return static_cast<int>(m_heap.size());
+    }
+
+    bool contains( int item ) const {
+        return m_slot[item] != -1;
+    }
+
+    int top() const {
+        return m_heap[0].item;
+    }
+
+    float topKey() const {
+        return m_heap[0].key;
+    }
+
+// ----------------------------------------------------------------
+//  Name:           reset
+//  Description:    Empties the heap. Only the items still waiting
+//                  are cleared, so this is cheap after a search.
+//  Arguments:      The number of items the heap must index.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+    void reset( int capacity ) {
+        for (size_t i = 0; i < m_heap.size(); i++) {
+            m_slot[m_heap[i].item] = -1;
+        }
+        m_heap.clear();
+        if (static_cast<int>(m_slot.size()) != capacity) {
+            m_slot.assign( capacity, -1 );
+        }
+    }
+
+    void push( int item, float key ) {
+        Entry entry;
+        entry.key = key;
+        entry.item = item;
+        m_heap.push_back( entry );
+        m_slot[item] = static_cast<int>(m_heap.size()) - 1;
+        siftUp( static_cast<int>(m_heap.size()) - 1 );
+    }
+
+    void decreaseKey( int item, float key ) {
+        m_heap[m_slot[item]].key = key;
+        siftUp( m_slot[item] );
+    }
+
+    void pushOrDecrease( int item, float key ) {
+        if (contains( item ))
+            decreaseKey( item, key );
+        else
+            push( item, key );
+    }
+
+    int pop() {
+        int item = m_heap[0].item;
+        m_slot[item] = -1;
+        Entry last = m_heap.back();
+        m_heap.pop_back();
+        if (!m_heap.empty()) {
+            m_heap[0] = last;
+            m_slot[last.item] = 0;
+            siftDown( 0 );
+        }
+        return item;
+    }
+
+private:
+    void siftUp( int slot ) {
+        Entry entry = m_heap[slot];
+        while (slot > 0) {
+            int parent = (slot - 1) / D;
+            if (!(entry.key < m_heap[parent].key))
+                break;
+            m_heap[slot] = m_heap[parent];
+            m_slot[m_heap[slot].item] = slot;
+            slot = parent;
+        }
+        m_heap[slot] = entry;
+        m_slot[entry.item] = slot;
+    }
+
+    void siftDown( int slot ) {
+        Entry entry = m_heap[slot];
+        int count = static_cast<int>(m_heap.size());
+        for (;;) {
+            int first = slot * D + 1;
+            if (first >= count)
+                break;
+            // find the smallest child
+            int best = first;
+            int last = min( first + D, count );
+            for (int child = first + 1; child < last; child++) {
+                if (m_heap[child].key < m_heap[best].key)
+                    best = child;
+            }
+            if (!(m_heap[best].key < entry.key))
+                break;
+            m_heap[slot] = m_heap[best];
+            m_slot[m_heap[slot].item] = slot;
+            slot = best;
+        }
+        m_heap[slot] = entry;
+        m_slot[entry.item] = slot;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           PairingHeap
+//  Description:    A pairing heap over item indices. Push and
+//                  decrease-key are O(1), pop is amortised
+//                  O(log n). The tree links are stored in arrays
+//                  indexed by item so nothing is allocated per
+//                  push.
+// ----------------------------------------------------------------
+class PairingHeap {
+private:
+// ----------------------------------------------------------------
+//  Description:    The key, leftmost child, right sibling and
+//                  previous link (parent if leftmost, otherwise
+//                  left sibling) of each item.
+// ----------------------------------------------------------------
+    vector<float> m_key;
+    vector<int> m_child;
+    vector<int> m_sibling;
+    vector<int> m_prev;
+    vector<char> m_inHeap;
+
+// ----------------------------------------------------------------
+//  Description:    The waiting items, so reset only clears those.
+// ----------------------------------------------------------------
+    vector<int> m_touched;
+
+// ----------------------------------------------------------------
+//  Description:    Scratch list of subtrees used by pop.
+// ----------------------------------------------------------------
+    vector<int> m_pairs;
+
+    int m_root;
+    int m_size;
+
+public:
+    PairingHeap( int capacity = 0 ) : m_root( -1 ), m_size( 0 ) {
+        reset( capacity );
+    }
+
+    bool empty() const {
+        return m_root == -1;
+    }
+
+    int size() const {
+        return m_size;
+    }
+
+    bool contains( int item ) const {
+        return m_inHeap[item] != 0;
+    }
+
+    int top() const {
+        return m_root;
+    }
+
+    float topKey() const {
+        return m_key[m_root];
+    }
+
+    void reset( int capacity ) {
+        if (static_cast<int>(m_key.size()) != capacity) {
+            m_key.assign( capacity, 0.0f );
+            m_child.assign( capacity, -1 );
+            m_sibling.assign( capacity, -1 );
+            m_prev.assign( capacity, -1 );
+            m_inHeap.assign( capacity, false );
+        }
+        else {
+            for (size_t i = 0; i < m_touched.size(); i++) {
+                m_inHeap[m_touched[i]] = false;
+            }
+        }
+        m_touched.clear();
+        m_root = -1;
+        m_size = 0;
+    }
+
+    void push( int item, float key ) {
+        m_key[item] = key;
+        m_child[item] = -1;
+        m_sibling[item] = -1;
+        m_prev[item] = -1;
+        m_inHeap[item] = true;
+        m_touched.push_back( item );
+        m_root = (m_root == -1) ? item : meld( m_root, item );
+        m_size++;
+    }
+
+    void decreaseKey( int item, float key ) {
+        m_key[item] = key;
+        if (item != m_root) {
+            // cut the subtree out and meld it back in at the root
+            int prev = m_prev[item];
+            if (m_child[prev] == item)
+                m_child[prev] = m_sibling[item];
+            else
+                m_sibling[prev] = m_sibling[item];
+            if (m_sibling[item] != -1)
+                m_prev[m_sibling[item]] = prev;
+            m_sibling[item] = -1;
+            m_prev[item] = -1;
+            m_root = meld( m_root, item );
+        }
+    }
+
+    void pushOrDecrease( int item, float key ) {
+        if (contains( item ))
+            decreaseKey( item, key );
+        else
+            push( item, key );
+    }
+
+    int pop() {
+        int item = m_root;
+        m_inHeap[item] = false;
+        m_size--;
+
+        // first pass: meld the children in pairs from left to right
+        m_pairs.clear();
+        int child = m_child[item];
+        while (child != -1) {
+            int next = m_sibling[child];
+            m_sibling[child] = -1;
+            m_prev[child] = -1;
+            if (next != -1) {
+                int after = m_sibling[next];
+                m_sibling[next] = -1;
+                m_prev[next] = -1;
+                m_pairs.push_back( meld( child, next ) );
+                child = after;
+            }
+            else {
+                m_pairs.push_back( child );
+                child = -1;
+            }
+        }
+
+        // second pass: meld the pairs from right to left
+        m_root = -1;
+        for (int i = static_cast<int>(m_pairs.size()) - 1; i >= 0; i--) {
+            m_root = (m_root == -1) ? m_pairs[i] : meld( m_pairs[i], m_root );
+        }
+        m_child[item] = -1;
+        return item;
+    }
+
+private:
+    // makes the root with the larger key the leftmost child of the other
+    int meld( int a, int b ) {
+        if (m_key[b] < m_key[a])
+            swap( a, b );
+        m_sibling[b] = m_child[a];
+        if (m_child[a] != -1)
+            m_prev[m_child[a]] = b;
+        m_prev[b] = a;
+        m_child[a] = b;
+        return a;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           LazyHeap
+//  Description:    A plain binary heap that handles decrease-key
+//                  by pushing the item again and discarding the
+//                  out of date copies as they reach the top. It
+//                  does no index bookkeeping on push, which can be
+//                  faster when few keys are lowered.
+// ----------------------------------------------------------------
+class LazyHeap {
+private:
+    typedef pair<float, int> Entry;
+
+// ----------------------------------------------------------------
+//  Description:    The heap, which may hold stale copies.
+// ----------------------------------------------------------------
+    vector<Entry> m_heap;
+
+// ----------------------------------------------------------------
+//  Description:    The current key of each waiting item.
+// ----------------------------------------------------------------
+    vector<float> m_key;
+    vector<char> m_inHeap;
+    vector<int> m_touched;
+    int m_size;
+
+public:
+    LazyHeap( int capacity = 0 ) : m_size( 0 ) {
+        reset( capacity );
+    }
+
+    bool empty() {
+        prune();
+        return m_heap.empty();
+    }
+
+    int size() const {
+        return m_size;
+    }
+
+    bool contains( int item ) const {
+        return m_inHeap[item] != 0;
+    }
+
+    int top() {
+        prune();
+        return m_heap.front().second;
+    }
+
+    float topKey() {
+        prune();
+        return m_heap.front().first;
+    }
+
+    void reset( int capacity ) {
+        if (static_cast<int>(m_key.size()) != capacity) {
+            m_key.assign( capacity, 0.0f );
+            m_inHeap.assign( capacity, false );
+        }
+        else {
+            for (size_t i = 0; i < m_touched.size(); i++) {
+                m_inHeap[m_touched[i]] = false;
+            }
+        }
+        m_touched.clear();
+        m_heap.clear();
+        m_size = 0;
+    }
+
+    void push( int item, float key ) {
+        m_key[item] = key;
+        m_inHeap[item] = true;
+        m_touched.push_back( item );
+        m_size++;
+        m_heap.push_back( Entry( key, item ) );
+        push_heap( m_heap.begin(), m_heap.end(), greater<Entry>() );
+    }
+
+    void decreaseKey( int item, float key ) {
+        m_key[item] = key;
+        m_heap.push_back( Entry( key, item ) );
+        push_heap( m_heap.begin(), m_heap.end(), greater<Entry>() );
+    }
+
+    void pushOrDecrease( int item, float key ) {
+        if (contains( item ))
+            decreaseKey( item, key );
+        else
+            push( item, key );
+    }
+
+    int pop() {
+        prune();
+        int item = m_heap.front().second;
+        pop_heap( m_heap.begin(), m_heap.end(), greater<Entry>() );
+        m_heap.pop_back();
+        m_inHeap[item] = false;
+        m_size--;
+        return item;
+    }
+
+private:
+    // drops copies at the top that were superseded or already popped
+    void prune() {
+        while (!m_heap.empty() && (!m_inHeap[m_heap.front().second] || m_heap.front().first != m_key[m_heap.front().second])) {
+            pop_heap( m_heap.begin(), m_heap.end(), greater<Entry>() );
+            m_heap.pop_back();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <limits>
+#include <vector>
+#include "Graph.h"
+#include "IndexedHeap.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           Landmarks
+//  Description:    A heuristic policy for aStar built from the
+//                  shortest distances to and from a few landmark
+//                  nodes (ALT). By the triangle inequality
+//                      d(n, t) >= d(L, t) - d(L, n)
+//                      d(n, t) >= d(n, L) - d(t, L)
+//                  for any landmark L, and the largest of these is
+//                  used as h(n). Unlike the straight line distance
+//                  it needs no positions and follows the arc
+//                  weights, so it stays tight on graphs weighted by
+//                  travel time. Landmarks are chosen far apart, each
+//                  the node furthest from those already chosen.
+// ----------------------------------------------------------------
+class Landmarks {
+private:
+// ----------------------------------------------------------------
+//  Description:    The landmark nodes.
+// ----------------------------------------------------------------
+    vector<int> m_landmarks;
+
+// ----------------------------------------------------------------
+//  Description:    The distance from each landmark to each node and
+//                  from each node to each landmark, infinity if
+//                  there is no path. The landmarks of a node are
+//                  stored together, so working out h(n) reads two
+//                  short runs of memory.
+// ----------------------------------------------------------------
+    vector<float> m_from;
+    vector<float> m_to;
+
+public:
+    // Constructor functions
+    Landmarks();
+    template<class NodeType, class ArcType>
+    Landmarks( CompactGraph<NodeType, ArcType> const & graph, int count, ThreadPool * pPool = 0 );
+    template<class NodeType, class ArcType>
+    Landmarks( Graph<NodeType, ArcType> const & graph, int count, ThreadPool * pPool = 0 );
+
+    // Accessors
+    int landmarkCount() const {
+        return static_cast<int>(m_landmarks.size());
+    }
+
+    int landmark( int i ) const {
+        return m_landmarks[i];
+    }
+
+    float operator()( int node, int dest ) const;
+
+private:
+    template<class NodeType, class ArcType>
+    void build( CompactGraph<NodeType, ArcType> const & graph, int count, ThreadPool * pPool );
+    template<class NodeType, class ArcType>
+    static void distances( CompactGraph<NodeType, ArcType> const & graph, IndexedDaryHeap<4>& nodeQueue, int source, bool backward, vector<float>& distance );
+};
+
+// ----------------------------------------------------------------
+//  Name:           Landmarks
+//  Description:    Constructor, this makes a policy with no
+//                  landmarks, which always gives 0.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline Landmarks::Landmarks() {
+}
+
+// ----------------------------------------------------------------
+//  Name:           Landmarks
+//  Description:    Constructor, this chooses the landmarks of a
+//                  compact graph and works out their distances.
+//  Arguments:      The first parameter is the graph
+//                  The second parameter is the number of landmarks
+//                  The third parameter is a pool to work out the
+//                  distances on, or 0 to use this thread.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+Landmarks::Landmarks( CompactGraph<NodeType, ArcType> const & graph, int count, ThreadPool * pPool ) {
+	build(graph, count, pPool);
+}
+
+// ----------------------------------------------------------------
+//  Name:           Landmarks
+//  Description:    Constructor, this builds the landmarks of a graph
+//                  as it is now, later changes are not reflected.
+//  Arguments:      As above.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+Landmarks::Landmarks( Graph<NodeType, ArcType> const & graph, int count, ThreadPool * pPool ) {
+	build(graph.freeze(), count, pPool);
+}
+
+// ----------------------------------------------------------------
+//  Name:           operator()
+//  Description:    The landmark lower bound on the distance from a
+//                  node to the destination. Bounds that involve an
+//                  infinite distance come out as NaN or -infinity
+//                  and are passed over by the comparisons.
+//  Arguments:      The node and destination indices.
+//  Return Value:   The lower bound, never less than 0.
+// ----------------------------------------------------------------
+inline float Landmarks::operator()( int node, int dest ) const {
+	int count = landmarkCount();
+	float const * pFromNode = m_from.data() + static_cast<size_t>(node) * count;
+	float const * pFromDest = m_from.data() + static_cast<size_t>(dest) * count;
+	float const * pToNode = m_to.data() + static_cast<size_t>(node) * count;
+	float const * pToDest = m_to.data() + static_cast<size_t>(dest) * count;
+	float best = 0;
+	for (int i = 0; i < count; i++) {
+		float ahead = pFromDest[i] - pFromNode[i];
+		float behind = pToNode[i] - pToDest[i];
+		if (ahead > best)
+			best = ahead;
+		if (behind > best)
+			best = behind;
+	}
+	return best;
+}
+
+// ----------------------------------------------------------------
+//  Name:           build
+//  Description:    Chooses the landmarks one at a time. The first
+//                  is the node furthest from a seed node, each next
+//                  the reached node furthest from its closest
+//                  landmark. Distance is taken both along and
+//                  against the arcs, so on a directed graph a sink
+//                  or source still counts as near its neighbours.
+//                  The two searches from each landmark run side by
+//                  side on the pool and give its tables.
+//  Arguments:      The graph, the number of landmarks and the pool.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void Landmarks::build( CompactGraph<NodeType, ArcType> const & graph, int count, ThreadPool * pPool ) {
+	int nodes = graph.nodeCount();
+	m_landmarks.clear();
+	if (nodes == 0 || count <= 0) {
+		m_from.clear();
+		m_to.clear();
+		return;
+	}
+
+	vector<IndexedDaryHeap<4> > queues(2, IndexedDaryHeap<4>(nodes));
+	vector<vector<float> > from;
+	vector<vector<float> > to;
+	vector<float> closest(nodes, numeric_limits<float>::infinity());
+
+	// searches out from and back to one node, side by side on the pool
+	vector<float> forward;
+	vector<float> backward;
+	int source = 0;
+	function<void(int, int, int)> search = [&](int, int begin, int end) {
+		for (int i = begin; i < end; i++)
+			distances(graph, queues[i], source, i == 1, i == 1 ? backward : forward);
+	};
+
+	// start from a node with arcs so the landmarks land in a connected part
+	while (source + 1 < nodes && graph.arcBegin(source) == graph.arcEnd(source))
+		source++;
+	for (;;) {
+		if (pPool != 0)
+			pPool->parallelFor(2, 1, search);
+		else
+			search(0, 0, 2);
+		if (!m_landmarks.empty()) {
+			from.push_back(forward);
+			to.push_back(backward);
+			if (landmarkCount() == count)
+				break;
+		}
+		// the first search is from the seed, which is not a landmark itself
+		if (landmarkCount() == 1)
+			closest.assign(nodes, numeric_limits<float>::infinity());
+
+		// a node is as close to the landmarks as the nearest in either direction,
+		// so a landmark with no way out or no way in still pushes the next away
+		for (int node = 0; node < nodes; node++)
+			closest[node] = min(closest[node], min(forward[node], backward[node]));
+
+		int furthest = -1;
+		for (int node = 0; node < nodes; node++) {
+			if (closest[node] != numeric_limits<float>::infinity() && (furthest == -1 || closest[node] > closest[furthest]))
+				furthest = node;
+		}
+		// every reached node is already a landmark
+		if (furthest == -1 || (closest[furthest] == 0 && !m_landmarks.empty()))
+			break;
+		m_landmarks.push_back(furthest);
+		source = furthest;
+	}
+	int landmarks = landmarkCount();
+
+	// store the landmarks of each node together
+	m_from.resize(static_cast<size_t>(nodes) * landmarks);
+	m_to.resize(static_cast<size_t>(nodes) * landmarks);
+	for (int node = 0; node < nodes; node++) {
+		for (int i = 0; i < landmarks; i++) {
+			m_from[static_cast<size_t>(node) * landmarks + i] = from[i][node];
+			m_to[static_cast<size_t>(node) * landmarks + i] = to[i][node];
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           distances
+//  Description:    Uniform cost search over the whole graph, along
+//                  the arcs or against them.
+//  Arguments:      The graph, a queue to use, the node to search
+//                  from, the direction and the vector that receives
+//                  the distance to or from each node.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void Landmarks::distances( CompactGraph<NodeType, ArcType> const & graph, IndexedDaryHeap<4>& nodeQueue, int source, bool backward, vector<float>& distance ) {
+	distance.assign(graph.nodeCount(), numeric_limits<float>::infinity());
+	nodeQueue.reset(graph.nodeCount());
+	distance[source] = 0;
+	nodeQueue.push(source, 0);
+	while (!nodeQueue.empty()) {
+		int currNode = nodeQueue.pop();
+		int begin = backward ? graph.reverseArcBegin(currNode) : graph.arcBegin(currNode);
+		int end = backward ? graph.reverseArcEnd(currNode) : graph.arcEnd(currNode);
+		for (int arc = begin; arc != end; arc++) {
+			int next = backward ? graph.reverseSource(arc) : graph.target(arc);
+			float dist = distance[currNode] + static_cast<float>(backward ? graph.reverseWeight(arc) : graph.weight(arc));
+			if (dist < distance[next]) {
+				distance[next] = dist;
+				nodeQueue.pushOrDecrease(next, dist);
+			}
+		}
+	}
+}
+
+#endif
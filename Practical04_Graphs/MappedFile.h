@@ -0,0 +1,131 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           MappedFile
+//  Description:    A whole file mapped read only into memory. The
+//                  pages are only read from disk when first used.
+// ----------------------------------------------------------------
+class MappedFile {
+private:
+    char const * m_pData;
+    size_t m_size;
+#ifdef _WIN32
+    HANDLE m_file;
+    HANDLE m_mapping;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open( string const & fileName );
+
+    char const * data() const {
+        return m_pData;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+private:
+    MappedFile( MappedFile const & );
+    MappedFile & operator=( MappedFile const & );
+};
+
+// ----------------------------------------------------------------
+//  Name:           MappedFile
+//  Description:    Constructor, this makes an empty mapping.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline MappedFile::MappedFile() : m_pData( 0 ), m_size( 0 ) {
+#ifdef _WIN32
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = 0;
+#endif
+}
+
+// ----------------------------------------------------------------
+//  Name:           ~MappedFile
+//  Description:    Destructor, this unmaps the file.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline MappedFile::~MappedFile() {
+#ifdef _WIN32
+	if (m_pData != 0)
+		UnmapViewOfFile(m_pData);
+	if (m_mapping != 0)
+		CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+#else
+	if (m_pData != 0)
+		munmap(const_cast<char *>(m_pData), m_size);
+#endif
+}
+
+// ----------------------------------------------------------------
+//  Name:           open
+//  Description:    Maps a file. Only one file may be opened.
+//  Arguments:      The file name.
+//  Return Value:   True if the file was mapped, an empty file is
+//                  not.
+// ----------------------------------------------------------------
+inline bool MappedFile::open( string const & fileName ) {
+	if (m_pData != 0)
+		return false;
+#ifdef _WIN32
+	m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+		return false;
+	m_mapping = CreateFileMappingA(m_file, 0, PAGE_READONLY, 0, 0, 0);
+	if (m_mapping == 0)
+		return false;
+	m_pData = static_cast<char const *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_pData == 0)
+		return false;
+	m_size = static_cast<size_t>(size.QuadPart);
+#else
+	int file = ::open(fileName.c_str(), O_RDONLY);
+	if (file == -1)
+		return false;
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0) {
+		close(file);
+		return false;
+	}
+	void * pData = mmap(0, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	// the mapping holds its own reference to the file
+	close(file);
+	if (pData == MAP_FAILED)
+		return false;
+	m_pData = static_cast<char const *>(pData);
+	m_size = static_cast<size_t>(status.st_size);
+#endif
+	return true;
+}
+
+#endif
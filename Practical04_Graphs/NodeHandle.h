@@ -0,0 +1,32 @@
+#ifndef NODEHANDLE_H
+#define NODEHANDLE_H
+
+// ----------------------------------------------------------------
+//  Name:           NodeHandle
+//  Description:    Names a node of a graph by its index and the
+//                  generation of its slot. A slot's generation
+//                  moves on whenever its node is removed, so a
+//                  handle kept after its node has gone does not
+//                  name whatever node is later put in the same
+//                  slot. A default handle names no node.
+// ----------------------------------------------------------------
+struct NodeHandle {
+    int index;
+    unsigned generation;
+
+    NodeHandle() : index( -1 ), generation( 0 ) {
+    }
+
+    NodeHandle( int nodeIndex, unsigned slotGeneration ) : index( nodeIndex ), generation( slotGeneration ) {
+    }
+
+    bool operator==( NodeHandle const & other ) const {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool operator!=( NodeHandle const & other ) const {
+        return !(*this == other);
+    }
+};
+
+#endif
@@ -0,0 +1,312 @@
+#ifndef QUERYCACHE_H
+#define QUERYCACHE_H
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Graph.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           QueryCache
+//  Description:    Remembers the distance and path of recent
+//                  queries on a graph, so a repeated query is a
+//                  hash lookup rather than a search. Queries are
+//                  keyed by start, destination and search, and the
+//                  least recently used are dropped once the cache
+//                  holds more than its size in bytes. The cache is
+//                  split into shards with a lock each so threads
+//                  rarely wait on one another. Every answer is
+//                  thrown away as soon as the graph's generation
+//                  moves on, so a changed graph is never answered
+//                  from before the change. Arcs are reweighted with
+//                  Graph::setWeight, which moves it on too, as
+//                  getArc only hands out arcs that can't be changed.
+//                  The graph must not be changed while a query is
+//                  running.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+class QueryCache {
+private:
+
+    // typedef the classes to make our lives easier.
+    typedef GraphNode<NodeType, ArcType> Node;
+
+public:
+    enum Search { UCS, ASTAR };
+
+private:
+    struct Key {
+        int start;
+        int dest;
+        int search;
+
+        bool operator==( Key const & other ) const {
+            return start == other.start && dest == other.dest && search == other.search;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()( Key const & key ) const {
+            unsigned long long h = (static_cast<unsigned long long>(static_cast<unsigned>(key.start)) << 32) | static_cast<unsigned>(key.dest);
+            h ^= static_cast<unsigned long long>(key.search) * 0x9e3779b97f4a7c15ULL;
+            // spread the bits so both the shard and the bucket see them
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
+        }
+    };
+
+    struct Entry {
+        Key key;
+        float distance;
+        vector<int> path;
+        size_t bytes;
+    };
+
+// ----------------------------------------------------------------
+//  Description:    One part of the cache. The entries are kept
+//                  most recently used first, and generation is the
+//                  graph generation they were worked out at.
+// ----------------------------------------------------------------
+    struct Shard {
+        mutex lock;
+        list<Entry> entries;
+        unordered_map<Key, typename list<Entry>::iterator, KeyHash> index;
+        size_t bytes;
+        unsigned long long generation;
+        unsigned long long hits;
+        unsigned long long misses;
+    };
+
+    Graph<NodeType, ArcType> const & m_graph;
+    vector<Shard> m_shards;
+    size_t m_shardBytes;
+
+public:
+    QueryCache( Graph<NodeType, ArcType> const & graph, size_t bytes, int shards = 16 );
+
+    float ucs( SearchContext& context, Node* pStart, Node* pDest, std::vector<Node *>& path );
+    float aStar( SearchContext& context, Node* pStart, Node* pDest, std::vector<Node *>& path );
+    unsigned long long hits();
+    unsigned long long misses();
+    size_t bytes();
+    void clear();
+
+private:
+    QueryCache( QueryCache const & );
+    QueryCache & operator=( QueryCache const & );
+
+    float query( SearchContext& context, Search search, Node* pStart, Node* pDest, std::vector<Node *>& path );
+    Shard & shardOf( Key const & key );
+    static void drop( Shard & shard );
+    static void ignoreNode( Node* ) {}
+};
+
+// ----------------------------------------------------------------
+//  Name:           QueryCache
+//  Description:    Constructor, this makes an empty cache.
+//  Arguments:      The first parameter is the graph to search
+//                  The second parameter is the most memory the
+//                  entries may take, shared evenly between shards
+//                  The third parameter is the number of shards.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+QueryCache<NodeType, ArcType>::QueryCache( Graph<NodeType, ArcType> const & graph, size_t bytes, int shards )
+	: m_graph( graph ), m_shards( shards > 0 ? shards : 1 ) {
+	m_shardBytes = bytes / m_shards.size();
+	for (size_t i = 0; i < m_shards.size(); i++) {
+		m_shards[i].bytes = 0;
+		m_shards[i].generation = graph.generation();
+		m_shards[i].hits = 0;
+		m_shards[i].misses = 0;
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           ucs
+//  Description:    Uniform cost search through the cache.
+//  Arguments:      The first parameter is the search context, used
+//                  only when the query is not cached
+//                  The second parameter is the starting node
+//                  The third parameter is the destination node
+//                  The fourth parameter receives the path, from
+//                  the destination back to the start.
+//  Return Value:   The distance, infinity if there is no path.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+float QueryCache<NodeType, ArcType>::ucs( SearchContext& context, Node* pStart, Node* pDest, std::vector<Node *>& path ) {
+	return query(context, UCS, pStart, pDest, path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           aStar
+//  Description:    A* search through the cache.
+//  Arguments:      As above.
+//  Return Value:   The distance, infinity if there is no path.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+float QueryCache<NodeType, ArcType>::aStar( SearchContext& context, Node* pStart, Node* pDest, std::vector<Node *>& path ) {
+	return query(context, ASTAR, pStart, pDest, path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           hits, misses
+//  Description:    The number of queries answered from the cache
+//                  and the number that had to search.
+//  Arguments:      None.
+//  Return Value:   The count over all shards.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+unsigned long long QueryCache<NodeType, ArcType>::hits() {
+	unsigned long long total = 0;
+	for (size_t i = 0; i < m_shards.size(); i++) {
+		lock_guard<mutex> guard(m_shards[i].lock);
+		total += m_shards[i].hits;
+	}
+	return total;
+}
+
+template<class NodeType, class ArcType>
+unsigned long long QueryCache<NodeType, ArcType>::misses() {
+	unsigned long long total = 0;
+	for (size_t i = 0; i < m_shards.size(); i++) {
+		lock_guard<mutex> guard(m_shards[i].lock);
+		total += m_shards[i].misses;
+	}
+	return total;
+}
+
+// ----------------------------------------------------------------
+//  Name:           bytes
+//  Description:    The memory the entries take, roughly.
+//  Arguments:      None.
+//  Return Value:   The size in bytes.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+size_t QueryCache<NodeType, ArcType>::bytes() {
+	size_t total = 0;
+	for (size_t i = 0; i < m_shards.size(); i++) {
+		lock_guard<mutex> guard(m_shards[i].lock);
+		total += m_shards[i].bytes;
+	}
+	return total;
+}
+
+// ----------------------------------------------------------------
+//  Name:           clear
+//  Description:    Drops every entry, the counts are kept.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void QueryCache<NodeType, ArcType>::clear() {
+	for (size_t i = 0; i < m_shards.size(); i++) {
+		lock_guard<mutex> guard(m_shards[i].lock);
+		drop(m_shards[i]);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           query
+//  Description:    Answers a query from its shard if it can, else
+//                  searches and stores the answer. The shard lock
+//                  is not held during the search.
+//  Arguments:      The context, the search and the query.
+//  Return Value:   The distance, infinity if there is no path.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+float QueryCache<NodeType, ArcType>::query( SearchContext& context, Search search, Node* pStart, Node* pDest, std::vector<Node *>& path ) {
+	Key key;
+	key.start = pStart->index();
+	key.dest = pDest->index();
+	key.search = search;
+	Shard & shard = shardOf(key);
+	unsigned long long generation = m_graph.generation();
+	{
+		lock_guard<mutex> guard(shard.lock);
+		// everything in the shard is out of date once the graph changes
+		if (shard.generation != generation) {
+			drop(shard);
+			shard.generation = generation;
+		}
+		typename unordered_map<Key, typename list<Entry>::iterator, KeyHash>::iterator found = shard.index.find(key);
+		if (found != shard.index.end()) {
+			shard.hits++;
+			shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+			Entry const & entry = *found->second;
+			Node** pNodes = m_graph.nodeArray();
+			path.clear();
+			for (size_t i = 0; i < entry.path.size(); i++)
+				path.push_back(pNodes[entry.path[i]]);
+			return entry.distance;
+		}
+		shard.misses++;
+	}
+
+	if (search == UCS)
+		m_graph.ucs(context, pStart, pDest, ignoreNode, path);
+	else
+		m_graph.aStar(context, pStart, pDest, ignoreNode, path);
+
+	Entry entry;
+	entry.key = key;
+	entry.distance = context.distance(key.dest);
+	entry.path.resize(path.size());
+	for (size_t i = 0; i < path.size(); i++)
+		entry.path[i] = path[i]->index();
+	// the list node and the hash entry cost a few pointers on top
+	entry.bytes = sizeof(Entry) + sizeof(int) * entry.path.size() + 6 * sizeof(void *);
+	if (entry.bytes > m_shardBytes)
+		return entry.distance;
+
+	lock_guard<mutex> guard(shard.lock);
+	// another thread may have stored the same query meanwhile
+	if (shard.generation != generation || shard.index.count(key) != 0)
+		return entry.distance;
+	float distance = entry.distance;
+	shard.bytes += entry.bytes;
+	shard.entries.push_front(std::move(entry));
+	shard.index[key] = shard.entries.begin();
+	while (shard.bytes > m_shardBytes) {
+		Entry const & oldest = shard.entries.back();
+		shard.bytes -= oldest.bytes;
+		shard.index.erase(oldest.key);
+		shard.entries.pop_back();
+	}
+	return distance;
+}
+
+// ----------------------------------------------------------------
+//  Name:           shardOf
+//  Description:    Picks the shard a query is kept in.
+//  Arguments:      The query.
+//  Return Value:   The shard.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+typename QueryCache<NodeType, ArcType>::Shard & QueryCache<NodeType, ArcType>::shardOf( Key const & key ) {
+	// the top bits, the hash table uses the bottom ones
+	size_t h = KeyHash()(key);
+	return m_shards[(h >> (sizeof(size_t) * 8 - 16)) % m_shards.size()];
+}
+
+// ----------------------------------------------------------------
+//  Name:           drop
+//  Description:    Empties a shard, the caller holds its lock.
+//  Arguments:      The shard.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+template<class NodeType, class ArcType>
+void QueryCache<NodeType, ArcType>::drop( Shard & shard ) {
+	shard.entries.clear();
+	shard.index.clear();
+	shard.bytes = 0;
+}
+
+#endif
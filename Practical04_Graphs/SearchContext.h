@@ -0,0 +1,149 @@
+#ifndef SEARCHCONTEXT_H
+#define SEARCHCONTEXT_H
+
+#include <limits>
+#include <vector>
+#include "IndexedHeap.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           SearchContext
+//  Description:    Holds the state of a single search, indexed by
+//                  node index, so that the graph itself is left
+//                  untouched and several searches can run against
+//                  one graph at the same time, one context each.
+//                  Each node's state is stamped with the search it
+//                  belongs to, and state stamped by an earlier
+//                  search reads as cleared, so starting a search
+//                  costs nothing however big the graph is and a
+//                  search only pays for the nodes it touches.
+// ----------------------------------------------------------------
+class SearchContext {
+private:
+
+// ----------------------------------------------------------------
+//  Description:    The state of one node. distance is g(n) and
+//                  heuristic h(n), previous is the index of the
+//                  node before it on the search, or -1, and stamp
+//                  is the search that last set any of them.
+// ----------------------------------------------------------------
+    struct State {
+        unsigned stamp;
+        float distance;
+        float heuristic;
+        int previous;
+        bool marked;
+    };
+
+    vector<State> m_states;
+
+// ----------------------------------------------------------------
+//  Description:    The stamp of the current search.
+// ----------------------------------------------------------------
+    unsigned m_epoch;
+
+// ----------------------------------------------------------------
+//  Description:    A queue the searches can share between calls
+//                  rather than allocate one each time.
+// ----------------------------------------------------------------
+    IndexedDaryHeap<4> m_queue;
+
+public:
+    // Constructor functions
+    SearchContext( int size = 0 ) : m_epoch( 0 ) {
+        reset( size );
+    }
+
+    // Accessor functions
+    int size() const {
+        return static_cast<int>(m_states.size());
+    }
+
+    float distance( int node ) const {
+        State const & state = m_states[node];
+        return state.stamp == m_epoch ? state.distance : numeric_limits<float>::infinity();
+    }
+
+    float heuristic( int node ) const {
+        State const & state = m_states[node];
+        return state.stamp == m_epoch ? state.heuristic : 0.0f;
+    }
+
+    float cost( int node ) const {
+        return heuristic( node ) + distance( node );
+    }
+
+    int previous( int node ) const {
+        State const & state = m_states[node];
+        return state.stamp == m_epoch ? state.previous : -1;
+    }
+
+    bool marked( int node ) const {
+        State const & state = m_states[node];
+        return state.stamp == m_epoch && state.marked;
+    }
+
+    IndexedDaryHeap<4>& queue() {
+        return m_queue;
+    }
+
+    // Manipulator functions
+    void setDistance( int node, float dist ) {
+        touch( node ).distance = dist;
+    }
+
+    void setHeuristic( int node, float h ) {
+        touch( node ).heuristic = h;
+    }
+
+    void setPrevious( int node, int prev ) {
+        touch( node ).previous = prev;
+    }
+
+    void setMarked( int node, bool mark ) {
+        touch( node ).marked = mark;
+    }
+
+// ----------------------------------------------------------------
+//  Name:           reset
+//  Description:    Clears the state of every node ready for a new
+//                  search by moving on to a new stamp, and empties
+//                  the queue. The context is only rebuilt if the
+//                  graph has a different number of nodes.
+//  Arguments:      The number of nodes in the graph.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+    void reset( int size ) {
+        m_queue.reset( size );
+        m_epoch++;
+        if (static_cast<int>(m_states.size()) != size || m_epoch == 0) {
+            // a new context, or the stamps have wrapped round
+            State cleared = { 0, numeric_limits<float>::infinity(), 0.0f, -1, false };
+            m_states.assign( size, cleared );
+            m_epoch = 1;
+        }
+    }
+
+private:
+// ----------------------------------------------------------------
+//  Name:           touch
+//  Description:    Clears a node's state left from an earlier
+//                  search before it is first changed in this one.
+//  Arguments:      The node index.
+//  Return Value:   The node's state.
+// ----------------------------------------------------------------
+    State & touch( int node ) {
+        State & state = m_states[node];
+        if (state.stamp != m_epoch) {
+            state.stamp = m_epoch;
+            state.distance = numeric_limits<float>::infinity();
+            state.heuristic = 0.0f;
+            state.previous = -1;
+            state.marked = false;
+        }
+        return state;
+    }
+};
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef SEARCHSTATS_H
+#define SEARCHSTATS_H
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  The searches take an optional stats policy as their last
+//  parameter and tell it what they do as they go:
+//
+//      stats.start()               the search begins
+//      stats.expand()              a node is taken off the open list
+//      stats.scan()                an arc of that node is looked at
+//      stats.relax()               the arc improved its end's distance
+//      stats.queue( open, item )   item is about to be added to the
+//                                  open list, or its key lowered if
+//                                  it is already there
+//      stats.push( size )          an item was added to an open list
+//                                  that is not a priority queue, now
+//                                  holding size items
+//      stats.stop()                the search has finished
+//
+//  NoStats does nothing and is what the searches use when no stats
+//  are given, so every call compiles away. SearchStats records them.
+// ----------------------------------------------------------------
+
+// ----------------------------------------------------------------
+//  Name:           NoStats
+//  Description:    A stats policy that records nothing.
+// ----------------------------------------------------------------
+struct NoStats {
+    void start() {
+    }
+
+    void expand() {
+    }
+
+    void scan() {
+    }
+
+    void relax() {
+    }
+
+    template<class Queue>
+    void queue( Queue const &, int ) {
+    }
+
+    void push( int ) {
+    }
+
+    void stop() {
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           SearchStats
+//  Description:    What a single search did. The open list is the
+//                  priority queue of ucs and aStar, the FIFO queue
+//                  of a breadth first search and the recursion of a
+//                  depth first one, so pushes counts the nodes put
+//                  on it, decreaseKeys the keys lowered in place,
+//                  and peakOpen the most it held at once, not
+//                  counting the node being expanded. Every
+//                  node expanded was popped from it, so pops is the
+//                  same as expanded.
+// ----------------------------------------------------------------
+struct SearchStats {
+    unsigned long long expanded;
+    unsigned long long arcsScanned;
+    unsigned long long arcsRelaxed;
+    unsigned long long pushes;
+    unsigned long long decreaseKeys;
+    int peakOpen;
+    double milliseconds;
+
+    SearchStats() {
+        clear();
+    }
+
+    void clear() {
+        expanded = arcsScanned = arcsRelaxed = pushes = decreaseKeys = 0;
+        peakOpen = 0;
+        milliseconds = 0;
+    }
+
+    unsigned long long pops() const {
+        return expanded;
+    }
+
+    void start() {
+        clear();
+        m_started = chrono::steady_clock::now();
+    }
+
+    void expand() {
+        expanded++;
+    }
+
+    void scan() {
+        arcsScanned++;
+    }
+
+    void relax() {
+        arcsRelaxed++;
+    }
+
+    template<class Queue>
+    void queue( Queue const & open, int item ) {
+        if (open.contains( item )) {
+            decreaseKeys++;
+        }
+        else {
+            push( open.size() + 1 );
+        }
+    }
+
+    void push( int size ) {
+        pushes++;
+        peakOpen = max( peakOpen, size );
+    }
+
+    void stop() {
+        milliseconds = chrono::duration<double, milli>( chrono::steady_clock::now() - m_started ).count();
+    }
+
+private:
+    chrono::steady_clock::time_point m_started;
+};
+
+// ----------------------------------------------------------------
+//  Name:           SearchCounters
+//  Description:    Totals of the stats of many searches, which any
+//                  number of threads may add to at once.
+// ----------------------------------------------------------------
+class SearchCounters {
+private:
+    mutable mutex m_lock;
+    unsigned long long m_queries;
+    SearchStats m_total;
+
+// ----------------------------------------------------------------
+//  Description:    The most any one search expanded, and the
+//                  longest any took.
+// ----------------------------------------------------------------
+    unsigned long long m_maxExpanded;
+    double m_maxMilliseconds;
+
+public:
+    // Constructor functions
+    SearchCounters() {
+        clear();
+    }
+
+    // Accessor functions
+    unsigned long long queries() const {
+        lock_guard<mutex> guard( m_lock );
+        return m_queries;
+    }
+
+    SearchStats total() const {
+        lock_guard<mutex> guard( m_lock );
+        return m_total;
+    }
+
+    string json() const;
+
+    // Manipulator functions
+    void add( SearchStats const & stats );
+    void clear();
+};
+
+// ----------------------------------------------------------------
+//  Name:           add
+//  Description:    Adds the stats of one search to the totals.
+//  Arguments:      The stats.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SearchCounters::add( SearchStats const & stats ) {
+	lock_guard<mutex> guard(m_lock);
+	m_queries++;
+	m_total.expanded += stats.expanded;
+	m_total.arcsScanned += stats.arcsScanned;
+	m_total.arcsRelaxed += stats.arcsRelaxed;
+	m_total.pushes += stats.pushes;
+	m_total.decreaseKeys += stats.decreaseKeys;
+	m_total.peakOpen = max(m_total.peakOpen, stats.peakOpen);
+	m_total.milliseconds += stats.milliseconds;
+	m_maxExpanded = max(m_maxExpanded, stats.expanded);
+	m_maxMilliseconds = max(m_maxMilliseconds, stats.milliseconds);
+}
+
+// ----------------------------------------------------------------
+//  Name:           clear
+//  Description:    Sets every total back to 0.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SearchCounters::clear() {
+	lock_guard<mutex> guard(m_lock);
+	m_queries = 0;
+	m_total.clear();
+	m_maxExpanded = 0;
+	m_maxMilliseconds = 0;
+}
+
+// ----------------------------------------------------------------
+//  Name:           json
+//  Description:    Writes the totals as a JSON object, along with
+//                  the mean and most expanded and time per search.
+//  Arguments:      None.
+//  Return Value:   The JSON text.
+// ----------------------------------------------------------------
+inline string SearchCounters::json() const {
+	lock_guard<mutex> guard(m_lock);
+	double queries = m_queries > 0 ? static_cast<double>(m_queries) : 1.0;
+	ostringstream out;
+	out << "{\"queries\": " << m_queries
+		<< ", \"expanded\": " << m_total.expanded
+		<< ", \"arcsScanned\": " << m_total.arcsScanned
+		<< ", \"arcsRelaxed\": " << m_total.arcsRelaxed
+		<< ", \"pushes\": " << m_total.pushes
+		<< ", \"pops\": " << m_total.pops()
+		<< ", \"decreaseKeys\": " << m_total.decreaseKeys
+		<< ", \"peakOpen\": " << m_total.peakOpen
+		<< ", \"milliseconds\": " << m_total.milliseconds
+		<< ", \"meanExpanded\": " << m_total.expanded / queries
+		<< ", \"meanMilliseconds\": " << m_total.milliseconds / queries
+		<< ", \"maxExpanded\": " << m_maxExpanded
+		<< ", \"maxMilliseconds\": " << m_maxMilliseconds << "}";
+	return out.str();
+}
+
+#endif
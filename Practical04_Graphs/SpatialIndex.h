@@ -0,0 +1,460 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "ArcIndex.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           SpatialIndex
+//  Description:    Finds nodes by position without looking at every
+//                  node. The plane is cut into square cells and each
+//                  node is kept in the bucket of the cell it lies
+//                  in, a list threaded through the nodes' entries so
+//                  a bucket costs no allocation of its own. Only the
+//                  cells that have held nodes have buckets,
+//                  found through a hash table keyed by the cell's
+//                  column and row, so the nodes may be anywhere.
+//                  Nodes are added and removed one at a time, and
+//                  every time the number of nodes doubles the cells
+//                  are resized to hold about two nodes each and the
+//                  buckets rebuilt, which costs no more than the
+//                  additions that led to it.
+// ----------------------------------------------------------------
+class SpatialIndex {
+private:
+
+// ----------------------------------------------------------------
+//  Description:    Where a node is, and where it is kept. bucket is
+//                  -1 for a node that is not in the index, previous
+//                  and next are the nodes either side of it in its
+//                  bucket, or -1 at the ends.
+// ----------------------------------------------------------------
+    struct Entry {
+        float x;
+        float y;
+        int bucket;
+        int previous;
+        int next;
+    };
+
+    vector<Entry> m_entries;
+
+// ----------------------------------------------------------------
+//  Description:    The first node in each bucket, or -1.
+// ----------------------------------------------------------------
+    vector<int> m_buckets;
+
+// ----------------------------------------------------------------
+//  Description:    The bucket of each cell, by shifted column and
+//                  row, see key.
+// ----------------------------------------------------------------
+    ArcIndex<int> m_cells;
+
+    float m_cellSize;
+    int m_count;
+
+// ----------------------------------------------------------------
+//  Description:    The number of nodes when the cells were last
+//                  sized.
+// ----------------------------------------------------------------
+    int m_sizedFor;
+
+// ----------------------------------------------------------------
+//  Description:    The cells that hold nodes lie within these
+//                  columns and rows, and the nodes within these
+//                  bounds. Neither shrinks when nodes are removed.
+// ----------------------------------------------------------------
+    int m_minColumn;
+    int m_maxColumn;
+    int m_minRow;
+    int m_maxRow;
+    float m_minX;
+    float m_maxX;
+    float m_minY;
+    float m_maxY;
+
+// ----------------------------------------------------------------
+//  Description:    Columns and rows are kept to this range so the
+//                  keys can't overflow.
+// ----------------------------------------------------------------
+    static const int LIMIT = 1 << 29;
+
+public:
+    // Constructor functions
+    SpatialIndex( float cellSize = 64 );
+
+    // Accessor functions
+    int size() const {
+        return m_count;
+    }
+
+    float cellSize() const {
+        return m_cellSize;
+    }
+
+    bool contains( int node ) const {
+        return node >= 0 && node < static_cast<int>(m_entries.size()) && m_entries[node].bucket != -1;
+    }
+
+    int nearest( float x, float y ) const;
+    void nearest( float x, float y, int k, vector<int>& nodes ) const;
+    void withinRadius( float x, float y, float radius, vector<int>& nodes ) const;
+    void withinBox( float minX, float minY, float maxX, float maxY, vector<int>& nodes ) const;
+
+    // Manipulator functions
+    void insert( int node, float x, float y );
+    bool erase( int node );
+    void clear();
+
+private:
+    int column( float x ) const;
+    int row( float y ) const;
+    static int key( int columnOrRow ) {
+        // the hash table takes -1 to mark an empty slot
+        return columnOrRow + LIMIT + 1;
+    }
+    void place( int node );
+    void resize();
+    float distance( int node, float x, float y ) const {
+        float dx = m_entries[node].x - x;
+        float dy = m_entries[node].y - y;
+        return dx * dx + dy * dy;
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           SpatialIndex
+//  Description:    Constructor, this makes an empty index.
+//  Arguments:      The size of a cell to start with, until there are
+//                  enough nodes to choose one.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline SpatialIndex::SpatialIndex( float cellSize ) : m_cellSize( cellSize ) {
+	clear();
+}
+
+// ----------------------------------------------------------------
+//  Name:           column
+//  Description:    The column of the cells a position is in.
+//  Arguments:      The x coordinate.
+//  Return Value:   The column.
+// ----------------------------------------------------------------
+inline int SpatialIndex::column( float x ) const {
+	double c = floor(static_cast<double>(x) / m_cellSize);
+	return static_cast<int>(max<double>(-LIMIT, min<double>(LIMIT, c)));
+}
+
+// ----------------------------------------------------------------
+//  Name:           row
+//  Description:    The row of the cells a position is in.
+//  Arguments:      The y coordinate.
+//  Return Value:   The row.
+// ----------------------------------------------------------------
+inline int SpatialIndex::row( float y ) const {
+	double r = floor(static_cast<double>(y) / m_cellSize);
+	return static_cast<int>(max<double>(-LIMIT, min<double>(LIMIT, r)));
+}
+
+// ----------------------------------------------------------------
+//  Name:           insert
+//  Description:    Adds a node, or moves it if it is already there.
+//  Arguments:      The first parameter is the node index
+//                  The second and third parameters are its position.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialIndex::insert( int node, float x, float y ) {
+	erase(node);
+	if (node >= static_cast<int>(m_entries.size())) {
+		Entry absent = { 0, 0, -1, -1, -1 };
+		m_entries.resize(max<size_t>(node + 1, 2 * m_entries.size()), absent);
+	}
+	m_entries[node].x = x;
+	m_entries[node].y = y;
+	m_minX = min(m_minX, x);
+	m_maxX = max(m_maxX, x);
+	m_minY = min(m_minY, y);
+	m_maxY = max(m_maxY, y);
+	m_count++;
+	if (m_count >= 2 * m_sizedFor) {
+		m_entries[node].bucket = 0;
+		resize();
+	}
+	else {
+		place(node);
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           erase
+//  Description:    Removes a node, unlinking it from its bucket.
+//  Arguments:      The node index.
+//  Return Value:   True if the node was in the index.
+// ----------------------------------------------------------------
+inline bool SpatialIndex::erase( int node ) {
+	if (!contains(node))
+		return false;
+	Entry & entry = m_entries[node];
+	if (entry.previous != -1)
+		m_entries[entry.previous].next = entry.next;
+	else
+		m_buckets[entry.bucket] = entry.next;
+	if (entry.next != -1)
+		m_entries[entry.next].previous = entry.previous;
+	entry.bucket = -1;
+	entry.previous = -1;
+	entry.next = -1;
+	m_count--;
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           clear
+//  Description:    Removes every node and gives the memory back.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialIndex::clear() {
+	vector<Entry>().swap(m_entries);
+	vector<int>().swap(m_buckets);
+	m_cells.clear();
+	m_count = 0;
+	m_sizedFor = 0;
+	m_minColumn = m_minRow = numeric_limits<int>::max();
+	m_maxColumn = m_maxRow = numeric_limits<int>::min();
+	m_minX = m_minY = numeric_limits<float>::infinity();
+	m_maxX = m_maxY = -numeric_limits<float>::infinity();
+}
+
+// ----------------------------------------------------------------
+//  Name:           place
+//  Description:    Puts a node in the bucket of its cell, making
+//                  the bucket if the cell has none.
+//  Arguments:      The node index.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialIndex::place( int node ) {
+	Entry & entry = m_entries[node];
+	int c = column(entry.x);
+	int r = row(entry.y);
+	int const * pBucket = m_cells.find(key(c), key(r));
+	if (pBucket == 0) {
+		m_cells.insert(key(c), key(r), static_cast<int>(m_buckets.size()));
+		m_buckets.push_back(-1);
+		pBucket = m_cells.find(key(c), key(r));
+	}
+	m_minColumn = min(m_minColumn, c);
+	m_maxColumn = max(m_maxColumn, c);
+	m_minRow = min(m_minRow, r);
+	m_maxRow = max(m_maxRow, r);
+	entry.bucket = *pBucket;
+	entry.previous = -1;
+	entry.next = m_buckets[*pBucket];
+	if (entry.next != -1)
+		m_entries[entry.next].previous = node;
+	m_buckets[*pBucket] = node;
+}
+
+// ----------------------------------------------------------------
+//  Name:           resize
+//  Description:    Sizes the cells so that nodes spread evenly over
+//                  the bounds would be about two to a cell, and
+//                  puts every node back in the new cells.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialIndex::resize() {
+	float width = m_maxX - m_minX;
+	float height = m_maxY - m_minY;
+	// nodes along a line spread over its length instead
+	float size = width > 0 && height > 0 ? sqrt(2 * width * height / m_count) : 2 * max(width, height) / m_count;
+	if (size > 0 && size < numeric_limits<float>::infinity())
+		m_cellSize = size;
+
+	vector<int>().swap(m_buckets);
+	m_cells.clear();
+	m_cells.reserve(m_count);
+	m_minColumn = m_minRow = numeric_limits<int>::max();
+	m_maxColumn = m_maxRow = numeric_limits<int>::min();
+	for (int node = 0; node < static_cast<int>(m_entries.size()); node++) {
+		if (m_entries[node].bucket != -1)
+			place(node);
+	}
+	m_sizedFor = m_count;
+}
+
+// ----------------------------------------------------------------
+//  Name:           withinBox
+//  Description:    Finds the nodes inside a box, edges included.
+//                  Only the cells the box covers are looked at, or
+//                  every bucket if there are fewer of those.
+//  Arguments:      The first and second parameters are the box's
+//                  lowest corner
+//                  The third and fourth parameters are its highest
+//                  The fifth parameter receives the nodes, in no
+//                  particular order.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialIndex::withinBox( float minX, float minY, float maxX, float maxY, vector<int>& nodes ) const {
+	nodes.clear();
+	int firstColumn = max(column(minX), m_minColumn);
+	int lastColumn = min(column(maxX), m_maxColumn);
+	int firstRow = max(row(minY), m_minRow);
+	int lastRow = min(row(maxY), m_maxRow);
+	if (firstColumn > lastColumn || firstRow > lastRow)
+		return;
+
+	double cells = (static_cast<double>(lastColumn) - firstColumn + 1) * (static_cast<double>(lastRow) - firstRow + 1);
+	if (cells > m_buckets.size()) {
+		for (size_t b = 0; b < m_buckets.size(); b++) {
+			for (int node = m_buckets[b]; node != -1; node = m_entries[node].next) {
+				Entry const & entry = m_entries[node];
+				if (entry.x >= minX && entry.x <= maxX && entry.y >= minY && entry.y <= maxY)
+					nodes.push_back(node);
+			}
+		}
+		return;
+	}
+	for (int c = firstColumn; c <= lastColumn; c++) {
+		for (int r = firstRow; r <= lastRow; r++) {
+			int const * pBucket = m_cells.find(key(c), key(r));
+			if (pBucket == 0)
+				continue;
+			for (int node = m_buckets[*pBucket]; node != -1; node = m_entries[node].next) {
+				Entry const & entry = m_entries[node];
+				if (entry.x >= minX && entry.x <= maxX && entry.y >= minY && entry.y <= maxY)
+					nodes.push_back(node);
+			}
+		}
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           withinRadius
+//  Description:    Finds the nodes no further than a distance from
+//                  a point.
+//  Arguments:      The first and second parameters are the point
+//                  The third parameter is the distance
+//                  The fourth parameter receives the nodes, in no
+//                  particular order.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialIndex::withinRadius( float x, float y, float radius, vector<int>& nodes ) const {
+	withinBox(x - radius, y - radius, x + radius, y + radius, nodes);
+	float limit = radius * radius;
+	size_t kept = 0;
+	for (size_t i = 0; i < nodes.size(); i++) {
+		if (distance(nodes[i], x, y) <= limit)
+			nodes[kept++] = nodes[i];
+	}
+	nodes.resize(kept);
+}
+
+// ----------------------------------------------------------------
+//  Name:           nearest
+//  Description:    Finds the k nodes closest to a point. The cells
+//                  are searched in square rings round the point's
+//                  cell, stopping once no node in a further ring
+//                  could be closer than the k found so far. If the
+//                  rings would look at more cells than there are
+//                  buckets, every bucket is searched instead.
+//  Arguments:      The first and second parameters are the point
+//                  The third parameter is k
+//                  The fourth parameter receives the nodes, closest
+//                  first, ties going to the lower index. There are
+//                  fewer than k if the index holds fewer.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void SpatialIndex::nearest( float x, float y, int k, vector<int>& nodes ) const {
+	nodes.clear();
+	if (k <= 0 || m_count == 0)
+		return;
+
+	// a max heap of the closest nodes found, by distance then index
+	vector<pair<float, int> > best;
+	auto consider = [&]( int node ) {
+		pair<float, int> candidate(distance(node, x, y), node);
+		if (static_cast<int>(best.size()) < k) {
+			best.push_back(candidate);
+			push_heap(best.begin(), best.end());
+		}
+		else if (candidate < best.front()) {
+			pop_heap(best.begin(), best.end());
+			best.back() = candidate;
+			push_heap(best.begin(), best.end());
+		}
+	};
+	auto search = [&]( int c, int r ) {
+		int const * pBucket = m_cells.find(key(c), key(r));
+		if (pBucket != 0) {
+			for (int node = m_buckets[*pBucket]; node != -1; node = m_entries[node].next)
+				consider(node);
+		}
+	};
+
+	int c = column(x);
+	int r = row(y);
+	// no ring before this one reaches an occupied cell, and every
+	// occupied cell is inside the last
+	int firstRing = max(max(0, max(m_minColumn - c, c - m_maxColumn)), max(m_minRow - r, r - m_maxRow));
+	int lastRing = max(max(c - m_minColumn, m_maxColumn - c), max(r - m_minRow, m_maxRow - r));
+	double budget = static_cast<double>(m_buckets.size());
+	bool complete = false;
+	for (int ring = firstRing; ring <= lastRing && !complete; ring++) {
+		// only the part of the ring inside the occupied cells
+		int left = max(c - ring, m_minColumn);
+		int right = min(c + ring, m_maxColumn);
+		int bottom = max(r - ring, m_minRow);
+		int top = min(r + ring, m_maxRow);
+		budget -= (static_cast<double>(right) - left + 1) * 2 + (static_cast<double>(top) - bottom + 1) * 2;
+		if (budget < 0)
+			break;
+		if (r - ring >= m_minRow) {
+			for (int i = left; i <= right; i++)
+				search(i, r - ring);
+		}
+		if (ring > 0 && r + ring <= m_maxRow) {
+			for (int i = left; i <= right; i++)
+				search(i, r + ring);
+		}
+		for (int j = max(bottom, r - ring + 1); j <= min(top, r + ring - 1); j++) {
+			if (c - ring >= m_minColumn)
+				search(c - ring, j);
+			if (ring > 0 && c + ring <= m_maxColumn)
+				search(c + ring, j);
+		}
+		// a node in a further ring is at least ring cells away
+		float reach = ring * m_cellSize;
+		complete = ring == lastRing || (static_cast<int>(best.size()) == k && best.front().first < reach * reach);
+	}
+	if (!complete) {
+		best.clear();
+		for (size_t b = 0; b < m_buckets.size(); b++) {
+			for (int node = m_buckets[b]; node != -1; node = m_entries[node].next)
+				consider(node);
+		}
+	}
+
+	sort_heap(best.begin(), best.end());
+	for (size_t i = 0; i < best.size(); i++)
+		nodes.push_back(best[i].second);
+}
+
+// ----------------------------------------------------------------
+//  Name:           nearest
+//  Description:    Finds the node closest to a point.
+//  Arguments:      The point.
+//  Return Value:   The node index, or -1 if the index is empty.
+// ----------------------------------------------------------------
+inline int SpatialIndex::nearest( float x, float y ) const {
+	vector<int> nodes;
+	nearest(x, y, 1, nodes);
+	return nodes.empty() ? -1 : nodes[0];
+}
+
+#endif
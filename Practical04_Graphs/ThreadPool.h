@@ -0,0 +1,222 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  Name:           ThreadPool
+//  Description:    A fixed set of worker threads that share out the
+//                  index range of a parallel loop. Each worker owns
+//                  a slice of the range and takes small chunks from
+//                  its front, and a worker that runs out steals the
+//                  back half of another worker's slice, so uneven
+//                  work still keeps every thread busy. The calling
+//                  thread takes part as worker 0.
+// ----------------------------------------------------------------
+class ThreadPool {
+private:
+// ----------------------------------------------------------------
+//  Description:    The part of the loop a worker has still to run.
+// ----------------------------------------------------------------
+    struct Range {
+        mutex lock;
+        int begin;
+        int end;
+    };
+
+    vector<thread> m_threads;
+    vector<Range> m_ranges;
+
+// ----------------------------------------------------------------
+//  Description:    The loop being run. m_generation counts the
+//                  loops handed out so the workers can tell a new
+//                  one from the last, m_busy counts the workers
+//                  yet to finish it.
+// ----------------------------------------------------------------
+    function<void(int, int, int)> m_task;
+    int m_grain;
+    int m_generation;
+    int m_busy;
+    bool m_stop;
+
+    mutex m_lock;
+    condition_variable m_wake;
+    condition_variable m_done;
+
+public:
+    ThreadPool( int threads = 0 );
+    ~ThreadPool();
+
+    int workerCount() const {
+        return static_cast<int>(m_ranges.size());
+    }
+
+    void parallelFor( int count, int grain, function<void(int, int, int)> const & task );
+
+private:
+    ThreadPool( ThreadPool const & );
+    ThreadPool & operator=( ThreadPool const & );
+
+    void workerLoop( int worker );
+    void work( int worker );
+    bool steal( int worker );
+};
+
+// ----------------------------------------------------------------
+//  Name:           ThreadPool
+//  Description:    Constructor, this starts the worker threads.
+//  Arguments:      The number of workers including the calling
+//                  thread, or 0 for one per hardware thread.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline ThreadPool::ThreadPool( int threads )
+	: m_ranges( threads > 0 ? threads : max(1u, thread::hardware_concurrency()) ),
+	  m_grain( 1 ), m_generation( 0 ), m_busy( 0 ), m_stop( false ) {
+	for (int i = 1; i < workerCount(); i++) {
+		m_threads.push_back(thread(&ThreadPool::workerLoop, this, i));
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           ~ThreadPool
+//  Description:    Destructor, this stops and joins the workers.
+//  Arguments:      None.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline ThreadPool::~ThreadPool() {
+	{
+		lock_guard<mutex> guard(m_lock);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (size_t i = 0; i < m_threads.size(); i++) {
+		m_threads[i].join();
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           parallelFor
+//  Description:    Runs task over [0, count) in chunks of at most
+//                  grain indices and returns once all have run.
+//                  Only one loop may run on a pool at a time.
+//  Arguments:      The first parameter is the number of indices
+//                  The second parameter is the chunk size
+//                  The third parameter is called with the worker
+//                  number and the begin and end of each chunk.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void ThreadPool::parallelFor( int count, int grain, function<void(int, int, int)> const & task ) {
+	if (count <= 0)
+		return;
+
+	{
+		lock_guard<mutex> guard(m_lock);
+		// start each worker on an equal slice of the range
+		int workers = workerCount();
+		for (int i = 0; i < workers; i++) {
+			m_ranges[i].begin = static_cast<int>(static_cast<long long>(count) * i / workers);
+			m_ranges[i].end = static_cast<int>(static_cast<long long>(count) * (i + 1) / workers);
+		}
+		m_task = task;
+		m_grain = max(1, grain);
+		m_busy = workers - 1;
+		m_generation++;
+	}
+	m_wake.notify_all();
+
+	work(0);
+
+	unique_lock<mutex> lock(m_lock);
+	m_done.wait(lock, [this] { return m_busy == 0; });
+	m_task = nullptr;
+}
+
+// ----------------------------------------------------------------
+//  Name:           workerLoop
+//  Description:    The body of each worker thread, which waits for
+//                  a loop, works on it and reports when it is done.
+//  Arguments:      The worker number.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void ThreadPool::workerLoop( int worker ) {
+	int seen = 0;
+	unique_lock<mutex> lock(m_lock);
+	for (;;) {
+		m_wake.wait(lock, [this, seen] { return m_stop || m_generation != seen; });
+		if (m_stop)
+			return;
+		seen = m_generation;
+
+		lock.unlock();
+		work(worker);
+		lock.lock();
+
+		if (--m_busy == 0)
+			m_done.notify_one();
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           work
+//  Description:    Runs chunks from the worker's own slice, then
+//                  steals until there is nothing left anywhere.
+//  Arguments:      The worker number.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void ThreadPool::work( int worker ) {
+	Range & own = m_ranges[worker];
+	for (;;) {
+		int begin;
+		int end;
+		{
+			lock_guard<mutex> guard(own.lock);
+			begin = own.begin;
+			end = min(own.begin + m_grain, own.end);
+			own.begin = end;
+		}
+		if (begin < end)
+			m_task(worker, begin, end);
+		else if (!steal(worker))
+			return;
+	}
+}
+
+// ----------------------------------------------------------------
+//  Name:           steal
+//  Description:    Moves the back half of the first other worker's
+//                  slice that still has work into this worker's.
+//  Arguments:      The worker number.
+//  Return Value:   True if any work was stolen.
+// ----------------------------------------------------------------
+inline bool ThreadPool::steal( int worker ) {
+	int workers = workerCount();
+	for (int i = 1; i < workers; i++) {
+		Range & victim = m_ranges[(worker + i) % workers];
+		int begin;
+		int end;
+		{
+			lock_guard<mutex> guard(victim.lock);
+			int remaining = victim.end - victim.begin;
+			if (remaining <= 0)
+				continue;
+			end = victim.end;
+			begin = end - (remaining + 1) / 2;
+			victim.end = begin;
+		}
+		Range & own = m_ranges[worker];
+		lock_guard<mutex> guard(own.lock);
+		own.begin = begin;
+		own.end = end;
+		return true;
+	}
+	return false;
+}
+
+#endif
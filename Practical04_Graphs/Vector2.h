@@ -0,0 +1,29 @@
+#ifndef VECTOR2_H
+#define VECTOR2_H
+
+// -------------------------------------------------------
+// Name:        Vector2
+// Description: A plain 2D position, used by the graph so
+//              that it does not depend on any windowing
+//              library.
+// -------------------------------------------------------
+struct Vector2 {
+    float x;
+    float y;
+
+    Vector2() : x( 0 ), y( 0 ) {
+    }
+
+    Vector2( float px, float py ) : x( px ), y( py ) {
+    }
+};
+
+inline Vector2 operator+( Vector2 const & a, Vector2 const & b ) {
+    return Vector2( a.x + b.x, a.y + b.y );
+}
+
+inline Vector2 operator-( Vector2 const & a, Vector2 const & b ) {
+    return Vector2( a.x - b.x, a.y - b.y );
+}
+
+#endif
@@ -2,6 +2,7 @@
 // Headers 
 //////////////////////////////////////////////////////////// 
 #include "stdafx.h" 
+#ifdef _MSC_VER 
 #ifdef _DEBUG 
 #pragma comment(lib,"sfml-graphics-d.lib") 
 #pragma comment(lib,"sfml-audio-d.lib") 
@@ -17,6 +18,7 @@
 #endif 
 #pragma comment(lib,"opengl32.lib") 
 #pragma comment(lib,"glu32.lib") 
+#endif 
 
 #include <iostream>
 #include <fstream>
@@ -25,27 +27,31 @@
 #include <vector>
 
 #include "Graph.h"
+#include "GraphFile.h"
+#include "GraphView.h"
 
 using namespace std;
 
 typedef GraphArc<int, int> Edge;
 typedef GraphNode<string, int> Node;
 
+GraphView<string, int> * g_pView = nullptr;
+
 void visit( Node * pNode ) {
 
-	pNode->setColour(sf::Color::Magenta);
-	cout << "Visiting: " << pNode->data() << endl;
+	g_pView->setColour(pNode, sf::Color::Magenta);
+	cout << "Visiting: " << pNode->data() << '\n';
 }
 
 void printPath(vector<Node *> vec) {
 	for (int i = 0; i < vec.size(); i++)
 	{
-		vec[i]->setColour(sf::Color::Green);
-		cout << "Path: " << vec[i]->data() << endl;
+		g_pView->setColour(vec[i], sf::Color::Green);
+		cout << "Path: " << vec[i]->data() << '\n';
 	}
 }
 
-pair<sf::VertexArray, sf::Text> setupEdges(sf::Vector2f from, sf::Vector2f to, int weight, sf::Font* font)
+pair<sf::VertexArray, sf::Text> setupEdges(Vector2 from, Vector2 to, int weight, sf::Font* font)
 {
 	sf::VertexArray lines(sf::Lines, 2);
 	lines[0].position = sf::Vector2f(from.x + 30, from.y + 30);
@@ -59,25 +65,29 @@ pair<sf::VertexArray, sf::Text> setupEdges(sf::Vector2f from, sf::Vector2f to, i
 }
 
 void initialiseGraph(Graph<string, int> & g, sf::Font * font, vector<pair<sf::VertexArray, sf::Text>> &arcs) {
-	string c = "";
-	int i = 0;
-	float x, y;
-	ifstream myfile;
-	myfile.open("Q1Nodes.txt");
-
-	while (myfile >> c >> x >> y) {
-		g.addNode(c, x+100, y+100, font, i++);
+	// the text files are converted once, after that the binary file is mapped
+	GraphFile file;
+	if (!file.open("Q1.graph")) {
+		GraphFile::convert<int>("Q1Nodes.txt", "Q1Arcs.txt", "Q1.graph");
+		if (!file.open("Q1.graph"))
+			return;
 	}
+	CompactGraph<string, int> compact;
+	file.graph(compact);
 
-	myfile.close();
-	myfile.open("Q1Arcs.txt");
+	for (int i = 0; i < compact.nodeCount(); i++) {
+		Vector2 position = compact.getPosition(i);
+		g.addNode(file.label(i), position.x + 100, position.y + 100, i);
+	}
 
-	int from, to, weight;
-	while (myfile >> from >> to >> weight) {
-		g.addArc(from, to, weight);
-		arcs.push_back(setupEdges(g.nodeArray()[from]->getPosition(), g.nodeArray()[to]->getPosition(), weight, font));
+	for (int from = 0; from < compact.nodeCount(); from++) {
+		for (int arc = compact.arcBegin(from); arc != compact.arcEnd(from); arc++) {
+			int to = compact.target(arc);
+			int weight = compact.weight(arc);
+			g.addArc(from, to, weight);
+			arcs.push_back(setupEdges(g.nodeArray()[from]->getPosition(), g.nodeArray()[to]->getPosition(), weight, font));
+		}
 	}
-	myfile.close();
 }
 
 
@@ -91,8 +101,12 @@ int main(int argc, char *argv[]) {
 	font.loadFromFile("C:\\Windows\\Fonts\\GARA.TTF");
 
 	Graph<string, int> graph(30);
+	// clicks find their node through the position index
+	graph.indexPositions(true);
 	vector<pair<sf::VertexArray, sf::Text>> arcs;
 	initialiseGraph(graph, &font, arcs);
+	GraphView<string, int> view(graph, &font);
+	g_pView = &view;
 	
 	Node * start = nullptr;
 	Node * finish = nullptr;
@@ -100,11 +114,20 @@ int main(int argc, char *argv[]) {
 	bool commenceSearch = false;
 
 	vector<Node *> vec;
+	// the distance between every pair of nodes, one search per node
+	vector<int> nodes;
 	for (int i = 0; i < 30; i++)
 	{
-		for (int j = 0; j < 30; j++)
+		nodes.push_back(i);
+	}
+	vector<float> distances(nodes.size() * nodes.size());
+	graph.distanceTable(nodes, nodes, distances);
+	for (int i = 0; i < nodes.size(); i++)
+	{
+		for (int j = 0; j < nodes.size(); j++)
 		{
-			graph.aStar(graph.nodeArray()[i], graph.nodeArray()[j], visit, vec);
+			cout << graph.nodeArray()[i]->data() << " to " << graph.nodeArray()[j]->data()
+				<< ": " << distances[i * nodes.size() + j] << '\n';
 		}
 	}
 	
@@ -128,6 +151,7 @@ int main(int argc, char *argv[]) {
 				}
 				if (Event.key.code == sf::Keyboard::R) {
 					graph.reset();
+					view.reset();
 				}
 			}
 
@@ -164,7 +188,7 @@ int main(int argc, char *argv[]) {
 			window.draw(arcs[i].second);
 		}
 
-		graph.draw(&window);
+		view.draw(&window);
 
 		// Finally, display rendered frame on screen 
 		window.display();
@@ -10,4 +10,6 @@
 #include "SFML/OpenGL.hpp" 
 
 #include <stdio.h>
-#include <tchar.h>
\ No newline at end of file
+#ifdef _WIN32
+#include <tchar.h>
+#endif
\ No newline at end of file
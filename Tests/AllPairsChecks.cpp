@@ -0,0 +1,53 @@
+#include "AllPairs.h"
+#include "Checks.h"
+
+// ----------------------------------------------------------------
+//  Name:           checkAllPairs
+//  Description:    Builds the blocked Floyd-Warshall tables on
+//                  graphs smaller than, equal to and a few blocks
+//                  past the block size, with and without the pool,
+//                  and checks every distance from a spread of
+//                  sources against ucs, and that each path's arcs
+//                  add up to that distance.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkAllPairs() {
+	int failures = 0;
+	ThreadPool pool(3);
+	int const sizes[] = { 1, 50, 64, 65, 200, 700 };
+	for (int size : sizes) {
+		GeneratedGraph generated = generateGeometric(size, 5, size);
+		Random random(size);
+		int nodes = static_cast<int>(generated.positions.size());
+		CheckGraph graph(nodes);
+		for (int i = 0; i < nodes; i++)
+			graph.addNode(i, generated.positions[i].x, generated.positions[i].y, i);
+		// drop some arcs so not every pair is connected, and stretch others
+		for (size_t a = 0; a < generated.arcs.size(); a++) {
+			if (random.below(5) != 0)
+				graph.addArc(generated.arcs[a].from, generated.arcs[a].to, generated.arcs[a].weight * (1 + random.below(3)));
+		}
+		CheckCompactGraph compact = graph.freeze();
+		AllPairs table(graph, size > 100 ? &pool : 0);
+		CHECK(table.nodeCount() == nodes);
+
+		SearchContext context;
+		vector<int> path;
+		for (int from = 0; from < nodes; from += (nodes > 100 ? 7 : 1)) {
+			compact.ucs(context, from, -1, ignoreNode, path);
+			for (int to = 0; to < nodes; to++) {
+				float expected = context.distance(to);
+				CHECK(sameLength(table.distance(from, to), expected));
+				table.getPath(from, to, path);
+				if (isinf(expected)) {
+					CHECK(path.size() == 1);
+					continue;
+				}
+				CHECK(path.front() == to && path.back() == from);
+				CHECK(sameLength(pathLength(compact, path), expected));
+			}
+		}
+	}
+	return failures;
+}
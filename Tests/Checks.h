@@ -0,0 +1,118 @@
+#ifndef CHECKS_H
+#define CHECKS_H
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "Graph.h"
+#include "GraphGenerators.h"
+
+using namespace std;
+
+// ----------------------------------------------------------------
+//  The checks compare each search and table against plain Dijkstra
+//  (the snapshot's ucs) or brute force on seeded random graphs.
+//  Each check function returns the number of failures it found.
+// ----------------------------------------------------------------
+
+typedef Graph<int, float> CheckGraph;
+typedef CompactGraph<int, float> CheckCompactGraph;
+
+// ----------------------------------------------------------------
+//  Name:           reportFailure
+//  Description:    Writes where a check failed, for the first few
+//                  failures only so a broken search can't flood
+//                  the output.
+//  Arguments:      The first parameter is the source file
+//                  The second parameter is the line
+//                  The third parameter is the failed condition.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void reportFailure( char const * file, int line, char const * condition ) {
+	static int reported = 0;
+	if (reported++ < 20)
+		cerr << file << ":" << line << ": failed " << condition << "\n";
+}
+
+#define CHECK( condition ) \
+	do { if (!(condition)) { failures++; reportFailure(__FILE__, __LINE__, #condition); } } while (false)
+
+// ----------------------------------------------------------------
+//  Name:           sameLength
+//  Description:    Whether two path lengths match, allowing for the
+//                  rounding of summing the arcs in another order.
+//                  Two infinite lengths match.
+//  Arguments:      The two lengths.
+//  Return Value:   True if they match.
+// ----------------------------------------------------------------
+inline bool sameLength( float a, float b ) {
+	if (isinf(a) || isinf(b))
+		return a == b;
+	return fabs(a - b) <= 1e-3f * max(1.0f, max(a, b));
+}
+
+// ----------------------------------------------------------------
+//  Name:           buildGraph
+//  Description:    Loads a generated graph into a Graph, with each
+//                  node's data its index.
+//  Arguments:      The first parameter is the generated graph
+//                  The second parameter receives the graph.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+inline void buildGraph( GeneratedGraph const & generated, CheckGraph& graph ) {
+	for (int i = 0; i < static_cast<int>(generated.positions.size()); i++)
+		graph.addNode(i, generated.positions[i].x, generated.positions[i].y, i);
+	for (size_t a = 0; a < generated.arcs.size(); a++)
+		graph.addArc(generated.arcs[a].from, generated.arcs[a].to, generated.arcs[a].weight);
+}
+
+// ----------------------------------------------------------------
+//  Name:           pathLength
+//  Description:    The length of a path returned from the
+//                  destination back to the start, taking the
+//                  lightest arc between each pair of nodes.
+//  Arguments:      The first parameter is the graph
+//                  The second parameter is the path.
+//  Return Value:   The length, or infinity if the path is empty or
+//                  two consecutive nodes have no arc between them.
+// ----------------------------------------------------------------
+inline float pathLength( CheckCompactGraph const & graph, vector<int> const & path ) {
+	if (path.empty())
+		return numeric_limits<float>::infinity();
+	float length = 0;
+	for (size_t i = path.size() - 1; i > 0; i--) {
+		float lightest = numeric_limits<float>::infinity();
+		for (int arc = graph.arcBegin(path[i]); arc != graph.arcEnd(path[i]); arc++) {
+			if (graph.target(arc) == path[i - 1])
+				lightest = min(lightest, graph.weight(arc));
+		}
+		length += lightest;
+	}
+	return length;
+}
+
+inline void ignoreNode( int ) {
+}
+
+inline void ignoreGraphNode( GraphNode<int, float>* ) {
+}
+
+int checkAllPairs();
+int checkContractionHierarchy();
+int checkDistanceTable();
+int checkEdgeList();
+int checkGraphEdits();
+int checkGraphFile();
+int checkGridGraph();
+int checkHeaps();
+int checkHeuristics();
+int checkIncrementalPlanner();
+int checkLandmarks();
+int checkQueryCache();
+int checkSearchStats();
+int checkSolveBatch();
+int checkSpatialIndex();
+
+#endif
@@ -0,0 +1,84 @@
+#include <cstdio>
+#include "Checks.h"
+#include "ContractionHierarchy.h"
+
+// ----------------------------------------------------------------
+//  Name:           checkContractionHierarchy
+//  Description:    Builds hierarchies on road, grid and geometric
+//                  graphs, the last with arcs dropped and weights
+//                  stretched so the witness searches have real
+//                  choices to make, with and without the pool, and
+//                  once more after a save and load. Each query, and
+//                  each bidirectional ucs and aStar the hierarchy's
+//                  query is built on, must match ucs, and each
+//                  unpacked path's arcs must add up to its length.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkContractionHierarchy() {
+	int failures = 0;
+	ThreadPool pool(3);
+	char const * fileName = "ContractionHierarchyCheck.bin";
+	for (int kind = 0; kind < 4; kind++) {
+		GeneratedGraph generated = kind == 0 ? generateRoad(3000, 5)
+			: kind == 1 ? generateGrid(3000, 0.3f, 2)
+			: kind == 2 ? generateGeometric(3000, 4, 7)
+			: generateRoad(20, 1);
+		Random random(kind + 1);
+		int nodes = static_cast<int>(generated.positions.size());
+		CheckGraph graph(nodes);
+		for (int i = 0; i < nodes; i++)
+			graph.addNode(i, generated.positions[i].x, generated.positions[i].y, i);
+		for (size_t a = 0; a < generated.arcs.size(); a++) {
+			if (kind != 2)
+				graph.addArc(generated.arcs[a].from, generated.arcs[a].to, generated.arcs[a].weight);
+			else if (random.below(4) != 0)
+				graph.addArc(generated.arcs[a].from, generated.arcs[a].to, generated.arcs[a].weight * (1 + random.below(3)));
+		}
+		CheckCompactGraph compact = graph.freeze();
+
+		ContractionHierarchy hierarchy(graph, kind % 2 == 1 ? &pool : 0);
+		CHECK(hierarchy.nodeCount() == nodes);
+		CHECK(hierarchy.save(fileName));
+		ContractionHierarchy loaded;
+		CHECK(loaded.load(fileName));
+		CHECK(loaded.shortcutCount() == hierarchy.shortcutCount());
+
+		SearchContext context, forward, backward;
+		vector<int> path, found;
+		for (int q = 0; q < 300; q++) {
+			int start = random.below(nodes);
+			int dest = q % 50 == 0 ? start : random.below(nodes);
+			compact.ucs(context, start, dest, ignoreNode, path);
+			float expected = context.distance(dest);
+
+			float lengths[3];
+			lengths[0] = (q % 2 == 0 ? hierarchy : loaded).query(forward, backward, start, dest, ignoreNode, found);
+			CHECK(sameLength(lengths[0], expected));
+			if (!isinf(expected)) {
+				CHECK(found.front() == dest && found.back() == start);
+				CHECK(sameLength(pathLength(compact, found), expected));
+			}
+			lengths[1] = compact.bidirectionalUcs(forward, backward, start, dest, ignoreNode, found);
+			lengths[2] = compact.bidirectionalAStar(forward, backward, start, dest, ignoreNode, found);
+			for (int k = 1; k < 3; k++)
+				CHECK(sameLength(lengths[k], expected));
+			if (!isinf(expected)) {
+				CHECK(found.front() == dest && found.back() == start);
+				CHECK(sameLength(pathLength(compact, found), expected));
+			}
+		}
+
+		// the query on the Graph's own nodes
+		vector<GraphNode<int, float>*> nodePath;
+		int dest = nodes - 1;
+		compact.ucs(context, 0, dest, ignoreNode, path);
+		CHECK(sameLength(hierarchy.query(graph, forward, backward, graph.nodeArray()[0], graph.nodeArray()[dest], ignoreNode, nodePath),
+			context.distance(dest)));
+	}
+	remove(fileName);
+
+	ContractionHierarchy missing;
+	CHECK(!missing.load("ContractionHierarchyCheck.missing"));
+	return failures;
+}
@@ -0,0 +1,94 @@
+#include "Checks.h"
+
+// ----------------------------------------------------------------
+//  Name:           sameTable
+//  Description:    Whether every entry of a distance table matches
+//                  the distance ucs finds between its source and
+//                  target.
+//  Arguments:      The first parameter is the graph
+//                  The second parameter is the source indices
+//                  The third parameter is the target indices
+//                  The fourth parameter is the table, row i holding
+//                  the distances from sources[i].
+//  Return Value:   The number of entries that don't match.
+// ----------------------------------------------------------------
+static int sameTable( CheckCompactGraph const & graph, vector<int> const & sources, vector<int> const & targets, vector<float> const & table ) {
+	if (table.size() != sources.size() * targets.size())
+		return 1;
+	int wrong = 0;
+	SearchContext context;
+	vector<int> path;
+	for (size_t i = 0; i < sources.size(); i++) {
+		for (size_t j = 0; j < targets.size(); j++) {
+			graph.ucs(context, sources[i], targets[j], ignoreNode, path);
+			if (!sameLength(table[i * targets.size() + j], context.distance(targets[j])))
+				wrong++;
+		}
+	}
+	return wrong;
+}
+
+// ----------------------------------------------------------------
+//  Name:           checkDistanceTable
+//  Description:    Checks every entry of oneToMany and distanceTable,
+//                  and of the Graph::distanceTable wrapper, against
+//                  ucs, with fewer sources than targets and more, so
+//                  both the forward and the backward searches run,
+//                  on one worker and several. The grids leave some
+//                  targets unreachable, and one source is also a
+//                  target.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkDistanceTable() {
+	int failures = 0;
+	for (int kind = 0; kind < 2; kind++) {
+		GeneratedGraph generated = kind == 0 ? generateRoad(3000, 12) : generateGrid(3000, 0.3f, 13);
+		int nodes = static_cast<int>(generated.positions.size());
+		CheckGraph graph(nodes);
+		buildGraph(generated, graph);
+		CheckCompactGraph compact = graph.freeze();
+
+		Random random(kind + 21);
+		vector<int> sources, targets;
+		for (int i = 0; i < 12; i++)
+			sources.push_back(random.below(nodes));
+		for (int i = 0; i < 30; i++)
+			targets.push_back(random.below(nodes));
+		targets[3] = sources[0];
+
+		SearchContext context;
+		vector<float> distances;
+		for (size_t i = 0; i < sources.size(); i++) {
+			compact.oneToMany(context, sources[i], targets, distances);
+			CHECK(sameTable(compact, vector<int>(1, sources[i]), targets, distances) == 0);
+		}
+		compact.oneToMany(context, sources[0], vector<int>(), distances);
+		CHECK(distances.empty());
+
+		int unreachable = 0;
+		for (int workers = 1; workers <= 3; workers += 2) {
+			ThreadPool pool(workers);
+			vector<float> table;
+			// searches forwards from the sources, then backwards from the targets
+			compact.distanceTable(sources, targets, table, pool);
+			CHECK(sameTable(compact, sources, targets, table) == 0);
+			CHECK(table.size() > 3 && table[3] == 0);
+			unreachable += static_cast<int>(count(table.begin(), table.end(), numeric_limits<float>::infinity()));
+			compact.distanceTable(targets, sources, table, pool);
+			CHECK(sameTable(compact, targets, sources, table) == 0);
+			CHECK(table.size() > 3 * sources.size() && table[3 * sources.size()] == 0);
+			compact.distanceTable(sources, vector<int>(), table, pool);
+			CHECK(table.empty());
+		}
+		if (kind == 1)
+			CHECK(unreachable > 0);
+
+		vector<float> table;
+		graph.distanceTable(sources, targets, table);
+		CHECK(sameTable(compact, sources, targets, table) == 0);
+		graph.distanceTable(targets, sources, table);
+		CHECK(sameTable(compact, targets, sources, table) == 0);
+	}
+	return failures;
+}
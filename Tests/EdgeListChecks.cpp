@@ -0,0 +1,78 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "Checks.h"
+#include "EdgeList.h"
+
+// ----------------------------------------------------------------
+//  Name:           importText
+//  Description:    Writes text to a file and imports it as an arc
+//                  list.
+//  Arguments:      The first parameter is the text
+//                  The second parameter receives the graph
+//                  The third parameter is the pool, or 0
+//                  The fourth parameter is the most nodes the arcs
+//                  may name.
+//  Return Value:   True if the import succeeded.
+// ----------------------------------------------------------------
+static bool importText( string const & text, CheckCompactGraph& graph, ThreadPool * pPool = 0,
+                        int maxNodes = EdgeList<float>::DEFAULT_MAX_NODES ) {
+	char const * fileName = "EdgeListCheck.txt";
+	{
+		ofstream file(fileName, ios::binary);
+		file << text;
+	}
+	vector<Vector2> positions;
+	bool imported = EdgeList<float>::import(fileName, positions, graph, pPool, maxNodes);
+	remove(fileName);
+	return imported;
+}
+
+// ----------------------------------------------------------------
+//  Name:           checkEdgeList
+//  Description:    Checks that arc lists with tabs, carriage
+//                  returns, blank lines and no final line end are
+//                  read, that a large list read in chunks on the
+//                  pool matches the arcs written, and that lines
+//                  with too few or too many numbers, negative or
+//                  huge node indices, or nodes past the caller's
+//                  limit are rejected.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkEdgeList() {
+	int failures = 0;
+	CheckCompactGraph graph;
+
+	CHECK(importText("0 1 2.5\r\n1\t2 3\n\n  2 0 1  \n0 1 9", graph));
+	CHECK(graph.nodeCount() == 3 && graph.arcCount() == 3);
+	CHECK(graph.arcEnd(0) - graph.arcBegin(0) == 1 && graph.weight(graph.arcBegin(0)) == 2.5f);
+	CHECK(importText("", graph) && graph.nodeCount() == 0);
+
+	// a list long enough to be cut into many chunks
+	GeneratedGraph generated = generateRoad(20000, 9);
+	ostringstream text;
+	for (size_t a = 0; a < generated.arcs.size(); a++)
+		text << generated.arcs[a].from << (a % 2 == 0 ? " " : "\t") << generated.arcs[a].to << " " << generated.arcs[a].weight << "\n";
+	ThreadPool pool(3);
+	CHECK(importText(text.str(), graph, &pool));
+	CHECK(graph.arcCount() == static_cast<int>(generated.arcs.size()));
+	vector<int> next(graph.nodeCount() + 1, 0);
+	for (int node = 0; node < graph.nodeCount(); node++)
+		next[node] = graph.arcBegin(node);
+	for (size_t a = 0; a < generated.arcs.size(); a++) {
+		int arc = next[generated.arcs[a].from]++;
+		CHECK(graph.target(arc) == generated.arcs[a].to);
+	}
+
+	CHECK(!importText("0 1\n2 3 4 5\n6 7 8\n", graph));
+	CHECK(!importText("0 1 2 3\n", graph));
+	CHECK(!importText("0 1 x\n", graph));
+	CHECK(!importText("0 -1 1\n", graph));
+	CHECK(!importText("2147483647 0 1\n", graph));
+	CHECK(!importText("0 2147483648 1\n", graph));
+	CHECK(!importText("0 2000000000 1\n", graph));
+	CHECK(!importText("0 5 1\n", graph, 0, 5));
+	CHECK(importText("0 4 1\n", graph, 0, 5) && graph.nodeCount() == 5);
+	return failures;
+}
@@ -0,0 +1,174 @@
+#include <set>
+#include <type_traits>
+#include "Checks.h"
+
+typedef GraphNode<int, float> EditNode;
+
+// ----------------------------------------------------------------
+//  Whether code outside the graph can add or remove a node's arcs,
+//  or change its source list, which would leave the source lists
+//  and the arc index out of step with the arcs.
+// ----------------------------------------------------------------
+template<class Node, class = void>
+struct CanAddArc : false_type {
+};
+
+template<class Node>
+struct CanAddArc<Node, void_t<decltype(declval<Node&>().addArc( declval<Node*>(), 1.0f ))> > : true_type {
+};
+
+template<class Node, class = void>
+struct CanRemoveArc : false_type {
+};
+
+template<class Node>
+struct CanRemoveArc<Node, void_t<decltype(declval<Node&>().removeArc( declval<typename Node::ArcList::iterator>() ))> > : true_type {
+};
+
+template<class Node, class = void>
+struct CanRemoveArcTo : false_type {
+};
+
+template<class Node>
+struct CanRemoveArcTo<Node, void_t<decltype(declval<Node&>().removeArc( declval<Node*>() ))> > : true_type {
+};
+
+template<class Node, class = void>
+struct CanEditSources : false_type {
+};
+
+template<class Node>
+struct CanEditSources<Node, void_t<decltype(declval<Node&>().addSource( declval<Node*>(), declval<typename Node::ArcList::iterator>() )),
+	decltype(declval<Node&>().removeSource( declval<typename Node::ArcList::value_type const &>() ))> > : true_type {
+};
+
+static_assert(!CanAddArc<EditNode>::value && !CanRemoveArc<EditNode>::value && !CanRemoveArcTo<EditNode>::value
+	&& !CanEditSources<EditNode>::value, "only the graph may change a node's arcs");
+
+// ----------------------------------------------------------------
+//  Name:           sourcesMatch
+//  Description:    Whether every node's source list names exactly
+//                  the arcs into it, each arc knowing its slot.
+//  Arguments:      The graph.
+//  Return Value:   True if the lists are right.
+// ----------------------------------------------------------------
+static bool sourcesMatch( CheckGraph& graph ) {
+	vector<int> inDegree(graph.maxNodes(), 0);
+	for (GraphNode<int, float>* pNode : graph.nodes()) {
+		for (GraphArc<int, float> const & arc : pNode->arcList())
+			inDegree[arc.node()->index()]++;
+	}
+	for (GraphNode<int, float>* pNode : graph.nodes()) {
+		if (static_cast<int>(pNode->sources().size()) != inDegree[pNode->index()])
+			return false;
+		for (size_t slot = 0; slot < pNode->sources().size(); slot++) {
+			GraphArc<int, float> const & arc = *pNode->sourceArcs()[slot];
+			if (arc.node() != pNode || arc.sourceSlot() != static_cast<int>(slot)
+				|| pNode->sources()[slot]->getArc(pNode) != &arc)
+				return false;
+		}
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------
+//  Name:           checkGraphEdits
+//  Description:    Checks that the graph's generation moves on when
+//                  an arc is removed or reweighted, and stays put
+//                  when there was no arc, with and without the arc
+//                  index, so a query cache is only flushed by real
+//                  changes.
+//                  Then adds and removes random arcs and nodes and
+//                  checks the source lists, and the arcs getArc and
+//                  addArc find through the arc index, against the
+//                  arcs that should be there. Nodes can't change
+//                  their own arcs, see the static asserts above, so
+//                  removing an arc and then its target through the
+//                  graph leaves nothing dangling.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkGraphEdits() {
+	int failures = 0;
+	for (int indexed = 0; indexed < 2; indexed++) {
+		CheckGraph graph;
+		graph.indexArcs(indexed == 1);
+		for (int i = 0; i < 4; i++)
+			graph.addNode(i, static_cast<float>(i), 0, i);
+		graph.addArc(0, 1, 1);
+		graph.addArc(1, 2, 1);
+
+		unsigned long long generation = graph.generation();
+		graph.removeArc(1, 0);
+		graph.removeArc(0, 3);
+		graph.removeArc(0, 9);
+		CHECK(graph.generation() == generation);
+		graph.removeArc(0, 1);
+		CHECK(graph.generation() != generation);
+		CHECK(graph.getArc(0, 1) == 0 && graph.getArc(1, 2) != 0);
+		generation = graph.generation();
+		graph.removeArc(0, 1);
+		CHECK(!graph.setWeight(0, 1, 2));
+		CHECK(graph.generation() == generation);
+		CHECK(graph.setWeight(1, 2, 2) && graph.getArc(1, 2)->weight() == 2);
+		CHECK(graph.generation() != generation);
+	}
+
+	for (int indexed = 0; indexed < 2; indexed++) {
+		CheckGraph graph;
+		graph.indexArcs(indexed == 1);
+		for (int i = 0; i < 3; i++)
+			graph.addNode(i, 0, 0, i);
+		graph.addArc(0, 1, 1);
+		graph.addArc(2, 1, 1);
+		graph.removeArc(0, 1);
+		CHECK(sourcesMatch(graph) && graph.nodeArray()[1]->sources().size() == 1);
+		graph.removeNode(1);
+		CHECK(sourcesMatch(graph) && graph.getArc(2, 1) == 0 && graph.nodeArray()[2]->arcList().empty());
+	}
+
+	Random random(5);
+	for (int indexed = 0; indexed < 2; indexed++) {
+		CheckGraph graph;
+		graph.indexArcs(indexed == 1);
+		vector<NodeHandle> handles;
+		set<pair<int, int> > arcs;
+		for (int i = 0; i < 60; i++)
+			handles.push_back(graph.addNode(i, 0, 0));
+		for (int round = 0; round < 40; round++) {
+			for (int edit = 0; edit < 100; edit++) {
+				int from = random.below(graph.maxNodes());
+				// half the arcs go to a few hubs, so some nodes have many sources
+				int to = random.below(2) == 0 ? random.below(3) : random.below(graph.maxNodes());
+				if (random.below(3) == 0) {
+					graph.removeArc(from, to);
+					arcs.erase(make_pair(from, to));
+				}
+				else {
+					bool present = graph.nodeArray()[from] == 0 || graph.nodeArray()[to] == 0 || arcs.count(make_pair(from, to)) != 0;
+					// an arc that is already there is turned away
+					CHECK(graph.addArc(from, to, 1) == !present);
+					if (!present)
+						arcs.insert(make_pair(from, to));
+				}
+			}
+			NodeHandle removed = handles[random.below(static_cast<int>(handles.size()))];
+			if (graph.removeNode(removed)) {
+				for (set<pair<int, int> >::iterator iter = arcs.begin(); iter != arcs.end(); ) {
+					if (iter->first == removed.index || iter->second == removed.index)
+						iter = arcs.erase(iter);
+					else
+						++iter;
+				}
+			}
+			handles.push_back(graph.addNode(round, 0, 0));
+			CHECK(sourcesMatch(graph));
+			// every arc the graph finds, with the index or without, is one it still has
+			for (int from = 0; from < graph.maxNodes(); from++) {
+				for (int to = 0; to < graph.maxNodes(); to++)
+					CHECK((graph.getArc(from, to) != 0) == (arcs.count(make_pair(from, to)) != 0));
+			}
+		}
+	}
+	return failures;
+}
@@ -0,0 +1,119 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include "Checks.h"
+#include "GraphFile.h"
+
+// ----------------------------------------------------------------
+//  Name:           arrayStart
+//  Description:    Where an array starts in a graph file, following
+//                  the layout documented with GraphFile: a 32 byte
+//                  header, then each array on an 8 byte boundary.
+//  Arguments:      The first parameter is the number of the array,
+//                  0 for xs up to 9 for labels
+//                  The second parameter is the number of nodes
+//                  The third parameter is the number of arcs.
+//  Return Value:   The offset of the array in the file.
+// ----------------------------------------------------------------
+static size_t arrayStart( int array, size_t nodes, size_t arcs ) {
+	size_t const sizes[9] = { 4 * nodes, 4 * nodes, 4 * (nodes + 1), 4 * arcs, 4 * arcs,
+	                          4 * (nodes + 1), 4 * arcs, 4 * arcs, 4 * (nodes + 1) };
+	size_t at = 32;
+	for (int i = 0; i < array; i++)
+		at = (at + 7) / 8 * 8 + sizes[i];
+	return (at + 7) / 8 * 8;
+}
+
+// ----------------------------------------------------------------
+//  Name:           opensWith
+//  Description:    Writes a copy of a graph file with one 32 bit
+//                  value changed, and opens it.
+//  Arguments:      The first parameter is the original file's bytes
+//                  The second parameter is where the value is
+//                  The third parameter is the new value.
+//  Return Value:   True if the changed file opened.
+// ----------------------------------------------------------------
+static bool opensWith( string const & bytes, size_t at, int32_t value ) {
+	string changed = bytes;
+	memcpy(&changed[at], &value, sizeof(value));
+	char const * fileName = "GraphFileCheck.changed.graph";
+	{
+		ofstream file(fileName, ios::binary);
+		file.write(changed.data(), changed.size());
+	}
+	GraphFile graphFile;
+	bool opened = graphFile.open(fileName);
+	graphFile = GraphFile();
+	remove(fileName);
+	return opened;
+}
+
+// ----------------------------------------------------------------
+//  Name:           checkGraphFile
+//  Description:    Writes a graph file and checks it opens to the
+//                  same arcs, labels and search results, then that
+//                  open rejects copies with falling offsets, a
+//                  target or source that is not a node, or a label
+//                  that starts or ends outside the label bytes.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkGraphFile() {
+	int failures = 0;
+	GeneratedGraph generated = generateRoad(400, 3);
+	int nodes = static_cast<int>(generated.positions.size());
+	CheckGraph graph(nodes);
+	buildGraph(generated, graph);
+	CheckCompactGraph compact = graph.freeze();
+	int arcs = compact.arcCount();
+	vector<string> labels(nodes);
+	for (int i = 0; i < nodes; i++)
+		labels[i] = "n" + to_string(i);
+
+	char const * fileName = "GraphFileCheck.graph";
+	CHECK(GraphFile::write(fileName, compact, labels));
+	string bytes;
+	{
+		ifstream file(fileName, ios::binary);
+		bytes.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+	}
+	{
+		GraphFile graphFile;
+		CHECK(graphFile.open(fileName));
+		CHECK(graphFile.nodeCount() == nodes && graphFile.arcCount() == arcs);
+		CheckCompactGraph mapped;
+		CHECK(graphFile.graph(mapped));
+		for (int i = 0; i < nodes; i++)
+			CHECK(labels[i] == graphFile.label(i));
+		SearchContext context, mappedContext;
+		vector<int> path, mappedPath;
+		Random random(1);
+		for (int q = 0; q < 50; q++) {
+			int start = random.below(nodes);
+			int dest = random.below(nodes);
+			compact.aStar(context, start, dest, ignoreNode, path);
+			mapped.aStar(mappedContext, start, dest, ignoreNode, mappedPath);
+			CHECK(context.distance(dest) == mappedContext.distance(dest) && path == mappedPath);
+		}
+	}
+	remove(fileName);
+
+	CHECK(opensWith(bytes, 0, static_cast<int32_t>(0x52474650)));
+	size_t offsets = arrayStart(2, nodes, arcs);
+	size_t targets = arrayStart(3, nodes, arcs);
+	size_t reverseOffsets = arrayStart(5, nodes, arcs);
+	size_t reverseSources = arrayStart(6, nodes, arcs);
+	size_t labelOffsets = arrayStart(8, nodes, arcs);
+	size_t labelBytes = bytes.size() - arrayStart(9, nodes, arcs);
+	// an offset past the next one, and one before the previous one
+	CHECK(!opensWith(bytes, offsets + 4 * 5, arcs));
+	CHECK(!opensWith(bytes, offsets + 4 * (nodes - 1), 0));
+	CHECK(!opensWith(bytes, reverseOffsets + 4 * 5, arcs));
+	CHECK(!opensWith(bytes, targets + 4 * 7, nodes));
+	CHECK(!opensWith(bytes, targets, -1));
+	CHECK(!opensWith(bytes, reverseSources + 4 * (arcs - 1), nodes));
+	CHECK(!opensWith(bytes, labelOffsets + 4 * 3, static_cast<int32_t>(labelBytes)));
+	// a label that never ends
+	CHECK(!opensWith(bytes, bytes.size() - 4, 0x41414141));
+	return failures;
+}
@@ -0,0 +1,115 @@
+#include "Checks.h"
+#include "GridGraph.h"
+
+// ----------------------------------------------------------------
+//  Name:           compareWithUcs
+//  Description:    Runs A*, jps and jpsPlus between random cells of
+//                  a grid and checks each against ucs on a compact
+//                  graph with an arc for every move the grid allows.
+//                  Each path must step between neighbouring open
+//                  cells and add up to the ucs distance.
+//  Arguments:      The first parameter is the grid
+//                  The second parameter is the random generator
+//                  The third parameter is the number of queries.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+static int compareWithUcs( GridGraph const & grid, Random& random, int queries ) {
+	int failures = 0;
+	int width = grid.width();
+	int cells = grid.nodeCount();
+	vector<Vector2> positions(cells);
+	vector<int> offsets(cells + 1);
+	vector<int> targets;
+	vector<float> weights;
+	for (int i = 0; i < cells; i++) {
+		positions[i] = grid.getPosition(i);
+		offsets[i] = static_cast<int>(targets.size());
+		int x = i % width;
+		int y = i / width;
+		if (grid.blocked(x, y))
+			continue;
+		for (int dy = -1; dy <= 1; dy++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				if ((dx != 0 || dy != 0) && !grid.blocked(x + dx, y + dy)) {
+					targets.push_back(grid.index(x + dx, y + dy));
+					weights.push_back(dx != 0 && dy != 0 ? 1.41421356f : 1.0f);
+				}
+			}
+		}
+	}
+	offsets[cells] = static_cast<int>(targets.size());
+	CheckCompactGraph reference(positions, offsets, targets, weights);
+
+	SearchContext context;
+	vector<int> path;
+	for (int q = 0; q < queries; q++) {
+		int start = random.below(cells);
+		int dest = random.below(cells);
+		reference.ucs(context, start, dest, ignoreNode, path);
+		float expected = grid.blocked(start % width, start / width) ? numeric_limits<float>::infinity() : context.distance(dest);
+		for (int search = 0; search < 3; search++) {
+			if (search == 0)
+				grid.aStar(context, start, dest, ignoreNode, path);
+			else if (search == 1)
+				grid.jps(context, start, dest, ignoreNode, path);
+			else
+				grid.jpsPlus(context, start, dest, ignoreNode, path);
+			CHECK(sameLength(context.distance(dest), expected));
+			if (isinf(expected) || path.empty())
+				continue;
+			CHECK(path.front() == dest && path.back() == start);
+			float length = 0;
+			for (size_t i = 1; i < path.size(); i++) {
+				int dx = abs(path[i - 1] % width - path[i] % width);
+				int dy = abs(path[i - 1] / width - path[i] / width);
+				CHECK(dx <= 1 && dy <= 1 && dx + dy > 0);
+				CHECK(!grid.blocked(path[i] % width, path[i] / width));
+				length += dx != 0 && dy != 0 ? 1.41421356f : 1.0f;
+			}
+			CHECK(sameLength(length, expected));
+		}
+	}
+	return failures;
+}
+
+// ----------------------------------------------------------------
+//  Name:           checkGridGraph
+//  Description:    Checks A*, jps and jpsPlus against ucs on random
+//                  grids from 1 by 1 to 40 by 40 with up to half
+//                  the cells blocked, which exercises the forced
+//                  neighbour rules and the JPS+ table at the grid's
+//                  edges and around single blocked cells. Each grid
+//                  then has some cells toggled, which must drop the
+//                  table, and is checked again once it is rebuilt.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkGridGraph() {
+	int failures = 0;
+	Random random(11);
+	for (int trial = 0; trial < 300; trial++) {
+		int width = 1 + random.below(40);
+		int height = 1 + random.below(40);
+		float density = random.below(50) / 100.0f;
+		GridGraph grid(width, height);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				if (random.uniform() < density)
+					grid.setBlocked(x, y, true);
+			}
+		}
+		CHECK(grid.preprocess());
+		failures += compareWithUcs(grid, random, 30);
+
+		for (int k = 0; k < 5; k++) {
+			int x = random.below(width);
+			int y = random.below(height);
+			grid.setBlocked(x, y, !grid.blocked(x, y));
+		}
+		CHECK(!grid.preprocessed());
+		failures += compareWithUcs(grid, random, 5);
+		CHECK(grid.preprocess());
+		failures += compareWithUcs(grid, random, 5);
+	}
+	return failures;
+}
@@ -0,0 +1,136 @@
+#include <set>
+#include "Checks.h"
+
+// ----------------------------------------------------------------
+//  Name:           heapFailures
+//  Description:    Runs random pushes, decrease-keys and pops on a
+//                  queue alongside a sorted set of the same items,
+//                  checking each pop takes a smallest key, then
+//                  resets the queue and does it again, sometimes
+//                  with the same capacity and sometimes another.
+//                  Keys are whole numbers so there are many ties,
+//                  and popped items are pushed again.
+//  Arguments:      The first parameter is the queue
+//                  The second parameter is the random seed.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+template<class Queue>
+static int heapFailures( Queue& queue, uint64_t seed ) {
+	int failures = 0;
+	Random random(seed);
+	for (int run = 0; run < 20; run++) {
+		int capacity = run % 3 == 0 ? 50 + random.below(200) : 200;
+		queue.reset(capacity);
+		CHECK(queue.empty() && queue.size() == 0);
+		for (int item = 0; item < capacity; item++)
+			CHECK(!queue.contains(item));
+
+		vector<float> keys(capacity);
+		set<pair<float, int> > waiting;
+		for (int op = 0; op < 2000; op++) {
+			int item = random.below(capacity);
+			int choice = random.below(3);
+			if (choice == 0 && waiting.empty())
+				choice = 1;
+			if (choice == 0) {
+				float key = queue.topKey();
+				int top = queue.pop();
+				CHECK(key == waiting.begin()->first && keys[top] == key);
+				CHECK(!queue.contains(top));
+				waiting.erase(make_pair(keys[top], top));
+			}
+			else if (!queue.contains(item)) {
+				keys[item] = static_cast<float>(random.below(100));
+				queue.push(item, keys[item]);
+				waiting.insert(make_pair(keys[item], item));
+			}
+			else {
+				waiting.erase(make_pair(keys[item], item));
+				keys[item] -= static_cast<float>(1 + random.below(10));
+				if (choice == 1)
+					queue.decreaseKey(item, keys[item]);
+				else
+					queue.pushOrDecrease(item, keys[item]);
+				waiting.insert(make_pair(keys[item], item));
+			}
+			CHECK(queue.size() == static_cast<int>(waiting.size()));
+			CHECK(queue.empty() == waiting.empty());
+		}
+		// leave some items waiting half the time, for reset to clear
+		while (run % 2 == 0 && !queue.empty()) {
+			int top = queue.pop();
+			CHECK(keys[top] == waiting.begin()->first);
+			waiting.erase(make_pair(keys[top], top));
+		}
+		CHECK(run % 2 != 0 || waiting.empty());
+	}
+	return failures;
+}
+
+// ----------------------------------------------------------------
+//  Name:           searchFailures
+//  Description:    Checks ucs and aStar given a queue find the same
+//                  distances as with the context's IndexedDaryHeap,
+//                  and paths of that length where there is one,
+//                  reusing the queue from one search to the next.
+//  Arguments:      The first parameter is the graph
+//                  The second parameter is the queue
+//                  The third parameter is the random seed.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+template<class Queue>
+static int searchFailures( CheckCompactGraph const & graph, Queue& queue, uint64_t seed ) {
+	int failures = 0;
+	Random random(seed);
+	SearchContext context;
+	NoStats stats;
+	EuclideanArrayHeuristic heuristic(graph.xs(), graph.ys());
+	vector<int> path;
+	for (int q = 0; q < 100; q++) {
+		int start = random.below(graph.nodeCount());
+		int dest = random.below(graph.nodeCount());
+		graph.ucs(context, start, dest, ignoreNode, path);
+		float expected = context.distance(dest);
+		graph.ucs(context, queue, start, dest, ignoreNode, path, stats);
+		CHECK(sameLength(context.distance(dest), expected));
+		CHECK(isinf(expected) || sameLength(pathLength(graph, path), expected));
+		graph.aStar(context, queue, heuristic, start, dest, ignoreNode, path, stats);
+		CHECK(sameLength(context.distance(dest), expected));
+		CHECK(isinf(expected) || sameLength(pathLength(graph, path), expected));
+	}
+	return failures;
+}
+
+// ----------------------------------------------------------------
+//  Name:           checkHeaps
+//  Description:    Checks each queue against a sorted reference on
+//                  random operations, and ucs and aStar run with
+//                  PairingHeap and LazyHeap against the default
+//                  IndexedDaryHeap<4>, on a road graph and a grid
+//                  where some queries have no path.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkHeaps() {
+	int failures = 0;
+	IndexedDaryHeap<4> daryHeap;
+	IndexedDaryHeap<2> binaryHeap;
+	PairingHeap pairingHeap;
+	LazyHeap lazyHeap;
+	failures += heapFailures(daryHeap, 31);
+	failures += heapFailures(binaryHeap, 32);
+	failures += heapFailures(pairingHeap, 33);
+	failures += heapFailures(lazyHeap, 34);
+
+	for (int kind = 0; kind < 2; kind++) {
+		GeneratedGraph generated = kind == 0 ? generateRoad(3000, 35) : generateGrid(3000, 0.3f, 36);
+		CheckGraph graph(static_cast<int>(generated.positions.size()));
+		buildGraph(generated, graph);
+		CheckCompactGraph compact = graph.freeze();
+		PairingHeap pairingQueue(compact.nodeCount());
+		LazyHeap lazyQueue(compact.nodeCount());
+		failures += searchFailures(compact, pairingQueue, kind + 37);
+		failures += searchFailures(compact, lazyQueue, kind + 37);
+	}
+	return failures;
+}
@@ -0,0 +1,64 @@
+#include <cstdint>
+#include <cstring>
+#include "Checks.h"
+
+// ----------------------------------------------------------------
+//  Name:           ulps
+//  Description:    How many floats apart two non-negative floats
+//                  are.
+//  Arguments:      The two floats.
+//  Return Value:   The number of representable steps between them.
+// ----------------------------------------------------------------
+static int64_t ulps( float a, float b ) {
+	int32_t bitsA, bitsB;
+	memcpy(&bitsA, &a, sizeof(a));
+	memcpy(&bitsB, &b, sizeof(b));
+	return bitsA > bitsB ? static_cast<int64_t>(bitsA) - bitsB : static_cast<int64_t>(bitsB) - bitsA;
+}
+
+// ----------------------------------------------------------------
+//  Name:           checkHeuristics
+//  Description:    Checks euclideanDistances, through both its
+//                  SIMD and scalar loops, against the scalar
+//                  EuclideanArrayHeuristic for every count from 0 to
+//                  17, so every mix of eight, four and single lanes
+//                  is run. The answers may differ in the last bit
+//                  or so, see euclideanDistances. Nothing past the
+//                  count may be written.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkHeuristics() {
+	int failures = 0;
+	Random random(61);
+	int points = 100;
+	vector<float> xs(points), ys(points);
+	for (int i = 0; i < points; i++) {
+		// a spread of magnitudes, and a few points on top of each other
+		float scale = i % 3 == 0 ? 1.0f : (i % 3 == 1 ? 1000.0f : 1e6f);
+		xs[i] = i % 10 == 0 ? 0.0f : (random.uniform() - 0.5f) * scale;
+		ys[i] = i % 10 == 0 ? 0.0f : (random.uniform() - 0.5f) * scale;
+	}
+	EuclideanArrayHeuristic heuristic(xs.data(), ys.data());
+	CHECK(HasBatch<EuclideanArrayHeuristic>::value);
+
+	for (int run = 0; run < 50; run++) {
+		int dest = random.below(points);
+		for (int count = 0; count <= 17; count++) {
+			vector<int> nodes(count);
+			for (int i = 0; i < count; i++)
+				nodes[i] = random.below(points);
+			vector<float> out(count + 1, -1.0f);
+			euclideanDistances(xs.data(), ys.data(), nodes.data(), count, xs[dest], ys[dest], out.data());
+			vector<float> batched(count + 1, -1.0f);
+			heuristic.batch(nodes.data(), count, dest, batched.data());
+			for (int i = 0; i < count; i++) {
+				float expected = heuristic(nodes[i], dest);
+				CHECK(ulps(out[i], expected) <= 4);
+				CHECK(batched[i] == out[i]);
+			}
+			CHECK(out[count] == -1.0f && batched[count] == -1.0f);
+		}
+	}
+	return failures;
+}
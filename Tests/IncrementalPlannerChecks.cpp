@@ -0,0 +1,97 @@
+#include "Checks.h"
+#include "IncrementalPlanner.h"
+
+// ----------------------------------------------------------------
+//  Name:           checkIncrementalPlanner
+//  Description:    Drives D* Lite planners through rounds of arc
+//                  changes on road and geometric graphs, with and
+//                  without the heuristic. Each round removes,
+//                  lowers, raises and adds arcs, some on the
+//                  current path, passed in one changeArcs batch,
+//                  and every third round moves the start along the
+//                  path so km grows. After each round the planned
+//                  distance must match ucs on the changed graph,
+//                  and the path must run from the start to the goal
+//                  along arcs adding up to that distance.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkIncrementalPlanner() {
+	int failures = 0;
+	for (int trial = 0; trial < 6; trial++) {
+		GeneratedGraph generated = trial % 2 == 1 ? generateRoad(3000, trial) : generateGeometric(2000, 5, trial);
+		Random random(trial + 7);
+		int nodes = static_cast<int>(generated.positions.size());
+		CheckGraph graph(nodes);
+		buildGraph(generated, graph);
+		int goal = random.below(nodes);
+		IncrementalPlanner planner(graph.freeze(), random.below(nodes), goal, trial < 4);
+
+		SearchContext context(nodes);
+		vector<int> path, expectedPath;
+		for (int round = 0; round < 40; round++) {
+			float planned = planner.plan();
+			CheckCompactGraph compact = graph.freeze();
+			compact.ucs(context, planner.start(), goal, ignoreNode, expectedPath);
+			float expected = context.distance(goal);
+			CHECK(sameLength(planned, expected));
+			planner.getPath(path);
+			if (!isinf(expected)) {
+				CHECK(path.front() == goal && path.back() == planner.start());
+				CHECK(sameLength(pathLength(compact, path), expected));
+			}
+
+			vector<IncrementalPlanner::ArcChange> changes;
+			for (int k = 0; k < 5; k++) {
+				int from, to;
+				if (path.size() > 2 && k < 2) {
+					// an arc on the current path
+					size_t j = 1 + random.below(static_cast<int>(path.size()) - 1);
+					from = path[j];
+					to = path[j - 1];
+				}
+				else {
+					from = random.below(nodes);
+					GraphNode<int, float>::ArcList const & arcs = graph.nodeArray()[from]->arcList();
+					if (arcs.empty())
+						continue;
+					GraphNode<int, float>::ArcList::const_iterator iter = arcs.begin();
+					advance(iter, random.below(static_cast<int>(arcs.size())));
+					to = (*iter).node()->index();
+				}
+				GraphArc<int, float> const * pArc = graph.getArc(from, to);
+				int kind = random.below(4);
+				float weight;
+				if (kind == 0) {
+					weight = numeric_limits<float>::infinity();
+					graph.removeArc(from, to);
+				}
+				else {
+					// never below the straight line, so the heuristic stays admissible
+					weight = (pArc != 0 ? pArc->weight() : 100.0f) * (kind == 1 ? 0.9f : kind == 2 ? 3.0f : 1.5f);
+					weight = max(weight, generated.distance(from, to));
+					if (pArc != 0)
+						graph.setWeight(from, to, weight);
+					else
+						graph.addArc(from, to, weight);
+				}
+				IncrementalPlanner::ArcChange change = { from, to, weight };
+				changes.push_back(change);
+			}
+			// and an arc that wasn't there before
+			int from = random.below(nodes);
+			int to = random.below(nodes);
+			if (from != to && graph.getArc(from, to) == 0) {
+				float weight = generated.distance(from, to) * 1.2f;
+				graph.addArc(from, to, weight);
+				IncrementalPlanner::ArcChange change = { from, to, weight };
+				changes.push_back(change);
+			}
+			planner.changeArcs(changes);
+
+			if (round % 3 == 0 && path.size() > 2)
+				planner.moveStart(path[path.size() - 2]);
+		}
+	}
+	return failures;
+}
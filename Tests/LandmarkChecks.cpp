@@ -0,0 +1,114 @@
+#include "Checks.h"
+#include "Landmarks.h"
+
+// ----------------------------------------------------------------
+//  Name:           noMoreThan
+//  Description:    Whether a heuristic value is at most a bound,
+//                  allowing for the rounding of the landmark
+//                  distances being summed in another order.
+//  Arguments:      The value and the bound.
+//  Return Value:   True if the value is within the bound.
+// ----------------------------------------------------------------
+static bool noMoreThan( float value, float bound ) {
+	return !isnan(value) && (isinf(bound) || value <= bound + 1e-4f * max(1.0f, bound));
+}
+
+// ----------------------------------------------------------------
+//  Name:           landmarkFailures
+//  Description:    Checks aStar guided by the landmarks finds the
+//                  distances ucs does, that h is 0 at the goal and
+//                  no more than the distance to it, and that it is
+//                  consistent, h(u) <= w(u,v) + h(v) for every arc.
+//  Arguments:      The first parameter is the graph
+//                  The second parameter is the landmarks
+//                  The third parameter is the random seed.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+static int landmarkFailures( CheckCompactGraph const & graph, Landmarks const & landmarks, uint64_t seed ) {
+	int failures = 0;
+	Random random(seed);
+	SearchContext context;
+	NoStats stats;
+	vector<int> path;
+	int nodes = graph.nodeCount();
+	for (int q = 0; q < 60; q++) {
+		int start = random.below(nodes);
+		int dest = random.below(nodes);
+		graph.ucs(context, start, dest, ignoreNode, path);
+		float expected = context.distance(dest);
+		CHECK(noMoreThan(landmarks(start, dest), expected));
+		CHECK(landmarks(dest, dest) == 0);
+		graph.aStar(context, context.queue(), landmarks, start, dest, ignoreNode, path, stats);
+		CHECK(sameLength(context.distance(dest), expected));
+		CHECK(isinf(expected) || sameLength(pathLength(graph, path), expected));
+
+		// every arc, towards the first few goals
+		for (int node = 0; node < nodes && q < 5; node++) {
+			for (int arc = graph.arcBegin(node); arc != graph.arcEnd(node); arc++)
+				CHECK(noMoreThan(landmarks(node, dest), graph.weight(arc) + landmarks(graph.target(arc), dest)));
+		}
+	}
+	return failures;
+}
+
+// ----------------------------------------------------------------
+//  Name:           checkLandmarks
+//  Description:    Checks the ALT heuristic on a road graph with
+//                  some one-way streets and on a geometric graph,
+//                  built on this thread and on a pool, on a graph
+//                  with fewer nodes than landmarks asked for, and
+//                  on one made of two parts with no way between
+//                  them and a few nodes with no arcs at all.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkLandmarks() {
+	int failures = 0;
+	ThreadPool pool(3);
+	for (int kind = 0; kind < 2; kind++) {
+		GeneratedGraph generated = kind == 0 ? generateRoad(3000, 41) : generateGeometric(3000, 6, 42);
+		CheckGraph graph(static_cast<int>(generated.positions.size()));
+		buildGraph(generated, graph);
+		Random random(kind + 43);
+		for (size_t a = 0; a < generated.arcs.size() && kind == 0; a++) {
+			if (random.below(10) == 0)
+				graph.removeArc(generated.arcs[a].from, generated.arcs[a].to);
+		}
+		CheckCompactGraph compact = graph.freeze();
+		Landmarks landmarks(compact, 8);
+		CHECK(landmarks.landmarkCount() == 8);
+		failures += landmarkFailures(compact, landmarks, kind + 44);
+		Landmarks pooled(compact, 8, &pool);
+		CHECK(pooled.landmarkCount() == 8);
+		failures += landmarkFailures(compact, pooled, kind + 44);
+	}
+
+	// more landmarks than nodes
+	GeneratedGraph tiny = generateRoad(9, 45);
+	CheckGraph tinyGraph(static_cast<int>(tiny.positions.size()));
+	buildGraph(tiny, tinyGraph);
+	Landmarks tinyLandmarks(tinyGraph, 50);
+	CHECK(tinyLandmarks.landmarkCount() > 0 && tinyLandmarks.landmarkCount() <= static_cast<int>(tiny.positions.size()));
+	failures += landmarkFailures(tinyGraph.freeze(), tinyLandmarks, 46);
+
+	// a road graph and a geometric graph side by side, then some lone nodes
+	GeneratedGraph road = generateRoad(1000, 47);
+	GeneratedGraph geometric = generateGeometric(1000, 6, 48);
+	int offset = static_cast<int>(road.positions.size());
+	for (size_t i = 0; i < geometric.positions.size(); i++)
+		road.positions.push_back(Vector2(geometric.positions[i].x + 1e5f, geometric.positions[i].y));
+	for (size_t a = 0; a < geometric.arcs.size(); a++) {
+		GeneratedGraph::Arc arc = geometric.arcs[a];
+		arc.from += offset;
+		arc.to += offset;
+		road.arcs.push_back(arc);
+	}
+	for (int i = 0; i < 5; i++)
+		road.positions.push_back(Vector2(-1e5f, static_cast<float>(i)));
+	CheckGraph parts(static_cast<int>(road.positions.size()));
+	buildGraph(road, parts);
+	Landmarks partLandmarks(parts, 6);
+	CHECK(partLandmarks.landmarkCount() > 0 && partLandmarks.landmarkCount() <= 6);
+	failures += landmarkFailures(parts.freeze(), partLandmarks, 49);
+	return failures;
+}
@@ -0,0 +1,148 @@
+#include "Checks.h"
+#include "QueryCache.h"
+
+typedef GraphNode<int, float> CacheNode;
+
+// ----------------------------------------------------------------
+//  Name:           searchDistance
+//  Description:    The distance between two nodes found without
+//                  the cache.
+//  Arguments:      The first parameter is the graph
+//                  The second parameter is the search, UCS or ASTAR
+//                  The third and fourth parameters are the nodes.
+//  Return Value:   The distance, infinity if there is no path.
+// ----------------------------------------------------------------
+static float searchDistance( CheckGraph& graph, int search, int start, int dest ) {
+	SearchContext context;
+	vector<CacheNode*> path;
+	if (search == QueryCache<int, float>::UCS)
+		graph.ucs(context, graph.nodeArray()[start], graph.nodeArray()[dest], ignoreGraphNode, path);
+	else
+		graph.aStar(context, graph.nodeArray()[start], graph.nodeArray()[dest], ignoreGraphNode, path);
+	return context.distance(dest);
+}
+
+// ----------------------------------------------------------------
+//  Name:           cachedDistance
+//  Description:    The distance between two nodes through the cache.
+//  Arguments:      The first parameter is the cache
+//                  The second parameter is the graph
+//                  The third parameter is the search, UCS or ASTAR
+//                  The fourth and fifth parameters are the nodes
+//                  The sixth parameter receives the path.
+//  Return Value:   The distance, infinity if there is no path.
+// ----------------------------------------------------------------
+static float cachedDistance( QueryCache<int, float>& cache, CheckGraph& graph, int search, int start, int dest, vector<CacheNode*>& path ) {
+	SearchContext context;
+	if (search == QueryCache<int, float>::UCS)
+		return cache.ucs(context, graph.nodeArray()[start], graph.nodeArray()[dest], path);
+	return cache.aStar(context, graph.nodeArray()[start], graph.nodeArray()[dest], path);
+}
+
+// ----------------------------------------------------------------
+//  Name:           checkQueryCache
+//  Description:    Checks that cached ucs and aStar distances and
+//                  paths match searches without the cache, that a
+//                  repeated query is a hit and a new one a miss,
+//                  that reweighting or removing an arc of a cached
+//                  path, adding an arc, adding a node and removing a
+//                  node each make
+//                  the next lookup a miss with the new distance, and
+//                  that a small cache stays within its size.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkQueryCache() {
+	int failures = 0;
+	GeneratedGraph generated = generateRoad(2000, 8);
+	int nodes = static_cast<int>(generated.positions.size());
+	CheckGraph graph(nodes);
+	buildGraph(generated, graph);
+
+	QueryCache<int, float> cache(graph, 1 << 22, 4);
+	Random random(8);
+	vector<CacheNode*> path, repeated;
+	unsigned long long misses = 0;
+	unsigned long long hits = 0;
+	for (int q = 0; q < 100; q++) {
+		// a start of its own for each query, so no two share a key
+		int start = q;
+		int dest = random.below(nodes);
+		for (int search = 0; search < 2; search++) {
+			float distance = cachedDistance(cache, graph, search, start, dest, path);
+			CHECK(cache.misses() == ++misses && cache.hits() == hits);
+			CHECK(distance == searchDistance(graph, search, start, dest));
+			CHECK(cachedDistance(cache, graph, search, start, dest, repeated) == distance);
+			CHECK(cache.misses() == misses && cache.hits() == ++hits);
+			CHECK(repeated == path);
+		}
+	}
+	CHECK(cache.bytes() > 0 && cache.bytes() <= (1 << 22));
+
+	// find a cached query whose path has a node between its ends
+	int start = 0;
+	int dest = 0;
+	path.clear();
+	for (int q = 0; q < 100 && path.size() < 3; q++) {
+		start = q;
+		dest = random.below(nodes);
+		cachedDistance(cache, graph, QueryCache<int, float>::UCS, start, dest, path);
+	}
+	CHECK(path.size() >= 3);
+	if (path.size() >= 3) {
+		// the first arc of the path, which is returned back to front
+		int from = path[path.size() - 1]->index();
+		int to = path[path.size() - 2]->index();
+		float before = cachedDistance(cache, graph, QueryCache<int, float>::UCS, start, dest, path);
+		misses = cache.misses();
+		// a heavier first arc means a longer or different route
+		CHECK(graph.setWeight(from, to, graph.getArc(from, to)->weight() * 50));
+		float after = cachedDistance(cache, graph, QueryCache<int, float>::UCS, start, dest, path);
+		CHECK(cache.misses() == ++misses);
+		CHECK(after == searchDistance(graph, QueryCache<int, float>::UCS, start, dest) && after > before);
+		graph.removeArc(from, to);
+		after = cachedDistance(cache, graph, QueryCache<int, float>::UCS, start, dest, path);
+		CHECK(cache.misses() == ++misses);
+		CHECK(after == searchDistance(graph, QueryCache<int, float>::UCS, start, dest) && after >= before);
+
+		// a heavier arc straight there may be in the graph already
+		graph.removeArc(start, dest);
+		CHECK(graph.addArc(start, dest, 0.5f));
+		CHECK(cachedDistance(cache, graph, QueryCache<int, float>::UCS, start, dest, path) == 0.5f);
+		CHECK(cache.misses() == ++misses);
+		CHECK(path.size() == 2 && path[0]->index() == dest && path[1]->index() == start);
+
+		NodeHandle added = graph.addNode(-1, 0, 0);
+		CHECK(cachedDistance(cache, graph, QueryCache<int, float>::UCS, start, dest, path) == 0.5f);
+		CHECK(cache.misses() == ++misses);
+
+		// take away a node in the middle of a cached path
+		graph.removeNode(added);
+		cachedDistance(cache, graph, QueryCache<int, float>::ASTAR, 1, nodes - 1, path);
+		misses = cache.misses();
+		CHECK(path.size() >= 3);
+		if (path.size() >= 3) {
+			graph.removeNode(path[path.size() / 2]->index());
+			float distance = cachedDistance(cache, graph, QueryCache<int, float>::ASTAR, 1, nodes - 1, path);
+			CHECK(cache.misses() == ++misses);
+			CHECK(distance == searchDistance(graph, QueryCache<int, float>::ASTAR, 1, nodes - 1));
+		}
+	}
+
+	// a cache with room for a few paths only drops the oldest
+	size_t size = 4096;
+	QueryCache<int, float> small(graph, size, 2);
+	for (int q = 0; q < 300; q++) {
+		int from = random.below(nodes);
+		int to = random.below(nodes);
+		if (graph.nodeArray()[from] == 0 || graph.nodeArray()[to] == 0)
+			continue;
+		float distance = cachedDistance(small, graph, q % 2, from, to, path);
+		CHECK(distance == searchDistance(graph, q % 2, from, to));
+		CHECK(small.bytes() <= size);
+	}
+	CHECK(small.bytes() > 0);
+	small.clear();
+	CHECK(small.bytes() == 0);
+	return failures;
+}
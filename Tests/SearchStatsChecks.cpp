@@ -0,0 +1,147 @@
+#include <sstream>
+#include "Checks.h"
+
+// ----------------------------------------------------------------
+//  Name:           CountingVisitor
+//  Description:    A visitor that remembers every node it is given.
+// ----------------------------------------------------------------
+struct CountingVisitor {
+    vector<int> visited;
+
+    void operator()( int node ) {
+        visited.push_back( node );
+    }
+};
+
+// ----------------------------------------------------------------
+//  Name:           statsFailures
+//  Description:    Checks the stats of one search against what its
+//                  visitor saw. Every node visited was expanded and
+//                  had its arcs scanned, apart from the goal, where
+//                  the search stops. Every node pushed was popped
+//                  or is still waiting in the queue, and for ucs
+//                  and aStar each relaxed arc and the start was
+//                  either a push or a decrease-key.
+//  Arguments:      The first parameter is the graph
+//                  The second parameter is the context searched in
+//                  The third parameter is the visitor
+//                  The fourth parameter is the stats
+//                  The fifth parameter is the goal
+//                  The sixth parameter is whether the search keys
+//                  nodes by their distance.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+static int statsFailures( CheckCompactGraph const & graph, SearchContext& context, CountingVisitor const & visitor, SearchStats const & stats, int dest, bool keyedByDistance ) {
+	int failures = 0;
+	unsigned long long scanned = 0;
+	for (size_t i = 0; i < visitor.visited.size(); i++) {
+		if (visitor.visited[i] != dest)
+			scanned += graph.arcEnd(visitor.visited[i]) - graph.arcBegin(visitor.visited[i]);
+	}
+	CHECK(stats.expanded == visitor.visited.size());
+	CHECK(stats.arcsScanned == scanned);
+	CHECK(stats.pops() == stats.expanded);
+	CHECK(stats.pushes == stats.pops() + static_cast<unsigned long long>(context.queue().size()));
+	CHECK(stats.arcsRelaxed <= stats.arcsScanned);
+	CHECK(!keyedByDistance || stats.pushes + stats.decreaseKeys == stats.arcsRelaxed + 1);
+	CHECK(stats.peakOpen >= 0 && static_cast<unsigned long long>(stats.peakOpen) <= stats.pushes);
+	// a search that got past its start had something on the open list
+	CHECK(stats.expanded < 2 || stats.peakOpen > 0);
+	CHECK(stats.milliseconds >= 0);
+	return failures;
+}
+
+// ----------------------------------------------------------------
+//  Name:           checkSearchStats
+//  Description:    Checks the stats ucs, aStar and greedy record on
+//                  a road graph and on a grid where some queries
+//                  have no path, and the open list's peak on a star,
+//                  then that SearchCounters, added to from several
+//                  threads at once, totals them.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkSearchStats() {
+	int failures = 0;
+	vector<SearchStats> all;
+	int nontrivial = 0;
+	for (int kind = 0; kind < 2; kind++) {
+		GeneratedGraph generated = kind == 0 ? generateRoad(3000, 51) : generateGrid(3000, 0.3f, 52);
+		CheckGraph graph(static_cast<int>(generated.positions.size()));
+		buildGraph(generated, graph);
+		CheckCompactGraph compact = graph.freeze();
+		EuclideanArrayHeuristic heuristic(compact.xs(), compact.ys());
+
+		Random random(kind + 53);
+		SearchContext context;
+		vector<int> path;
+		for (int q = 0; q < 100; q++) {
+			int start = random.below(compact.nodeCount());
+			int dest = random.below(compact.nodeCount());
+			for (int search = 0; search < 3; search++) {
+				CountingVisitor visitor;
+				SearchStats stats;
+				if (search == 0)
+					compact.ucs(context, context.queue(), start, dest, visitor, path, stats);
+				else if (search == 1)
+					compact.aStar(context, context.queue(), heuristic, start, dest, visitor, path, stats);
+				else
+					compact.greedy(context, context.queue(), heuristic, start, dest, visitor, path, stats);
+				failures += statsFailures(compact, context, visitor, stats, dest, search != 2);
+				if (stats.expanded > 1)
+					nontrivial++;
+				all.push_back(stats);
+			}
+		}
+	}
+	CHECK(nontrivial > 0);
+
+	// a star, whose centre's five arms are all waiting at once
+	CheckGraph star;
+	for (int i = 0; i < 7; i++)
+		star.addNode(i, static_cast<float>(i), 0, i);
+	for (int i = 1; i < 6; i++)
+		star.addArc(0, i, static_cast<float>(i));
+	CheckCompactGraph compactStar = star.freeze();
+	SearchContext context;
+	CountingVisitor visitor;
+	SearchStats stats;
+	vector<int> path;
+	compactStar.ucs(context, context.queue(), 0, 6, visitor, path, stats);
+	failures += statsFailures(compactStar, context, visitor, stats, 6, true);
+	CHECK(stats.expanded == 6 && stats.pushes == 6 && stats.peakOpen == 5);
+
+	SearchStats sum;
+	for (size_t i = 0; i < all.size(); i++) {
+		sum.expanded += all[i].expanded;
+		sum.arcsScanned += all[i].arcsScanned;
+		sum.arcsRelaxed += all[i].arcsRelaxed;
+		sum.pushes += all[i].pushes;
+		sum.decreaseKeys += all[i].decreaseKeys;
+		sum.peakOpen = max(sum.peakOpen, all[i].peakOpen);
+	}
+	SearchCounters counters;
+	ThreadPool pool(3);
+	pool.parallelFor(static_cast<int>(all.size()), 16, [&](int, int begin, int end) {
+		for (int i = begin; i < end; i++)
+			counters.add(all[i]);
+	});
+	SearchStats total = counters.total();
+	CHECK(counters.queries() == all.size());
+	CHECK(total.expanded == sum.expanded && total.arcsScanned == sum.arcsScanned && total.arcsRelaxed == sum.arcsRelaxed);
+	CHECK(total.pushes == sum.pushes && total.decreaseKeys == sum.decreaseKeys && total.peakOpen == sum.peakOpen);
+
+	ostringstream expected;
+	expected << "{\"queries\": " << all.size()
+		<< ", \"expanded\": " << sum.expanded
+		<< ", \"arcsScanned\": " << sum.arcsScanned
+		<< ", \"arcsRelaxed\": " << sum.arcsRelaxed
+		<< ", \"pushes\": " << sum.pushes
+		<< ", \"pops\": " << sum.expanded
+		<< ", \"decreaseKeys\": " << sum.decreaseKeys
+		<< ", \"peakOpen\": " << sum.peakOpen << ", ";
+	CHECK(counters.json().compare(0, expected.str().size(), expected.str()) == 0);
+	counters.clear();
+	CHECK(counters.queries() == 0 && counters.total().expanded == 0);
+	return failures;
+}
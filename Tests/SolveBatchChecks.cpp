@@ -0,0 +1,69 @@
+#include "Checks.h"
+
+// ----------------------------------------------------------------
+//  Name:           checkSolveBatch
+//  Description:    Checks solveBatch's distances against ucs on one
+//                  worker and several, on grids where some queries
+//                  have no path, and that the searches given
+//                  NoVisitor find the same paths as those given a
+//                  visit function.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkSolveBatch() {
+	int failures = 0;
+	for (int kind = 0; kind < 2; kind++) {
+		GeneratedGraph generated = kind == 0 ? generateRoad(3000, 4) : generateGrid(3000, 0.3f, 6);
+		int nodes = static_cast<int>(generated.positions.size());
+		CheckGraph graph(nodes);
+		buildGraph(generated, graph);
+		CheckCompactGraph compact = graph.freeze();
+
+		Random random(kind + 11);
+		vector<pair<int, int> > queries;
+		for (int q = 0; q < 200; q++)
+			queries.push_back(make_pair(random.below(nodes), random.below(nodes)));
+		for (int workers = 1; workers <= 3; workers += 2) {
+			ThreadPool pool(workers);
+			vector<float> distances;
+			graph.solveBatch(queries, distances, pool);
+			CHECK(distances.size() == queries.size());
+			SearchContext context;
+			vector<int> path;
+			for (size_t q = 0; q < queries.size() && q < distances.size(); q++) {
+				compact.ucs(context, queries[q].first, queries[q].second, ignoreNode, path);
+				CHECK(sameLength(distances[q], context.distance(queries[q].second)));
+			}
+		}
+
+		SearchContext context;
+		NoVisitor visitor;
+		NoStats stats;
+		EuclideanArrayHeuristic heuristic(compact.xs(), compact.ys());
+		vector<int> path, visitedPath;
+		vector<GraphNode<int, float>*> nodePath, visitedNodePath;
+		for (int q = 0; q < 50; q++) {
+			int start = queries[q].first;
+			int dest = queries[q].second;
+			compact.ucs(context, start, dest, ignoreNode, visitedPath);
+			compact.ucs(context, context.queue(), start, dest, visitor, path, stats);
+			CHECK(path == visitedPath);
+			compact.aStar(context, start, dest, ignoreNode, visitedPath);
+			compact.aStar(context, context.queue(), heuristic, start, dest, visitor, path, stats);
+			CHECK(path == visitedPath);
+			compact.greedy(context, start, dest, ignoreNode, visitedPath);
+			compact.greedy(context, context.queue(), heuristic, start, dest, visitor, path, stats);
+			CHECK(path == visitedPath);
+
+			GraphNode<int, float>* pStart = graph.nodeArray()[start];
+			GraphNode<int, float>* pDest = graph.nodeArray()[dest];
+			graph.aStar(context, pStart, pDest, ignoreGraphNode, visitedNodePath);
+			graph.aStar(context, EuclideanHeuristic<CheckGraph>(graph), pStart, pDest, visitor, nodePath, stats);
+			CHECK(nodePath == visitedNodePath);
+			graph.ucs(context, pStart, pDest, ignoreGraphNode, visitedNodePath);
+			graph.ucs(context, pStart, pDest, visitor, nodePath, stats);
+			CHECK(nodePath == visitedNodePath);
+		}
+	}
+	return failures;
+}
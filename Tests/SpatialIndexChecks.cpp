@@ -0,0 +1,133 @@
+#include "Checks.h"
+
+// ----------------------------------------------------------------
+//  Name:           nearestByScan
+//  Description:    The k nodes nearest a point, found by scanning
+//                  every node, ties broken by index as the index
+//                  does.
+//  Arguments:      The first parameter is the graph
+//                  The second and third parameters are the point
+//                  The fourth parameter is k
+//                  The fifth parameter receives the node indices.
+//  Return Value:   None.
+// ----------------------------------------------------------------
+static void nearestByScan( CheckGraph& graph, float x, float y, int k, vector<int>& nearest ) {
+	vector<pair<float, int> > byDistance;
+	for (GraphNode<int, float>* pNode : graph.nodes()) {
+		float dx = pNode->getPosition().x - x;
+		float dy = pNode->getPosition().y - y;
+		byDistance.push_back(make_pair(dx * dx + dy * dy, pNode->index()));
+	}
+	sort(byDistance.begin(), byDistance.end());
+	nearest.clear();
+	for (int i = 0; i < k && i < static_cast<int>(byDistance.size()); i++)
+		nearest.push_back(byDistance[i].second);
+}
+
+// ----------------------------------------------------------------
+//  Name:           checkSpatialIndex
+//  Description:    Checks the position index's nearest, k nearest,
+//                  radius and box queries, the Graph's nearestNode
+//                  and getNodeAtMouse, against scanning every node.
+//                  The graphs cover small and huge coordinates,
+//                  many nodes at the same point and all nodes on
+//                  one line, with nodes removed and added after
+//                  the index is built, and with the index turned on
+//                  only after they were. Queries fall both inside
+//                  the nodes and far outside them, so the ring
+//                  search has to stop at the right ring or fall
+//                  back to a scan.
+//  Arguments:      None.
+//  Return Value:   The number of failures.
+// ----------------------------------------------------------------
+int checkSpatialIndex() {
+	int failures = 0;
+	Random random(3);
+	for (int trial = 0; trial < 4; trial++) {
+		CheckGraph graph;
+		if (trial % 2 == 0)
+			graph.indexPositions(true);
+		float scale = trial == 0 ? 1000.0f : trial == 1 ? 10.0f : trial == 2 ? 1e6f : 500.0f;
+		vector<NodeHandle> handles;
+		for (int i = 0; i < 3000; i++) {
+			float x = (random.uniform() * 2 - 1) * scale;
+			float y = trial == 3 ? 5.0f : (random.uniform() * 2 - 1) * scale;
+			if (trial == 1 && i % 3 == 0) {
+				// many nodes on the same few points
+				x = static_cast<float>(random.below(5));
+				y = static_cast<float>(random.below(5));
+			}
+			handles.push_back(graph.addNode(i, x, y));
+		}
+		for (int i = 0; i < 1000; i++)
+			graph.removeNode(handles[random.below(static_cast<int>(handles.size()))]);
+		for (int i = 0; i < 500; i++)
+			handles.push_back(graph.addNode(i, (random.uniform() * 2 - 1) * scale, (random.uniform() * 2 - 1) * scale));
+		if (trial % 2 == 1)
+			graph.indexPositions(true);
+		CHECK(graph.positions().size() == graph.nodeCount());
+
+		vector<int> found, expected;
+		for (int q = 0; q < 300; q++) {
+			float spread = q % 10 == 0 ? scale * 50 : scale * 1.2f;
+			float x = (random.uniform() * 2 - 1) * spread;
+			float y = (random.uniform() * 2 - 1) * spread;
+			int k = 1 + random.below(20);
+			graph.positions().nearest(x, y, k, found);
+			nearestByScan(graph, x, y, k, expected);
+			CHECK(found == expected);
+			CHECK(graph.nearestNode(x, y) == expected[0]);
+
+			float radius = scale * 0.01f * random.below(10);
+			graph.positions().withinRadius(x, y, radius, found);
+			sort(found.begin(), found.end());
+			expected.clear();
+			for (GraphNode<int, float>* pNode : graph.nodes()) {
+				float dx = pNode->getPosition().x - x;
+				float dy = pNode->getPosition().y - y;
+				if (dx * dx + dy * dy <= radius * radius)
+					expected.push_back(pNode->index());
+			}
+			CHECK(found == expected);
+
+			float right = x + radius * 2;
+			float bottom = y + radius;
+			graph.positions().withinBox(x, y, right, bottom, found);
+			sort(found.begin(), found.end());
+			expected.clear();
+			for (GraphNode<int, float>* pNode : graph.nodes()) {
+				Vector2 position = pNode->getPosition();
+				if (position.x >= x && position.x <= right && position.y >= y && position.y <= bottom)
+					expected.push_back(pNode->index());
+			}
+			CHECK(found == expected);
+
+			int mouseX = static_cast<int>(x);
+			int mouseY = static_cast<int>(y);
+			GraphNode<int, float>* pUnder = 0;
+			for (GraphNode<int, float>* pNode : graph.nodes()) {
+				if (pNode->intersects(mouseX, mouseY)) {
+					pUnder = pNode;
+					break;
+				}
+			}
+			CHECK(graph.getNodeAtMouse(mouseX, mouseY) == pUnder);
+		}
+	}
+
+	// the linear lookups and the indexed ones agree on a small graph
+	CheckGraph small;
+	for (int i = 0; i < 50; i++)
+		small.addNode(i, static_cast<float>(random.below(300)), static_cast<float>(random.below(300)));
+	for (int q = 0; q < 200; q++) {
+		int mouseX = random.below(330);
+		int mouseY = random.below(330);
+		GraphNode<int, float>* pLinear = small.getNodeAtMouse(mouseX, mouseY);
+		int linear = small.nearestNode(static_cast<float>(mouseX), static_cast<float>(mouseY));
+		small.indexPositions(true);
+		CHECK(small.getNodeAtMouse(mouseX, mouseY) == pLinear);
+		CHECK(small.nearestNode(static_cast<float>(mouseX), static_cast<float>(mouseY)) == linear);
+		small.indexPositions(false);
+	}
+	return failures;
+}
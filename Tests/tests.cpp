@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////
+// Regression checks for the searches and tables.
+//
+// Each check runs a search or builds a table on seeded random
+// graphs and compares the results against ucs or brute force.
+// CTest runs each check on its own, by name.
+//
+// Usage:
+//   pathfinder_tests [check]
+//
+// With no check named, every check runs.
+////////////////////////////////////////////////////////////
+#include <cstring>
+#include <iostream>
+#include "Checks.h"
+
+using namespace std;
+
+struct Check {
+	char const * name;
+	int (*pRun)();
+};
+
+Check const checks[] = {
+	{ "allPairs", checkAllPairs },
+	{ "contractionHierarchy", checkContractionHierarchy },
+	{ "distanceTable", checkDistanceTable },
+	{ "graphEdits", checkGraphEdits },
+	{ "graphFile", checkGraphFile },
+	{ "edgeList", checkEdgeList },
+	{ "incrementalPlanner", checkIncrementalPlanner },
+	{ "landmarks", checkLandmarks },
+	{ "gridGraph", checkGridGraph },
+	{ "heaps", checkHeaps },
+	{ "heuristics", checkHeuristics },
+	{ "queryCache", checkQueryCache },
+	{ "searchStats", checkSearchStats },
+	{ "solveBatch", checkSolveBatch },
+	{ "spatialIndex", checkSpatialIndex },
+};
+
+int main(int argc, char *argv[]) {
+	int failures = 0;
+	bool found = false;
+	for (size_t i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+		if (argc > 1 && strcmp(argv[1], checks[i].name) != 0)
+			continue;
+		found = true;
+		int failed = checks[i].pRun();
+		cout << checks[i].name << ": " << (failed == 0 ? "passed" : "FAILED") << " (" << failed << " failures)\n";
+		failures += failed;
+	}
+	if (!found) {
+		cerr << "unknown check " << argv[1] << "\n";
+		return 2;
+	}
+	return failures == 0 ? 0 : 1;
+}